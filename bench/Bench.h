@@ -0,0 +1,50 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <string>
+#include <vector>
+
+//Minimal benchmark registry. A benchmark runs its body `iterations` times,
+//the harness scales the iteration count until a run takes long enough to time.
+typedef void (*BenchFunction)(int iterations);
+
+struct Benchmark {
+	std::string name;
+	BenchFunction function;
+};
+
+std::vector<Benchmark> & getBenchmarks();
+
+struct BenchRegistrar {
+	BenchRegistrar(const char * name, BenchFunction function)
+	{
+		Benchmark benchmark;
+		benchmark.name = name;
+		benchmark.function = function;
+		getBenchmarks().push_back(benchmark);
+	}
+};
+
+#define HOLO_BENCH(name) \
+	static void name(int iterations); \
+	static BenchRegistrar name##_registrar(#name, name); \
+	static void name(int iterations)
+
+//the harness seeds rand() with this before a benchmark builds its fixtures
+#define BENCH_SEED 42
+
+//input shared by the benchmarks of a file, built on first use, which is the run
+//without iterations the harness makes before timing
+template <typename T> T & getFixture()
+{
+	static T fixture;
+	return fixture;
+}
+
+//keeps the compiler from optimizing a result away
+template <typename T> inline void doNotOptimize(T const &value)
+{
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif //BENCH_H
@@ -0,0 +1,107 @@
+#include <cstdlib>
+#include <fstream>
+#include "Bench.h"
+#include "VREventDispatcher.h"
+
+//Replays a stream of event names through the dispatch table and through the
+//chain of string comparisons MyVRApp::onVREvent used before. The stream is read
+//from $HOLO_BENCH_EVENTS (one event name per line) if set, otherwise a synthetic
+//stream with two controllers tracked at 90 Hz and occasional button presses is used.
+
+struct BenchEvent {
+	int value;
+};
+
+class EventCounter {
+public:
+	EventCounter() : count(0){};
+	void onPose(const BenchEvent &event){ count += event.value; }
+	void onButton(const BenchEvent &event){ count += 2 * event.value; }
+	void onOther(const BenchEvent &event){ count--; }
+	long long count;
+};
+
+static const char * buttonEvents[] = {
+	"HTC_Controller_Right_Axis1Button_Pressed",
+	"HTC_Controller_Right_Axis1Button_Released",
+	"HTC_Controller_Left_Axis1Button_Pressed",
+	"HTC_Controller_Left_Axis1Button_Released",
+	"HTC_Controller_Right_AButton_Pressed",
+	"HTC_Controller_Right_ApplicationMenuButton_Pressed",
+	"KbdEsc_Down"
+};
+
+struct EventStream {
+	std::vector<std::string> names;
+
+	EventStream()
+	{
+		const char * filename = getenv("HOLO_BENCH_EVENTS");
+		if (filename)
+		{
+			std::ifstream fin(filename);
+			std::string line;
+			while (std::getline(fin, line))
+			{
+				if (!line.empty())
+					names.push_back(line);
+			}
+		}
+
+		if (names.empty())
+		{
+			for (int i = 0; i < 10000; i++)
+			{
+				names.push_back("HTC_Controller_Left");
+				names.push_back("HTC_Controller_Right");
+				names.push_back("HMD");
+				if (rand() % 50 == 0)
+					names.push_back(buttonEvents[rand() % 6]);
+			}
+		}
+	}
+};
+
+HOLO_BENCH(events_dispatch_if_chain)
+{
+	std::vector<std::string> &stream = getFixture<EventStream>().names;
+	EventCounter counter;
+	BenchEvent event = { 1 };
+	for (int i = 0; i < iterations; i++)
+	{
+		const std::string &name = stream[i % stream.size()];
+		if (name == "HTC_Controller_Left") counter.onPose(event);
+		if (name == buttonEvents[0]) counter.onButton(event);
+		if (name == buttonEvents[1]) counter.onButton(event);
+		if (name == buttonEvents[2]) counter.onButton(event);
+		if (name == buttonEvents[3]) counter.onButton(event);
+		if (name == buttonEvents[4]) counter.onButton(event);
+		if (name == buttonEvents[5]) counter.onButton(event);
+		if (name == "HTC_Controller_Left") counter.onPose(event);
+		if (name == "HTC_Controller_Right") counter.onPose(event);
+		if (name == buttonEvents[6]) counter.onButton(event);
+	}
+	doNotOptimize(counter.count);
+}
+
+HOLO_BENCH(events_dispatch_table)
+{
+	static VREventDispatcher<EventCounter, BenchEvent> dispatcher;
+	if (dispatcher.getID("HTC_Controller_Left") < 0)
+	{
+		dispatcher.registerHandler("HTC_Controller_Left", &EventCounter::onPose);
+		dispatcher.registerHandler("HTC_Controller_Right", &EventCounter::onPose);
+		for (int i = 0; i < 7; i++)
+			dispatcher.registerHandler(buttonEvents[i], &EventCounter::onButton);
+		dispatcher.setDefaultHandler(&EventCounter::onOther);
+	}
+
+	std::vector<std::string> &stream = getFixture<EventStream>().names;
+	EventCounter counter;
+	BenchEvent event = { 1 };
+	for (int i = 0; i < iterations; i++)
+	{
+		dispatcher.dispatch(&counter, stream[i % stream.size()], event);
+	}
+	doNotOptimize(counter.count);
+}
@@ -0,0 +1,96 @@
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include "Bench.h"
+#include "VRFontHandler.h"
+#include "Renderer.h"
+
+//Text layout into a render list, as the menus and the info box record it every frame.
+//The font handler loads calibri.ttf from the working directory. If it is not there,
+//the font in $HOLO_BENCH_FONT or DejaVu Sans is linked under that name in a temporary
+//folder for loading it.
+#define FALLBACK_FONT "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf"
+
+//hands out texture names without a context, nothing is drawn
+class NullRenderer : public Renderer {
+public:
+	virtual std::string getName(){ return "null"; }
+	virtual bool supportsFormat(TextureFormat format){ return true; }
+	virtual unsigned int createTexture(int width, int height, TextureFormat format, const unsigned char *pixels){ return 1; }
+	virtual void deleteTexture(unsigned int texture){}
+	virtual void upload(const RenderList &list){}
+	virtual void draw(const RenderList &list, const float *projection, const float *view){}
+};
+
+static bool fileExists(const char *filename)
+{
+	return access(filename, R_OK) == 0;
+}
+
+static VRFontHandler * getFont()
+{
+	static VRFontHandler *font = NULL;
+	if (font != NULL)
+		return font;
+
+	const char *fontFile = getenv("HOLO_BENCH_FONT");
+	if (fontFile == NULL)
+		fontFile = FALLBACK_FONT;
+
+	char cwd[4096];
+	char folder[] = "/tmp/holo-bench-font-XXXXXX";
+	bool linked = false;
+	if (!fileExists("calibri.ttf") && fileExists(fontFile) && getcwd(cwd, sizeof(cwd)) != NULL && mkdtemp(folder) != NULL)
+	{
+		std::string link = std::string(folder) + "/calibri.ttf";
+		linked = symlink(fontFile, link.c_str()) == 0 && chdir(folder) == 0;
+		font = VRFontHandler::getInstance();
+		if (linked && chdir(cwd) != 0)
+			std::cerr << "Could not return to " << cwd << std::endl;
+		unlink(link.c_str());
+		rmdir(folder);
+	}
+	else
+	{
+		font = VRFontHandler::getInstance();
+	}
+	if (!linked && !fileExists("calibri.ttf"))
+		std::cerr << "No font found, set HOLO_BENCH_FONT to a ttf file" << std::endl;
+
+	NullRenderer renderer;
+	font->createTexture(&renderer);
+	return font;
+}
+
+HOLO_BENCH(font_layout_textbox)
+{
+	VRFontHandler *font = getFont();
+	RenderList list;
+	for (int i = 0; i < iterations; i++)
+	{
+		list.clear();
+		font->renderTextBox(list, "Frame 1234 / 20000", 0.0, 0.0, 0.0, 0.3, 0.05, VRFontHandler::LEFT);
+		doNotOptimize(list.getVertices().size());
+	}
+}
+
+HOLO_BENCH(font_layout_info_box)
+{
+	VRFontHandler *font = getFont();
+	std::vector<std::string> lines;
+	char line[64];
+	for (int i = 0; i < 12; i++)
+	{
+		sprintf(line, "Value%d : %.4f", i, 10.0 + i * 1.37);
+		lines.push_back(line);
+	}
+
+	RenderList list;
+	for (int i = 0; i < iterations; i++)
+	{
+		list.clear();
+		font->renderMultiLineTextBox(list, lines, 0.0, 0.0, 0.0, 0.5, 0.5, VRFontHandler::LEFT);
+		doNotOptimize(list.getVertices().size());
+	}
+}
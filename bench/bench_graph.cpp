@@ -0,0 +1,59 @@
+#include <cmath>
+#include <cstdlib>
+#include "Bench.h"
+#include "GraphSeries.h"
+
+//A CTD value over a long cruise with a few gaps, as VRGraph::computeBounds sees it
+//when a series is set. Series up to the point limit are kept whole, longer ones are
+//decimated to min/max pairs.
+#define GRAPH_POINTS 2048
+#define GRAPH_SHORT 2000
+#define GRAPH_LONG 1000000
+
+struct GraphInput {
+	std::vector<double> shortSeries;
+	std::vector<double> longSeries;
+
+	GraphInput()
+	{
+		for (int i = 0; i < GRAPH_LONG; i++)
+		{
+			double value = 12.0 + 4.0 * std::sin(i / 900.0) + 0.1 * rand() / RAND_MAX;
+			longSeries.push_back((rand() % 500 == 0) ? GRAPHUNDEFINEDVALUE : value);
+		}
+		shortSeries.assign(longSeries.begin(), longSeries.begin() + GRAPH_SHORT);
+	}
+};
+
+HOLO_BENCH(graph_range_1m)
+{
+	GraphInput &input = getFixture<GraphInput>();
+	double range[2];
+	for (int i = 0; i < iterations; i++)
+	{
+		computeSeriesRange(input.longSeries, range);
+		doNotOptimize(range[0]);
+	}
+}
+
+HOLO_BENCH(graph_decimate_2k)
+{
+	GraphInput &input = getFixture<GraphInput>();
+	std::vector<int> indices;
+	for (int i = 0; i < iterations; i++)
+	{
+		decimateSeries(input.shortSeries, GRAPH_POINTS, indices);
+		doNotOptimize(indices.size());
+	}
+}
+
+HOLO_BENCH(graph_decimate_1m)
+{
+	GraphInput &input = getFixture<GraphInput>();
+	std::vector<int> indices;
+	for (int i = 0; i < iterations; i++)
+	{
+		decimateSeries(input.longSeries, GRAPH_POINTS, indices);
+		doNotOptimize(indices.size());
+	}
+}
@@ -0,0 +1,103 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include "Bench.h"
+#include "BatchReader.h"
+
+//A frame folder worth of small ROI files. Before every pass the pages of the files
+//are dropped from the page cache, so the reads have to go to the disk again.
+#define IO_FILES 1000
+#define IO_FILE_SIZE 16384
+
+struct RoiFolder {
+	std::string directory;
+	std::vector<std::string> filenames;
+
+	RoiFolder()
+	{
+		char path[] = "/tmp/holo-bench-XXXXXX";
+		if (mkdtemp(path) == NULL)
+			return;
+		directory = path;
+
+		std::vector<unsigned char> bytes(IO_FILE_SIZE);
+		for (int i = 0; i < IO_FILES; i++)
+		{
+			for (int j = 0; j < IO_FILE_SIZE; j++)
+				bytes[j] = rand();
+
+			std::string filename = directory + "/roi" + std::to_string(i) + ".png";
+			FILE *file = fopen(filename.c_str(), "wb");
+			if (file == NULL)
+				continue;
+			fwrite(&bytes[0], 1, bytes.size(), file);
+			fflush(file);
+			fsync(fileno(file));
+			fclose(file);
+			filenames.push_back(filename);
+		}
+	}
+
+	~RoiFolder()
+	{
+		for (std::vector<std::string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
+			remove(it->c_str());
+		if (!directory.empty())
+			rmdir(directory.c_str());
+	}
+
+	//only clean pages can be dropped, the files were synced when they were written
+	void dropCache()
+	{
+		for (std::vector<std::string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
+		{
+			int descriptor = open(it->c_str(), O_RDONLY);
+			if (descriptor < 0)
+				continue;
+			posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+			close(descriptor);
+		}
+	}
+};
+
+//the former loader, one blocking open and read after the other
+HOLO_BENCH(io_read_cold_sequential_1k)
+{
+	RoiFolder &folder = getFixture<RoiFolder>();
+	std::vector<unsigned char> bytes(IO_FILE_SIZE);
+	for (int i = 0; i < iterations; i++)
+	{
+		folder.dropCache();
+		for (std::vector<std::string>::const_iterator it = folder.filenames.begin(); it != folder.filenames.end(); ++it)
+		{
+			FILE *file = fopen(it->c_str(), "rb");
+			if (file == NULL)
+				continue;
+			doNotOptimize(fread(&bytes[0], 1, bytes.size(), file));
+			fclose(file);
+		}
+	}
+}
+
+HOLO_BENCH(io_read_cold_batched_1k)
+{
+	RoiFolder &folder = getFixture<RoiFolder>();
+	BufferPool pool;
+	BatchReader reader(pool);
+	std::vector<FileRead> files(folder.filenames.size());
+	for (int i = 0; i < iterations; i++)
+	{
+		folder.dropCache();
+		for (int f = 0; f < files.size(); f++)
+			files[f].filename = folder.filenames[f];
+		reader.read(files);
+		for (int f = 0; f < files.size(); f++)
+		{
+			if (!files[f].ok)
+				std::cerr << "read failed " << files[f].filename << std::endl;
+			pool.release(files[f].data);
+		}
+	}
+}
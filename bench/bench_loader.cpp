@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include "Bench.h"
+#include "PngDecoder.h"
+#include "ReportParser.h"
+
+//The per-frame work of DataSetLoader that does not touch the disk: keying decoded ROI
+//rows, parsing the report of a frame and parsing its CTD values. The inputs look like
+//the files holo-gen writes.
+#define KEY_WIDTH 256
+#define KEY_HEIGHT 192
+#define REPORT_ROIS 1000
+#define CTD_LINES 32
+
+struct LoaderInput {
+	std::vector<unsigned char> pixels;
+	std::vector<unsigned char> grayAlpha;
+	std::string report;
+	std::string ctd;
+
+	LoaderInput()
+	{
+		pixels.resize(3 * KEY_WIDTH * KEY_HEIGHT);
+		grayAlpha.resize(2 * KEY_WIDTH * KEY_HEIGHT);
+		for (int i = 0; i < KEY_WIDTH * KEY_HEIGHT; i++)
+		{
+			unsigned char gray = 60 + rand() % 40;
+			bool inside = rand() % 3 != 0;
+			pixels[3 * i] = inside ? gray : 255;
+			pixels[3 * i + 1] = gray;
+			pixels[3 * i + 2] = gray;
+		}
+
+		char line[512];
+		report = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<doc>\n<DATA>\n<NBCONTOURS>" + std::to_string(REPORT_ROIS) + "</NBCONTOURS>\n";
+		for (int i = 0; i < REPORT_ROIS; i++)
+		{
+			sprintf(line, "<ROI><X>%.3f</X><Y>%.3f</Y><DEPTH>%.3f</DEPTH><WIDTH>%d</WIDTH><HEIGHT>%d</HEIGHT>"
+				"<IMAGE>roi%06d.png</IMAGE><ESD>%.3f</ESD><ESV>%.3f</ESV><CONTOUR>%d</CONTOUR></ROI>\n",
+				2000.0 * rand() / RAND_MAX - 1000.0, 2000.0 * rand() / RAND_MAX - 1000.0, 500.0 + 24500.0 * rand() / RAND_MAX,
+				16 + rand() % 80, 16 + rand() % 80, i, 300.0 * rand() / RAND_MAX, 1e7 * rand() / RAND_MAX, i + 1);
+			report += line;
+		}
+		report += "</DATA>\n</doc>\n";
+
+		for (int i = 0; i < CTD_LINES; i++)
+		{
+			sprintf(line, "Value%d %.4f\r\n", i, 100.0 * rand() / RAND_MAX);
+			ctd += line;
+		}
+
+		DataSet set;
+		std::vector<std::string> images;
+		if (!parseReport(report.data(), report.size(), 500, set, images) || set.quads.size() != REPORT_ROIS || images.size() != REPORT_ROIS)
+			std::cerr << "report parsing returned " << set.quads.size() << " of " << REPORT_ROIS << " ROIs" << std::endl;
+		parseCTD(ctd.data(), ctd.size(), set);
+		if (set.values.size() != 1 + CTD_LINES)
+			std::cerr << "CTD parsing returned " << set.values.size() - 1 << " of " << CTD_LINES << " values" << std::endl;
+	}
+};
+
+HOLO_BENCH(loader_key_rows_rgb)
+{
+	LoaderInput &input = getFixture<LoaderInput>();
+	for (int i = 0; i < iterations; i++)
+	{
+		for (int y = 0; y < KEY_HEIGHT; y++)
+			keyRow(&input.pixels[3 * y * KEY_WIDTH], KEY_WIDTH, false, &input.grayAlpha[2 * y * KEY_WIDTH]);
+		doNotOptimize(input.grayAlpha[0]);
+	}
+}
+
+HOLO_BENCH(loader_key_rows_bgr)
+{
+	LoaderInput &input = getFixture<LoaderInput>();
+	for (int i = 0; i < iterations; i++)
+	{
+		for (int y = 0; y < KEY_HEIGHT; y++)
+			keyRow(&input.pixels[3 * y * KEY_WIDTH], KEY_WIDTH, true, &input.grayAlpha[2 * y * KEY_WIDTH]);
+		doNotOptimize(input.grayAlpha[0]);
+	}
+}
+
+HOLO_BENCH(loader_parse_report_1k)
+{
+	LoaderInput &input = getFixture<LoaderInput>();
+	for (int i = 0; i < iterations; i++)
+	{
+		DataSet set;
+		std::vector<std::string> images;
+		parseReport(input.report.data(), input.report.size(), 500, set, images);
+		doNotOptimize(set.quads.size());
+	}
+}
+
+HOLO_BENCH(loader_parse_ctd)
+{
+	LoaderInput &input = getFixture<LoaderInput>();
+	for (int i = 0; i < iterations; i++)
+	{
+		DataSet set;
+		parseCTD(input.ctd.data(), input.ctd.size(), set);
+		doNotOptimize(set.values.size());
+	}
+}
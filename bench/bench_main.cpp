@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include "Bench.h"
+
+#define MIN_RUN_TIME 0.2
+
+//set by the build, see bench/CMakeLists.txt
+#ifndef HOLO_BENCH_BUILD_TYPE
+#define HOLO_BENCH_BUILD_TYPE ""
+#endif
+#ifndef HOLO_BENCH_FLAGS
+#define HOLO_BENCH_FLAGS ""
+#endif
+
+std::vector<Benchmark> & getBenchmarks()
+{
+	static std::vector<Benchmark> benchmarks;
+	return benchmarks;
+}
+
+double runBenchmark(const Benchmark &benchmark, int iterations)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	benchmark.function(iterations);
+	std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double>(end - start).count();
+}
+
+//names are plain identifiers, only quotes and backslashes would need escaping
+static std::string toJSONString(const std::string &text)
+{
+	std::string json = "\"";
+	for (std::string::const_iterator it = text.begin(); it != text.end(); ++it)
+	{
+		if (*it == '"' || *it == '\\')
+			json += '\\';
+		json += *it;
+	}
+	return json + "\"";
+}
+
+int main(int argc, char **argv)
+{
+	//--json prints one object with all results for comparing runs, an optional
+	//argument only runs the benchmarks whose name contains it
+	bool json = false;
+	std::string filter;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--json") == 0)
+			json = true;
+		else
+			filter = argv[i];
+	}
+
+	if (json)
+	{
+		std::cout << "{\n  \"build_type\": " << toJSONString(HOLO_BENCH_BUILD_TYPE)
+			<< ",\n  \"extra_flags\": " << toJSONString(HOLO_BENCH_FLAGS)
+			<< ",\n  \"benchmarks\": [";
+	}
+	bool first = true;
+
+	for (std::vector<Benchmark>::const_iterator it = getBenchmarks().begin(); it != getBenchmarks().end(); ++it)
+	{
+		if (!filter.empty() && it->name.find(filter) == std::string::npos)
+			continue;
+
+		//a run without iterations builds the shared fixtures outside the timing, their
+		//random input doesn't depend on which benchmarks ran before
+		srand(BENCH_SEED);
+		it->function(0);
+
+		int iterations = 1;
+		double seconds = runBenchmark(*it, iterations);
+		while (seconds < MIN_RUN_TIME && iterations < (1 << 30))
+		{
+			iterations *= (seconds > 0) ? std::min(100.0, std::max(2.0, 1.5 * MIN_RUN_TIME / seconds)) : 100;
+			seconds = runBenchmark(*it, iterations);
+		}
+
+		if (json)
+		{
+			std::cout << ((first) ? "\n" : ",\n") << "    { \"name\": " << toJSONString(it->name)
+				<< ", \"ns_per_iter\": " << std::fixed << std::setprecision(1) << seconds / iterations * 1e9
+				<< ", \"iterations\": " << iterations << " }" << std::flush;
+			first = false;
+		}
+		else
+		{
+			std::cout << std::left << std::setw(48) << it->name << std::right << std::setw(14) << std::fixed << std::setprecision(1)
+				<< seconds / iterations * 1e9 << " ns/iter" << std::setw(12) << iterations << " iterations" << std::endl;
+		}
+	}
+
+	if (json)
+		std::cout << "\n  ]\n}" << std::endl;
+	return 0;
+}
@@ -0,0 +1,112 @@
+#include <cstdlib>
+#include "Bench.h"
+#include "VRMenuGrid.h"
+
+//Layout of a VRMenu with one widget per cell, as VRMenu::addElement places them
+#define MENU_WIDTH 0.5
+#define MENU_HEIGHT 0.5
+#define BORDER 0.002
+
+struct MenuRect {
+	double x, y, width, height;
+};
+
+struct MenuLayout {
+	int col, row;
+	std::vector<MenuRect> elements;
+	std::vector<double> points;
+	VRMenuGrid grid;
+
+	MenuLayout(int col, int row) : col(col), row(row), grid(col, row, MENU_WIDTH, MENU_HEIGHT)
+	{
+		double col_width = MENU_WIDTH / col;
+		double row_height = MENU_HEIGHT / row;
+		for (int r = 1; r <= row; r++)
+		{
+			for (int c = 1; c <= col; c++)
+			{
+				MenuRect rect;
+				rect.x = -MENU_WIDTH * 0.5 + col_width * (c - 1) + BORDER;
+				rect.y = MENU_HEIGHT - row_height * r + BORDER;
+				rect.width = col_width - 2.0 * BORDER;
+				rect.height = row_height - 2.0 * BORDER;
+				grid.addElement(elements.size(), c, r, 1, 1);
+				elements.push_back(rect);
+			}
+		}
+
+		for (int i = 0; i < 1024; i++)
+		{
+			points.push_back(-MENU_WIDTH * 0.5 + MENU_WIDTH * rand() / RAND_MAX);
+			points.push_back(MENU_HEIGHT * rand() / RAND_MAX);
+		}
+	}
+};
+
+static inline bool hit(const MenuRect &rect, double x, double y)
+{
+	return x >= rect.x && y >= rect.y && x <= rect.x + rect.width && y <= rect.y + rect.height;
+}
+
+static void linearHitTest(MenuLayout &layout, int iterations)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		double x = layout.points[(i % 1024) * 2];
+		double y = layout.points[(i % 1024) * 2 + 1];
+		int found = -1;
+		for (int e = 0; e < layout.elements.size(); e++)
+		{
+			if (hit(layout.elements[e], x, y))
+			{
+				found = e;
+				break;
+			}
+		}
+		doNotOptimize(found);
+	}
+}
+
+static void gridHitTest(MenuLayout &layout, int iterations)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		double x = layout.points[(i % 1024) * 2];
+		double y = layout.points[(i % 1024) * 2 + 1];
+		int found = -1;
+		const std::vector<int> &candidates = layout.grid.getElements(x, y);
+		for (std::vector<int>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+		{
+			if (hit(layout.elements[*it], x, y))
+			{
+				found = *it;
+				break;
+			}
+		}
+		doNotOptimize(found);
+	}
+}
+
+HOLO_BENCH(menu_hittest_linear_100)
+{
+	static MenuLayout layout(10, 10);
+	linearHitTest(layout, iterations);
+}
+
+HOLO_BENCH(menu_hittest_grid_100)
+{
+	static MenuLayout layout(10, 10);
+	gridHitTest(layout, iterations);
+}
+
+HOLO_BENCH(menu_hittest_linear_400)
+{
+	static MenuLayout layout(20, 20);
+	linearHitTest(layout, iterations);
+}
+
+HOLO_BENCH(menu_hittest_grid_400)
+{
+	static MenuLayout layout(20, 20);
+	gridHitTest(layout, iterations);
+}
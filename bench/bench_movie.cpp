@@ -0,0 +1,31 @@
+#include <chrono>
+#include <thread>
+#include "Bench.h"
+#include "MoviePlayer.h"
+
+//Plays a movie in which frame 1 never becomes ready, with a render loop of about
+//1000 Hz. The player has to hold frame 1 for MOVIE_MAX_WAIT seconds before it drops
+//it, so an iteration takes 1 / MOVIE_FPS for frame 0 plus the wait, 0.35 s. A much
+//shorter time means the clock kept running while waiting.
+
+#define MOVIE_FPS 10.0
+#define MOVIE_MAX_WAIT 0.25
+#define MOVIE_FRAMES 30
+
+HOLO_BENCH(movie_wait_not_ready)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		MoviePlayer player(MOVIE_FPS, MOVIE_MAX_WAIT, 1);
+		player.start(0);
+		for (;;)
+		{
+			int frame = (int)player.getDueFrame(MOVIE_FRAMES);
+			if (frame >= 2)
+				break;
+			player.present(MOVIE_FRAMES, 1, frame != 1);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		player.stop();
+	}
+}
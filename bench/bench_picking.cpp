@@ -0,0 +1,81 @@
+#include <cstdlib>
+#include <iostream>
+#include "Bench.h"
+#include "HologramPicker.h"
+
+//Stack of frames with randomly placed particles, picked with rays
+//shot from in front of the stack like checkHologramIntersect does.
+#define PICK_FRAMES 200
+#define PICK_QUADS 500
+#define PICK_RAYS 256
+
+struct PickScene {
+	HologramSnapshot snapshot;
+	std::vector<float> rays;
+
+	PickScene()
+	{
+		for (int i = 0; i < PICK_FRAMES; i++)
+		{
+			std::vector<PickQuad> quads;
+			for (int j = 0; j < PICK_QUADS; j++)
+			{
+				PickQuad q;
+				float x = 10.0f * rand() / RAND_MAX - 5.0f;
+				float y = 10.0f * rand() / RAND_MAX - 5.0f;
+				float size = 0.05f + 0.2f * rand() / RAND_MAX;
+				q.xmin = x - size;
+				q.xmax = x + size;
+				q.ymin = y - size;
+				q.ymax = y + size;
+				q.z = -0.2f * rand() / RAND_MAX;
+				quads.push_back(q);
+			}
+			snapshot.addFrame(i, quads);
+		}
+
+		for (int i = 0; i < PICK_RAYS; i++)
+		{
+			rays.push_back(4.0f * rand() / RAND_MAX - 2.0f);
+			rays.push_back(4.0f * rand() / RAND_MAX - 2.0f);
+			rays.push_back(1.0f);
+			rays.push_back(0.5f * rand() / RAND_MAX - 0.25f);
+			rays.push_back(0.5f * rand() / RAND_MAX - 0.25f);
+			rays.push_back(-5.0f);
+		}
+
+		int mismatches = 0;
+		for (int i = 0; i < PICK_RAYS; i++)
+		{
+			PickHit a, b;
+			bool hit_a = pickHologramScalar<StackMode>(snapshot, &rays[i * 6], &rays[i * 6 + 3], 0, PICK_FRAMES - 1, 0.1, 5.0, a);
+			bool hit_b = pickHologram<StackMode>(snapshot, &rays[i * 6], &rays[i * 6 + 3], 0, PICK_FRAMES - 1, 0.1, 5.0, b);
+			if (hit_a != hit_b || (hit_a && (a.frame != b.frame || a.quad != b.quad)))
+				mismatches++;
+		}
+		if (mismatches > 0)
+			std::cerr << "pickHologram differs from the scalar version for " << mismatches << " of " << PICK_RAYS << " rays" << std::endl;
+	}
+};
+
+HOLO_BENCH(picking_scalar_100k)
+{
+	PickScene &scene = getFixture<PickScene>();
+	for (int i = 0; i < iterations; i++)
+	{
+		PickHit hit;
+		const float *ray = &scene.rays[(i % PICK_RAYS) * 6];
+		doNotOptimize(pickHologramScalar<StackMode>(scene.snapshot, ray, ray + 3, 0, PICK_FRAMES - 1, 0.1, 5.0, hit));
+	}
+}
+
+HOLO_BENCH(picking_simd_100k)
+{
+	PickScene &scene = getFixture<PickScene>();
+	for (int i = 0; i < iterations; i++)
+	{
+		PickHit hit;
+		const float *ray = &scene.rays[(i % PICK_RAYS) * 6];
+		doNotOptimize(pickHologram<StackMode>(scene.snapshot, ray, ray + 3, 0, PICK_FRAMES - 1, 0.1, 5.0, hit));
+	}
+}
@@ -0,0 +1,98 @@
+#include <png.h>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include "Bench.h"
+#include "PngDecoder.h"
+
+#ifdef HAVE_OPENCV
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#endif
+
+//A keyed ROI like the ones in the cruise folders, a noisy particle on a background
+//whose red channel differs from blue
+#define ROI_WIDTH 256
+#define ROI_HEIGHT 192
+
+static void writeToVector(png_structp png, png_bytep data, png_size_t size)
+{
+	std::vector<unsigned char> *bytes = (std::vector<unsigned char> *)png_get_io_ptr(png);
+	bytes->insert(bytes->end(), data, data + size);
+}
+
+//the encoded file, decoding runs from memory like in the loader
+struct PngFile {
+	std::vector<unsigned char> bytes;
+
+	PngFile()
+	{
+		std::vector<unsigned char> pixels(3 * ROI_WIDTH * ROI_HEIGHT);
+		for (int y = 0; y < ROI_HEIGHT; y++)
+		{
+			for (int x = 0; x < ROI_WIDTH; x++)
+			{
+				unsigned char *rgb = &pixels[3 * (y * ROI_WIDTH + x)];
+				float dx = x - ROI_WIDTH * 0.5f, dy = y - ROI_HEIGHT * 0.5f;
+				unsigned char gray = 60 + rand() % 40;
+				bool inside = std::sqrt(dx * dx + dy * dy) < ROI_HEIGHT * 0.4f;
+				rgb[0] = inside ? gray : 255;
+				rgb[1] = gray;
+				rgb[2] = gray;
+			}
+		}
+
+		png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+		png_infop info = png_create_info_struct(png);
+		if (setjmp(png_jmpbuf(png)))
+		{
+			png_destroy_write_struct(&png, &info);
+			bytes.clear();
+			return;
+		}
+		png_set_write_fn(png, &bytes, writeToVector, NULL);
+		png_set_IHDR(png, info, ROI_WIDTH, ROI_HEIGHT, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+		png_write_info(png, info);
+		for (int y = 0; y < ROI_HEIGHT; y++)
+			png_write_row(png, &pixels[3 * y * ROI_WIDTH]);
+		png_write_end(png, NULL);
+		png_destroy_write_struct(&png, &info);
+	}
+};
+
+HOLO_BENCH(png_decode_keyed)
+{
+	const std::vector<unsigned char> &bytes = getFixture<PngFile>().bytes;
+	HologramTexture texture;
+	BufferPool pool;
+	for (int i = 0; i < iterations; i++)
+	{
+		if (!decodeKeyedPNG(&bytes[0], bytes.size(), texture, pool))
+			std::cerr << "png decode failed" << std::endl;
+		doNotOptimize(texture.data[0]);
+		pool.release(texture.data);
+	}
+}
+
+#ifdef HAVE_OPENCV
+//the former path, decoding into BGR and a second pass into a new RGBA image
+HOLO_BENCH(png_decode_opencv_keyed)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		cv::Mat image_orig = cv::imdecode(getFixture<PngFile>().bytes, cv::IMREAD_COLOR);
+		cv::Mat image_transparent = cv::Mat(image_orig.rows, image_orig.cols, CV_8UC4);
+		for (int r = 0; r < image_orig.rows; r++)
+		{
+			for (int c = 0; c < image_orig.cols; c++)
+			{
+				cv::Vec3b pixel = image_orig.at<cv::Vec3b>(r, c);
+				cv::Vec4b &out = image_transparent.at<cv::Vec4b>(r, c);
+				out[0] = out[1] = out[2] = pixel[0];
+				out[3] = (pixel[2] != pixel[0]) ? 0 : 255;
+			}
+		}
+		doNotOptimize(image_transparent.data[0]);
+	}
+}
+#endif
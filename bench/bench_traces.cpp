@@ -0,0 +1,67 @@
+#include <cstdlib>
+#include "Bench.h"
+#include "Traces.h"
+
+//Frames of a cruise where particles stay for a while and then leave, traces are
+//built for a frame deep enough into the cruise to reach back the full length
+#define TRACE_FRAMES 100
+#define TRACE_QUADS 1000
+#define TRACE_LIFETIME 20
+#define TRACE_BENCH_LENGTH 20
+
+struct TraceScene {
+	std::vector<DataSet> data;
+
+	TraceScene()
+	{
+		std::vector<int> ids(TRACE_QUADS);
+		int nextID = 1;
+		for (int j = 0; j < TRACE_QUADS; j++)
+			ids[j] = nextID++;
+
+		data.resize(TRACE_FRAMES);
+		for (int i = 0; i < TRACE_FRAMES; i++)
+		{
+			data[i].id = i;
+			for (int j = 0; j < TRACE_QUADS; j++)
+			{
+				if (rand() % TRACE_LIFETIME == 0)
+					ids[j] = nextID++;
+
+				hologram q;
+				q.center[0] = 10.0f * rand() / RAND_MAX - 5.0f;
+				q.center[1] = 10.0f * rand() / RAND_MAX - 5.0f;
+				q.center[2] = -0.2f * rand() / RAND_MAX;
+				q.halfExtent[0] = q.halfExtent[1] = 0.1f;
+				q.ID = ids[j];
+				data[i].quads.push_back(q);
+			}
+			//the order of the ROIs in a report changes between frames
+			for (int j = TRACE_QUADS - 1; j > 0; j--)
+				std::swap(data[i].quads[j], data[i].quads[rand() % (j + 1)]);
+		}
+	}
+};
+
+HOLO_BENCH(traces_contour_by_id_1k)
+{
+	TraceScene &scene = getFixture<TraceScene>();
+	int found = 0;
+	for (int i = 0; i < iterations; i++)
+	{
+		const DataSet &set = scene.data[i % TRACE_FRAMES];
+		found += getContourByID(set, set.quads[(i * 7919) % TRACE_QUADS].ID);
+	}
+	doNotOptimize(found);
+}
+
+HOLO_BENCH(traces_build_1k)
+{
+	TraceScene &scene = getFixture<TraceScene>();
+	std::vector<float> vertices;
+	for (int i = 0; i < iterations; i++)
+	{
+		buildTraceVertices(scene.data, TRACE_FRAMES - 1 - i % (TRACE_FRAMES - TRACE_BENCH_LENGTH), TRACE_BENCH_LENGTH, 1, vertices);
+		doNotOptimize(vertices.size());
+	}
+}
@@ -0,0 +1,730 @@
+#ifdef _MSC_VER
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+
+#include <zlib.h>
+
+#include "ArchiveRoot.h"
+
+//inflated bytes between two access points of a tar.gz, each point keeps a 32 KB window
+#define GZIP_SPAN (4 * 1024 * 1024)
+#define GZIP_WINDOW 32768
+//zlib counts its input in 32 bit
+#define ZLIB_CHUNK (1 << 30)
+
+#define TAR_BLOCK 512
+#define ZIP_LOCAL_HEADER 0x04034b50
+#define ZIP_CENTRAL_HEADER 0x02014b50
+#define ZIP_END 0x06054b50
+#define ZIP64_END 0x06064b50
+#define ZIP64_LOCATOR 0x07064b50
+
+//A read only mapping of a whole file
+class MappedFile {
+public:
+	MappedFile() : data(NULL), size(0)
+	{
+#ifdef _MSC_VER
+		m_file = INVALID_HANDLE_VALUE;
+		m_mapping = NULL;
+#endif
+	}
+
+	~MappedFile()
+	{
+#ifdef _MSC_VER
+		if (data)
+			UnmapViewOfFile(data);
+		if (m_mapping)
+			CloseHandle(m_mapping);
+		if (m_file != INVALID_HANDLE_VALUE)
+			CloseHandle(m_file);
+#else
+		if (data)
+			munmap((void *)data, size);
+#endif
+	}
+
+	bool open(const std::string &path)
+	{
+#ifdef _MSC_VER
+		m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		LARGE_INTEGER fileSize;
+		if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0)
+			return false;
+		m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (m_mapping == NULL)
+			return false;
+		data = (const unsigned char *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+		size = fileSize.QuadPart;
+		return data != NULL;
+#else
+		int descriptor = ::open(path.c_str(), O_RDONLY);
+		struct stat info;
+		if (descriptor < 0 || fstat(descriptor, &info) != 0 || info.st_size == 0)
+		{
+			if (descriptor >= 0)
+				close(descriptor);
+			return false;
+		}
+		void *mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		close(descriptor);
+		if (mapping == MAP_FAILED)
+			return false;
+		data = (const unsigned char *)mapping;
+		size = info.st_size;
+		return true;
+#endif
+	}
+
+	const unsigned char *data;
+	unsigned long long size;
+
+private:
+#ifdef _MSC_VER
+	HANDLE m_file;
+	HANDLE m_mapping;
+#endif
+};
+
+static unsigned int read16(const unsigned char *bytes)
+{
+	return bytes[0] | (bytes[1] << 8);
+}
+
+static unsigned int read32(const unsigned char *bytes)
+{
+	return read16(bytes) | ((unsigned int)read16(bytes + 2) << 16);
+}
+
+static unsigned long long read64(const unsigned char *bytes)
+{
+	return read32(bytes) | ((unsigned long long)read32(bytes + 4) << 32);
+}
+
+//octal, or base-256 for large values when the first bit is set
+static unsigned long long readTarNumber(const unsigned char *field, int length)
+{
+	unsigned long long value = 0;
+	if (field[0] & 0x80)
+	{
+		value = field[0] & 0x7f;
+		for (int i = 1; i < length; i++)
+			value = (value << 8) | field[i];
+		return value;
+	}
+	for (int i = 0; i < length && field[i] != 0; i++)
+	{
+		if (field[i] >= '0' && field[i] <= '7')
+			value = value * 8 + field[i] - '0';
+	}
+	return value;
+}
+
+static std::string readTarString(const unsigned char *field, int length)
+{
+	int end = 0;
+	while (end < length && field[end] != 0)
+		end++;
+	return std::string((const char *)field, end);
+}
+
+//Builds the index of a tar from its bytes, which are fed in pieces of any size so a
+//tar.gz can be indexed while it is inflated. Handles ustar prefixes, GNU long names
+//and pax headers.
+class TarIndexer {
+public:
+	TarIndexer(std::map<std::string, ArchiveEntry> &entries) : m_entries(entries), m_headerFill(0), m_offset(0),
+		m_skip(0), m_special(0), m_specialLeft(0), m_paxSize(0), m_hasPaxSize(false), m_finished(false), m_valid(true)
+	{
+
+	}
+
+	void feed(const unsigned char *data, unsigned long long size)
+	{
+		while (size > 0 && !m_finished)
+		{
+			if (m_skip > 0)
+			{
+				unsigned long long count = std::min(m_skip, size);
+				unsigned long long taken = std::min(count, m_specialLeft);
+				m_specialData.append((const char *)data, taken);
+				m_specialLeft -= taken;
+				m_skip -= count;
+				m_offset += count;
+				data += count;
+				size -= count;
+				if (m_skip == 0 && m_special)
+					parseSpecial();
+				continue;
+			}
+
+			unsigned long long count = std::min((unsigned long long)TAR_BLOCK - m_headerFill, size);
+			memcpy(m_header + m_headerFill, data, count);
+			m_headerFill += count;
+			m_offset += count;
+			data += count;
+			size -= count;
+			if (m_headerFill == TAR_BLOCK)
+			{
+				m_headerFill = 0;
+				parseHeader();
+			}
+		}
+	}
+
+	//a tar ends with zero blocks, archives cut short still keep the files before
+	bool isValid()
+	{
+		return m_valid && !m_entries.empty();
+	}
+
+private:
+	void parseHeader()
+	{
+		unsigned int sum = 0;
+		bool empty = true;
+		for (int i = 0; i < TAR_BLOCK; i++)
+		{
+			sum += (i >= 148 && i < 156) ? ' ' : m_header[i];
+			empty = empty && m_header[i] == 0;
+		}
+		if (empty)
+		{
+			m_finished = true;
+			return;
+		}
+		if (sum != readTarNumber(m_header + 148, 8))
+		{
+			m_valid = false;
+			m_finished = true;
+			return;
+		}
+
+		unsigned long long size = m_hasPaxSize ? m_paxSize : readTarNumber(m_header + 124, 12);
+		std::string name = m_longName;
+		if (name.empty())
+		{
+			name = readTarString(m_header, 100);
+			if (memcmp(m_header + 257, "ustar", 5) == 0 && m_header[345] != 0)
+				name = readTarString(m_header + 345, 155) + "/" + name;
+		}
+
+		char type = m_header[156];
+		if (type == 'L' || type == 'x')
+		{
+			m_special = type;
+			m_specialData.clear();
+			m_specialLeft = size;
+		}
+		else
+		{
+			while (name.compare(0, 2, "./") == 0)
+				name.erase(0, 2);
+			if ((type == '0' || type == '\0' || type == '7') && !name.empty() && name[name.size() - 1] != '/')
+			{
+				ArchiveEntry &entry = m_entries[name];
+				entry.offset = m_offset;
+				entry.size = size;
+				entry.compressedSize = size;
+				entry.method = 0;
+				entry.time = readTarNumber(m_header + 136, 12);
+			}
+			m_longName.clear();
+			m_hasPaxSize = false;
+		}
+
+		m_skip = (size + TAR_BLOCK - 1) / TAR_BLOCK * TAR_BLOCK;
+		if (m_skip == 0 && m_special)
+			parseSpecial();
+	}
+
+	void parseSpecial()
+	{
+		if (m_special == 'L')
+		{
+			m_longName = m_specialData.c_str();
+		}
+		else
+		{
+			//records of "length key=value\n"
+			size_t position = 0;
+			while (position < m_specialData.size())
+			{
+				size_t length = strtoul(m_specialData.c_str() + position, NULL, 10);
+				size_t space = m_specialData.find(' ', position);
+				if (length == 0 || space == std::string::npos || position + length > m_specialData.size())
+					break;
+				std::string record = m_specialData.substr(space + 1, position + length - space - 2);
+				size_t equals = record.find('=');
+				if (equals != std::string::npos)
+				{
+					std::string key = record.substr(0, equals);
+					if (key == "path")
+					{
+						m_longName = record.substr(equals + 1);
+					}
+					else if (key == "size")
+					{
+						m_paxSize = strtoull(record.c_str() + equals + 1, NULL, 10);
+						m_hasPaxSize = true;
+					}
+				}
+				position += length;
+			}
+		}
+		m_special = 0;
+	}
+
+	std::map<std::string, ArchiveEntry> &m_entries;
+	unsigned char m_header[TAR_BLOCK];
+	unsigned long long m_headerFill;
+	unsigned long long m_offset;
+	unsigned long long m_skip;
+	char m_special;
+	std::string m_specialData;
+	unsigned long long m_specialLeft;
+	std::string m_longName;
+	unsigned long long m_paxSize;
+	bool m_hasPaxSize;
+	bool m_finished;
+	bool m_valid;
+};
+
+ArchiveRoot::ArchiveRoot(BufferPool &pool) : m_pool(pool), m_file(NULL), m_format(TAR), m_stream(NULL), m_streamValid(false), m_streamIn(0), m_streamOut(0)
+{
+
+}
+
+ArchiveRoot::~ArchiveRoot()
+{
+	if (m_stream)
+	{
+		inflateEnd(m_stream);
+		delete m_stream;
+	}
+	delete m_file;
+}
+
+bool ArchiveRoot::open(const std::string &path)
+{
+	m_file = new MappedFile();
+	if (!m_file->open(path) || m_file->size < 4)
+		return false;
+
+	const unsigned char *data = m_file->data;
+	bool indexed;
+	if (read32(data) == ZIP_LOCAL_HEADER || read32(data) == ZIP_END)
+	{
+		m_format = ZIP;
+		indexed = indexZip();
+	}
+	else if (data[0] == 0x1f && data[1] == 0x8b)
+	{
+		m_format = TAR_GZ;
+		indexed = indexTarGz();
+	}
+	else
+	{
+		m_format = TAR;
+		indexed = indexTar();
+	}
+	if (!indexed)
+		return false;
+
+	findPrefix();
+	return true;
+}
+
+std::string ArchiveRoot::getName()
+{
+	if (m_format == ZIP)
+		return "zip archive";
+	return (m_format == TAR_GZ) ? "tar.gz archive" : "tar archive";
+}
+
+bool ArchiveRoot::indexTar()
+{
+	TarIndexer indexer(m_entries);
+	indexer.feed(m_file->data, m_file->size);
+	return indexer.isValid();
+}
+
+//one pass over the whole archive, see build_index in zran.c
+bool ArchiveRoot::indexTarGz()
+{
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	//32 selects gzip decoding with the header
+	if (inflateInit2(&stream, 32 + MAX_WBITS) != Z_OK)
+		return false;
+
+	TarIndexer indexer(m_entries);
+	std::vector<unsigned char> window(GZIP_WINDOW);
+	unsigned long long in = 0, out = 0, last = 0;
+	int ret = Z_OK;
+	stream.avail_out = 0;
+	while (ret != Z_STREAM_END)
+	{
+		if (stream.avail_in == 0)
+		{
+			if (in == m_file->size)
+				break;
+			stream.next_in = (Bytef *)m_file->data + in;
+			stream.avail_in = std::min(m_file->size - in, (unsigned long long)ZLIB_CHUNK);
+		}
+		if (stream.avail_out == 0)
+		{
+			stream.next_out = &window[0];
+			stream.avail_out = GZIP_WINDOW;
+		}
+
+		unsigned int availableIn = stream.avail_in;
+		unsigned char *start = stream.next_out;
+		ret = inflate(&stream, Z_BLOCK);
+		if (ret != Z_OK && ret != Z_STREAM_END)
+			break;
+		in += availableIn - stream.avail_in;
+		indexer.feed(start, stream.next_out - start);
+		out += stream.next_out - start;
+
+		//at the end of a deflate block which is not the last one
+		if ((stream.data_type & 128) && !(stream.data_type & 64) && (out == 0 || out - last > GZIP_SPAN))
+		{
+			m_points.push_back(GzipAccessPoint());
+			GzipAccessPoint &point = m_points.back();
+			point.in = in;
+			point.out = out;
+			point.bits = stream.data_type & 7;
+			point.window.resize(GZIP_WINDOW);
+			//the oldest bytes of the window are the ones after the output position
+			unsigned int left = stream.avail_out;
+			if (left)
+				memcpy(&point.window[0], &window[GZIP_WINDOW - left], left);
+			if (left < GZIP_WINDOW)
+				memcpy(&point.window[left], &window[0], GZIP_WINDOW - left);
+			last = out;
+		}
+	}
+	inflateEnd(&stream);
+
+	//archives with several concatenated gzip members are only read up to the first one
+	return (ret == Z_OK || ret == Z_STREAM_END) && !m_points.empty() && indexer.isValid();
+}
+
+bool ArchiveRoot::indexZip()
+{
+	const unsigned char *data = m_file->data;
+	unsigned long long size = m_file->size;
+
+	//the end record is followed by a comment of up to 64 KB
+	long long end = -1;
+	for (long long position = (long long)size - 22; position >= 0 && position >= (long long)size - 22 - 65535; position--)
+	{
+		if (read32(data + position) == ZIP_END)
+		{
+			end = position;
+			break;
+		}
+	}
+	if (end < 0)
+		return false;
+
+	unsigned long long count = read16(data + end + 10);
+	unsigned long long directorySize = read32(data + end + 12);
+	unsigned long long directory = read32(data + end + 16);
+	if (end >= 20 && read32(data + end - 20) == ZIP64_LOCATOR)
+	{
+		unsigned long long end64 = read64(data + end - 20 + 8);
+		if (end64 + 56 > size || read32(data + end64) != ZIP64_END)
+			return false;
+		count = read64(data + end64 + 32);
+		directorySize = read64(data + end64 + 40);
+		directory = read64(data + end64 + 48);
+	}
+	if (directory + directorySize > size)
+		return false;
+
+	unsigned long long position = directory;
+	for (unsigned long long i = 0; i < count; i++)
+	{
+		if (position + 46 > directory + directorySize || read32(data + position) != ZIP_CENTRAL_HEADER)
+			return false;
+		const unsigned char *header = data + position;
+		unsigned int nameLength = read16(header + 28);
+		unsigned int extraLength = read16(header + 30);
+		unsigned int commentLength = read16(header + 32);
+		if (position + 46 + nameLength + extraLength > directory + directorySize)
+			return false;
+
+		ArchiveEntry entry;
+		entry.method = read16(header + 10);
+		//DOS date and time, only compared for equality
+		entry.time = ((long long)read16(header + 14) << 16) | read16(header + 12);
+		entry.compressedSize = read32(header + 20);
+		entry.size = read32(header + 24);
+		entry.offset = read32(header + 42);
+
+		//the zip64 extra field holds the values which did not fit, in this order
+		const unsigned char *extra = header + 46 + nameLength;
+		for (unsigned int e = 0; e + 4 <= extraLength;)
+		{
+			unsigned int id = read16(extra + e);
+			unsigned int length = read16(extra + e + 2);
+			if (id == 0x0001)
+			{
+				const unsigned char *value = extra + e + 4;
+				const unsigned char *valueEnd = value + std::min(length, extraLength - e - 4);
+				if (entry.size == 0xffffffff && value + 8 <= valueEnd)
+				{
+					entry.size = read64(value);
+					value += 8;
+				}
+				if (entry.compressedSize == 0xffffffff && value + 8 <= valueEnd)
+				{
+					entry.compressedSize = read64(value);
+					value += 8;
+				}
+				if (entry.offset == 0xffffffff && value + 8 <= valueEnd)
+					entry.offset = read64(value);
+			}
+			e += 4 + length;
+		}
+
+		std::string name((const char *)header + 46, nameLength);
+		if (!name.empty() && name[name.size() - 1] != '/')
+			m_entries[name] = entry;
+		position += 46 + nameLength + extraLength + commentLength;
+	}
+	return !m_entries.empty();
+}
+
+//archives made from the folder of the cruise have one top folder without files in it
+void ArchiveRoot::findPrefix()
+{
+	std::set<std::string> top;
+	bool filesInTop = false;
+	for (std::map<std::string, ArchiveEntry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+	{
+		size_t first = it->first.find('/');
+		if (first == std::string::npos || it->first.find('/', first + 1) == std::string::npos)
+			filesInTop = true;
+		else
+			top.insert(it->first.substr(0, first));
+	}
+	if (top.size() == 1 && !filesInTop)
+		m_prefix = *top.begin() + "/";
+}
+
+std::vector<std::string> ArchiveRoot::getSubDirectories()
+{
+	//the entries are sorted, so are the folders
+	std::vector<std::string> subdirectories;
+	for (std::map<std::string, ArchiveEntry>::const_iterator it = m_entries.lower_bound(m_prefix); it != m_entries.end(); ++it)
+	{
+		if (it->first.compare(0, m_prefix.size(), m_prefix) != 0)
+			break;
+		size_t end = it->first.find('/', m_prefix.size());
+		if (end == std::string::npos)
+			continue;
+		std::string folder = it->first.substr(m_prefix.size(), end - m_prefix.size());
+		if (subdirectories.empty() || subdirectories.back() != folder)
+			subdirectories.push_back(folder);
+	}
+	std::sort(subdirectories.begin(), subdirectories.end());
+	subdirectories.erase(std::unique(subdirectories.begin(), subdirectories.end()), subdirectories.end());
+	return subdirectories;
+}
+
+bool ArchiveRoot::getInfo(const std::string &path, long long &size, long long &time)
+{
+	std::map<std::string, ArchiveEntry>::const_iterator it = m_entries.find(m_prefix + path);
+	if (it == m_entries.end())
+		return false;
+
+	size = it->second.size;
+	time = it->second.time;
+	return true;
+}
+
+std::string ArchiveRoot::getWritablePath(const std::string &path)
+{
+	return "";
+}
+
+void ArchiveRoot::read(std::vector<FileRead> &files)
+{
+	//a tar.gz is read front to back, the other formats in any order
+	std::vector<std::pair<unsigned long long, int> > order;
+	std::vector<const ArchiveEntry *> entries(files.size(), NULL);
+	for (int i = 0; i < files.size(); i++)
+	{
+		FileRead &file = files[i];
+		file.size = 0;
+		file.time = 0;
+		file.ok = false;
+
+		std::map<std::string, ArchiveEntry>::const_iterator it = m_entries.find(m_prefix + file.filename);
+		if (it == m_entries.end())
+			continue;
+		entries[i] = &it->second;
+		order.push_back(std::make_pair(it->second.offset, i));
+	}
+	std::sort(order.begin(), order.end());
+
+	for (std::vector<std::pair<unsigned long long, int> >::const_iterator it = order.begin(); it != order.end(); ++it)
+	{
+		FileRead &file = files[it->second];
+		const ArchiveEntry &entry = *entries[it->second];
+		file.size = entry.size;
+		file.time = entry.time;
+		m_pool.acquire(file.data, entry.size);
+
+		if (m_format == ZIP)
+		{
+			file.ok = readZipEntry(entry, file);
+		}
+		else if (m_format == TAR)
+		{
+			file.ok = entry.offset + entry.size <= m_file->size;
+			if (file.ok && entry.size > 0)
+				memcpy(&file.data[0], m_file->data + entry.offset, entry.size);
+		}
+		else
+		{
+			file.ok = seekGzip(entry.offset) && inflateGzip(file.data.empty() ? NULL : &file.data[0], entry.size);
+		}
+	}
+}
+
+bool ArchiveRoot::readZipEntry(const ArchiveEntry &entry, FileRead &file)
+{
+	const unsigned char *header = m_file->data + entry.offset;
+	if (entry.offset + 30 > m_file->size || read32(header) != ZIP_LOCAL_HEADER)
+		return false;
+	unsigned long long offset = entry.offset + 30 + read16(header + 26) + read16(header + 28);
+	if (offset + entry.compressedSize > m_file->size)
+		return false;
+
+	if (entry.method == 0)
+	{
+		if (entry.compressedSize != entry.size)
+			return false;
+		if (entry.size > 0)
+			memcpy(&file.data[0], m_file->data + offset, entry.size);
+		return true;
+	}
+	if (entry.method != Z_DEFLATED)
+		return false;
+
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	//zip entries are raw deflate without a header
+	if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+		return false;
+
+	unsigned long long in = 0, out = 0;
+	int ret = Z_OK;
+	while (ret == Z_OK)
+	{
+		if (stream.avail_in == 0)
+		{
+			stream.next_in = (Bytef *)m_file->data + offset + in;
+			stream.avail_in = std::min(entry.compressedSize - in, (unsigned long long)ZLIB_CHUNK);
+			in += stream.avail_in;
+		}
+		if (stream.avail_out == 0)
+		{
+			stream.next_out = file.data.empty() ? NULL : &file.data[0] + out;
+			stream.avail_out = std::min(entry.size - out, (unsigned long long)ZLIB_CHUNK);
+			out += stream.avail_out;
+		}
+		ret = inflate(&stream, Z_NO_FLUSH);
+		if (ret == Z_BUF_ERROR && (stream.avail_in > 0 || in < entry.compressedSize) && (stream.avail_out > 0 || out < entry.size))
+			ret = Z_OK;
+		else if (ret == Z_BUF_ERROR)
+			break;
+	}
+	bool ok = ret == Z_STREAM_END && stream.avail_out == 0 && out == entry.size;
+	inflateEnd(&stream);
+	return ok;
+}
+
+static bool isBeforePoint(unsigned long long offset, const GzipAccessPoint &point)
+{
+	return offset < point.out;
+}
+
+//continues the running inflate when offset is ahead of it and no access point is closer
+bool ArchiveRoot::seekGzip(unsigned long long offset)
+{
+	std::vector<GzipAccessPoint>::const_iterator point = std::upper_bound(m_points.begin(), m_points.end(), offset, isBeforePoint) - 1;
+
+	if (!m_streamValid || offset < m_streamOut || point->out > m_streamOut)
+	{
+		if (m_stream == NULL)
+		{
+			m_stream = new z_stream;
+			memset(m_stream, 0, sizeof(z_stream));
+			if (inflateInit2(m_stream, -MAX_WBITS) != Z_OK)
+			{
+				delete m_stream;
+				m_stream = NULL;
+				return false;
+			}
+		}
+		else
+		{
+			inflateReset(m_stream);
+		}
+
+		//the point can be in the middle of a byte, its first bits are fed separately
+		m_stream->avail_in = 0;
+		m_streamIn = point->in;
+		m_streamOut = point->out;
+		if (point->bits)
+			inflatePrime(m_stream, point->bits, m_file->data[point->in - 1] >> (8 - point->bits));
+		inflateSetDictionary(m_stream, &point->window[0], GZIP_WINDOW);
+		m_streamValid = true;
+	}
+
+	//skipping inflates into the window of the point, nothing reads it anymore
+	std::vector<unsigned char> skipped(GZIP_WINDOW);
+	while (m_streamValid && m_streamOut < offset)
+		inflateGzip(&skipped[0], std::min(offset - m_streamOut, (unsigned long long)GZIP_WINDOW));
+	return m_streamValid;
+}
+
+bool ArchiveRoot::inflateGzip(unsigned char *data, unsigned long long size)
+{
+	unsigned long long out = 0;
+	while (m_streamValid && out < size)
+	{
+		if (m_stream->avail_in == 0)
+		{
+			m_stream->next_in = (Bytef *)m_file->data + m_streamIn;
+			m_stream->avail_in = std::min(m_file->size - m_streamIn, (unsigned long long)ZLIB_CHUNK);
+			m_streamIn += m_stream->avail_in;
+		}
+		m_stream->next_out = data + out;
+		m_stream->avail_out = std::min(size - out, (unsigned long long)ZLIB_CHUNK);
+		unsigned int available = m_stream->avail_out;
+		int ret = inflate(m_stream, Z_NO_FLUSH);
+		out += available - m_stream->avail_out;
+		m_streamOut += available - m_stream->avail_out;
+		if ((ret != Z_OK && ret != Z_BUF_ERROR) || (ret == Z_BUF_ERROR && m_stream->avail_in == 0 && m_streamIn == m_file->size))
+			m_streamValid = false;
+	}
+	return out == size;
+}
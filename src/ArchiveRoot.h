@@ -0,0 +1,75 @@
+#ifndef ARCHIVEROOT_H
+#define ARCHIVEROOT_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "DataRoot.h"
+
+typedef struct z_stream_s z_stream;
+class MappedFile;
+
+struct ArchiveEntry {
+	//of the data in a tar, of the inflated data in a tar.gz, of the local header in a zip
+	unsigned long long offset;
+	unsigned long long size;
+	unsigned long long compressedSize;
+	//zip compression method, 0 stored, 8 deflated
+	int method;
+	long long time;
+};
+
+//a place in a gzip stream inflating can start from, see zran.c of zlib
+struct GzipAccessPoint {
+	unsigned long long in;
+	unsigned long long out;
+	int bits;
+	std::vector<unsigned char> window;
+};
+
+//A tar, tar.gz or zip archive of a cruise, read in place. The archive is memory mapped
+//and indexed once when it is opened. Files of a tar and stored files of a zip are copied
+//from the mapping by offset, deflated zip entries are inflated one by one. A tar.gz can
+//only be inflated from the front, so the index remembers access points every few MB and
+//a batch is read in archive order with one running inflate that skips to the next file.
+class ArchiveRoot : public DataRoot {
+public:
+	ArchiveRoot(BufferPool &pool);
+	virtual ~ArchiveRoot();
+
+	bool open(const std::string &path);
+
+	virtual std::string getName();
+	virtual std::vector<std::string> getSubDirectories();
+	virtual bool getInfo(const std::string &path, long long &size, long long &time);
+	virtual void read(std::vector<FileRead> &files);
+	virtual std::string getWritablePath(const std::string &path);
+
+private:
+	enum Format { TAR, TAR_GZ, ZIP };
+
+	bool indexTar();
+	bool indexTarGz();
+	bool indexZip();
+	void findPrefix();
+
+	bool readZipEntry(const ArchiveEntry &entry, FileRead &file);
+	bool seekGzip(unsigned long long offset);
+	bool inflateGzip(unsigned char *data, unsigned long long size);
+
+	BufferPool &m_pool;
+	MappedFile *m_file;
+	Format m_format;
+	//the folder all frame folders are in when the archive was made from the folder of the cruise
+	std::string m_prefix;
+	std::map<std::string, ArchiveEntry> m_entries;
+
+	std::vector<GzipAccessPoint> m_points;
+	z_stream *m_stream;
+	bool m_streamValid;
+	unsigned long long m_streamIn;
+	unsigned long long m_streamOut;
+};
+
+#endif //ARCHIVEROOT_H
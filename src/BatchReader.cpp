@@ -0,0 +1,198 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cstdio>
+
+#ifdef HAVE_LIBURING
+#include <fcntl.h>
+#include <unistd.h>
+#include <liburing.h>
+#endif
+
+#include "BatchReader.h"
+
+//reads kept in flight, the threads mostly wait for the disk so there are many
+#define BATCH_READ_DEPTH 64
+#define BATCH_READ_THREADS 16
+
+BatchReader::BatchReader(BufferPool &pool) : m_pool(pool), m_ring(NULL), m_files(NULL), m_next(0), m_finished(0), m_running(true)
+{
+#ifdef HAVE_LIBURING
+	m_ring = new io_uring;
+	if (io_uring_queue_init(BATCH_READ_DEPTH, m_ring, 0) < 0)
+	{
+		//kernels before 5.1 or sandboxes which block the syscalls
+		delete m_ring;
+		m_ring = NULL;
+	}
+#endif
+}
+
+BatchReader::~BatchReader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+	}
+	m_startCondition.notify_all();
+	for (std::vector<std::thread>::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+		it->join();
+
+#ifdef HAVE_LIBURING
+	if (m_ring)
+	{
+		io_uring_queue_exit(m_ring);
+		delete m_ring;
+	}
+#endif
+}
+
+std::string BatchReader::getName()
+{
+	return m_ring ? "io_uring" : "threads";
+}
+
+void BatchReader::read(std::vector<FileRead> &files)
+{
+	for (std::vector<FileRead>::iterator it = files.begin(); it != files.end(); ++it)
+	{
+		it->size = 0;
+		it->time = 0;
+		it->ok = false;
+	}
+	if (files.empty())
+		return;
+
+	if (m_ring)
+		readRing(files);
+	else
+		readThreaded(files);
+}
+
+void BatchReader::readFile(FileRead &file)
+{
+	struct stat info;
+	if (stat(file.filename.c_str(), &info) != 0)
+		return;
+
+	FILE *handle = fopen(file.filename.c_str(), "rb");
+	if (handle == NULL)
+		return;
+
+	file.size = info.st_size;
+	file.time = info.st_mtime;
+	m_pool.acquire(file.data, file.size);
+	file.ok = file.data.empty() || fread(&file.data[0], 1, file.data.size(), handle) == file.data.size();
+	fclose(handle);
+}
+
+void BatchReader::readThreaded(std::vector<FileRead> &files)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_threads.size() < BATCH_READ_THREADS)
+		m_threads.push_back(std::thread(&BatchReader::run, this));
+
+	m_files = &files;
+	m_next = 0;
+	m_finished = 0;
+	m_startCondition.notify_all();
+	while (m_finished < files.size())
+		m_doneCondition.wait(lock);
+	m_files = NULL;
+}
+
+void BatchReader::run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		while (m_running && (m_files == NULL || m_next >= m_files->size()))
+			m_startCondition.wait(lock);
+		if (!m_running)
+			return;
+
+		std::vector<FileRead> &files = *m_files;
+		FileRead &file = files[m_next++];
+		lock.unlock();
+		readFile(file);
+		lock.lock();
+
+		if (++m_finished == files.size())
+			m_doneCondition.notify_one();
+	}
+}
+
+#ifdef HAVE_LIBURING
+void BatchReader::readRing(std::vector<FileRead> &files)
+{
+	//files are opened on this thread, their reads are queued until the ring is full
+	std::vector<int> descriptors(files.size(), -1);
+	std::vector<size_t> offsets(files.size(), 0);
+	size_t next = 0;
+	int inFlight = 0;
+	for (;;)
+	{
+		while (inFlight < BATCH_READ_DEPTH && next < files.size())
+		{
+			FileRead &file = files[next];
+			struct stat info;
+			int descriptor = open(file.filename.c_str(), O_RDONLY);
+			if (descriptor < 0 || fstat(descriptor, &info) != 0)
+			{
+				if (descriptor >= 0)
+					close(descriptor);
+				next++;
+				continue;
+			}
+
+			file.size = info.st_size;
+			file.time = info.st_mtime;
+			m_pool.acquire(file.data, file.size);
+			if (file.data.empty())
+			{
+				file.ok = true;
+				close(descriptor);
+				next++;
+				continue;
+			}
+
+			descriptors[next] = descriptor;
+			io_uring_sqe *sqe = io_uring_get_sqe(m_ring);
+			io_uring_prep_read(sqe, descriptor, &file.data[0], file.data.size(), 0);
+			io_uring_sqe_set_data(sqe, (void *)next);
+			inFlight++;
+			next++;
+		}
+		if (inFlight == 0)
+			break;
+
+		io_uring_submit_and_wait(m_ring, 1);
+		io_uring_cqe *cqe;
+		while (io_uring_peek_cqe(m_ring, &cqe) == 0)
+		{
+			size_t index = (size_t)io_uring_cqe_get_data(cqe);
+			int result = cqe->res;
+			io_uring_cqe_seen(m_ring, cqe);
+
+			//short reads continue where they stopped
+			FileRead &file = files[index];
+			if (result > 0 && offsets[index] + result < file.data.size())
+			{
+				offsets[index] += result;
+				io_uring_sqe *sqe = io_uring_get_sqe(m_ring);
+				io_uring_prep_read(sqe, descriptors[index], &file.data[offsets[index]], file.data.size() - offsets[index], offsets[index]);
+				io_uring_sqe_set_data(sqe, (void *)index);
+				continue;
+			}
+
+			file.ok = result > 0 && offsets[index] + result == file.data.size();
+			close(descriptors[index]);
+			inFlight--;
+		}
+	}
+}
+#else
+void BatchReader::readRing(std::vector<FileRead> &files)
+{
+	readThreaded(files);
+}
+#endif
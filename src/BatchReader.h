@@ -0,0 +1,53 @@
+#ifndef BATCHREADER_H
+#define BATCHREADER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BufferPool.h"
+
+struct io_uring;
+
+struct FileRead {
+	std::string filename;
+	//whole file, taken from the pool of the reader
+	std::vector<unsigned char> data;
+	long long size;
+	long long time;
+	bool ok;
+};
+
+//Reads many small files with a number of reads in flight instead of one blocking
+//read after the other. Uses io_uring when built with liburing and the kernel supports
+//it, otherwise a pool of threads which each read a whole file at a time.
+class BatchReader {
+public:
+	BatchReader(BufferPool &pool);
+	~BatchReader();
+
+	std::string getName();
+	void read(std::vector<FileRead> &files);
+
+private:
+	void readFile(FileRead &file);
+	void readThreaded(std::vector<FileRead> &files);
+	void readRing(std::vector<FileRead> &files);
+	void run();
+
+	BufferPool &m_pool;
+	io_uring *m_ring;
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_startCondition;
+	std::condition_variable m_doneCondition;
+	std::vector<FileRead> *m_files;
+	size_t m_next;
+	size_t m_finished;
+	bool m_running;
+};
+
+#endif //BATCHREADER_H
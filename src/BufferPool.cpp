@@ -0,0 +1,103 @@
+#include <iostream>
+#include "BufferPool.h"
+
+//classes below 64 bytes are not worth pooling
+#define MIN_CLASS_BITS 6
+#define CLASS_STEPS 4
+
+BufferPool::BufferPool() : m_acquired(0), m_reused(0), m_bytesInUse(0), m_bytesPooled(0), m_peakBytes(0)
+{
+
+}
+
+BufferPool::~BufferPool()
+{
+
+}
+
+//the smallest class whose size is at least size
+int BufferPool::getSizeClass(size_t size)
+{
+	int sizeClass = 0;
+	while (getClassSize(sizeClass) < size)
+		sizeClass++;
+	return sizeClass;
+}
+
+size_t BufferPool::getClassSize(int sizeClass)
+{
+	size_t base = (size_t)1 << (MIN_CLASS_BITS + sizeClass / CLASS_STEPS);
+	return base + base / CLASS_STEPS * (sizeClass % CLASS_STEPS);
+}
+
+void BufferPool::acquire(std::vector<unsigned char> &buffer, size_t size)
+{
+	if (buffer.capacity() >= size && buffer.capacity() > 0)
+	{
+		buffer.resize(size);
+		return;
+	}
+	release(buffer);
+	if (size == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_acquired++;
+	int sizeClass = getSizeClass(size);
+	if (sizeClass < m_free.size() && !m_free[sizeClass].empty())
+	{
+		buffer.swap(m_free[sizeClass].back());
+		m_free[sizeClass].pop_back();
+		m_bytesPooled -= buffer.capacity();
+		m_reused++;
+	}
+	else
+	{
+		buffer.reserve(getClassSize(sizeClass));
+	}
+	buffer.resize(size);
+
+	m_bytesInUse += buffer.capacity();
+	if (m_bytesInUse > m_peakBytes)
+		m_peakBytes = m_bytesInUse;
+}
+
+void BufferPool::release(std::vector<unsigned char> &buffer)
+{
+	size_t capacity = buffer.capacity();
+	if (capacity < getClassSize(0))
+	{
+		std::vector<unsigned char>().swap(buffer);
+		return;
+	}
+
+	//the largest class the buffer can serve
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int sizeClass = getSizeClass(capacity);
+	if (getClassSize(sizeClass) > capacity)
+		sizeClass--;
+	if (sizeClass >= m_free.size())
+		m_free.resize(sizeClass + 1);
+
+	buffer.clear();
+	m_free[sizeClass].push_back(std::vector<unsigned char>());
+	m_free[sizeClass].back().swap(buffer);
+
+	m_bytesInUse -= (capacity < m_bytesInUse) ? capacity : m_bytesInUse;
+	m_bytesPooled += capacity;
+}
+
+void BufferPool::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::vector<std::vector<std::vector<unsigned char> > >().swap(m_free);
+	m_bytesPooled = 0;
+}
+
+void BufferPool::printStatistics()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::cerr << "Image buffers: " << m_acquired << " requests, " << m_reused << " reused ("
+		<< (m_acquired ? 100.0 * m_reused / m_acquired : 0.0) << "%), peak "
+		<< m_peakBytes / (1024 * 1024) << " MB in use, " << m_bytesPooled / (1024 * 1024) << " MB pooled" << std::endl;
+}
@@ -0,0 +1,38 @@
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+//Reuses the pixel buffers of the loading pipeline. Buffers are kept in size classes,
+//four per power of two, so a released buffer serves any later request of its class
+//instead of a new malloc/free pair per image. The pool can be shared between threads.
+class BufferPool {
+public:
+	BufferPool();
+	~BufferPool();
+
+	//resizes buffer to size, taking the memory from a released buffer if possible
+	void acquire(std::vector<unsigned char> &buffer, size_t size);
+	//hands the memory of buffer back to the pool, buffer is empty afterwards
+	void release(std::vector<unsigned char> &buffer);
+	//frees the released buffers
+	void clear();
+
+	void printStatistics();
+
+private:
+	static int getSizeClass(size_t size);
+	static size_t getClassSize(int sizeClass);
+
+	std::mutex m_mutex;
+	std::vector<std::vector<std::vector<unsigned char> > > m_free;
+	size_t m_acquired;
+	size_t m_reused;
+	size_t m_bytesInUse;
+	size_t m_bytesPooled;
+	size_t m_peakBytes;
+};
+
+#endif //BUFFERPOOL_H
@@ -0,0 +1,302 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include "CoreRenderer.h"
+#include "TextureCodec.h"
+
+#define POSITION_ATTRIBUTE 0
+#define TEXCOORD_ATTRIBUTE 1
+#define COLOR_ATTRIBUTE 2
+#define INSTANCE_ATTRIBUTE 3
+
+static const GLenum primitives[] = { GL_POINTS, GL_LINES, GL_TRIANGLES };
+
+static const char * vertexShaderSource =
+	"#version 330 core\n"
+	"layout(location = 0) in vec3 position;\n"
+	"layout(location = 1) in vec2 texCoord;\n"
+	"layout(location = 2) in vec4 color;\n"
+	"layout(location = 3) in vec2 instance;\n"
+	"uniform mat4 viewProjection;\n"
+	"uniform mat4 model;\n"
+	"out vec2 fragTexCoord;\n"
+	"out vec4 fragColor;\n"
+	"void main()\n"
+	"{\n"
+	"	fragTexCoord = texCoord;\n"
+	"	fragColor = color * instance.y;\n"
+	"	gl_Position = viewProjection * model * vec4(position.xy, position.z + instance.x, 1.0);\n"
+	"}\n";
+
+static const char * fragmentShaderSource =
+	"#version 330 core\n"
+	"uniform sampler2D image;\n"
+	"uniform bool textured;\n"
+	"in vec2 fragTexCoord;\n"
+	"in vec4 fragColor;\n"
+	"out vec4 outColor;\n"
+	"void main()\n"
+	"{\n"
+	"	outColor = textured ? fragColor * texture(image, fragTexCoord) : fragColor;\n"
+	"}\n";
+
+static GLuint compileShader(GLenum type, const char * source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+
+	GLint status;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		std::cerr << "Shader failed to compile: " << log << std::endl;
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+static void multiply(const float *a, const float *b, float *result)
+{
+	for (int c = 0; c < 4; c++)
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			result[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1] + a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+		}
+	}
+}
+
+CoreRenderer::CoreRenderer() : m_program(0), m_vertexArray(0), m_vertexBuffer(0), m_instanceBuffer(0), m_viewProjectionLocation(-1), m_modelLocation(-1), m_texturedLocation(-1), m_maxLineWidth(1.0f)
+{
+
+}
+
+CoreRenderer::~CoreRenderer()
+{
+	if (m_program != 0)
+	{
+		glDeleteProgram(m_program);
+		glDeleteBuffers(1, &m_vertexBuffer);
+		glDeleteBuffers(1, &m_instanceBuffer);
+		glDeleteVertexArrays(1, &m_vertexArray);
+	}
+}
+
+bool CoreRenderer::init()
+{
+	GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+	GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+	if (vertexShader == 0 || fragmentShader == 0)
+		return false;
+
+	m_program = glCreateProgram();
+	glAttachShader(m_program, vertexShader);
+	glAttachShader(m_program, fragmentShader);
+	glLinkProgram(m_program);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	GLint status;
+	glGetProgramiv(m_program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		std::cerr << "Shader program failed to link" << std::endl;
+		glDeleteProgram(m_program);
+		m_program = 0;
+		return false;
+	}
+	m_viewProjectionLocation = glGetUniformLocation(m_program, "viewProjection");
+	m_modelLocation = glGetUniformLocation(m_program, "model");
+	m_texturedLocation = glGetUniformLocation(m_program, "textured");
+	glUseProgram(m_program);
+	glUniform1i(glGetUniformLocation(m_program, "image"), 0);
+	glUseProgram(0);
+
+	glGenVertexArrays(1, &m_vertexArray);
+	glGenBuffers(1, &m_vertexBuffer);
+	glGenBuffers(1, &m_instanceBuffer);
+
+	glBindVertexArray(m_vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glEnableVertexAttribArray(POSITION_ATTRIBUTE);
+	glVertexAttribPointer(POSITION_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof(RenderVertex), (void *)offsetof(RenderVertex, position));
+	glEnableVertexAttribArray(TEXCOORD_ATTRIBUTE);
+	glVertexAttribPointer(TEXCOORD_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, sizeof(RenderVertex), (void *)offsetof(RenderVertex, texCoord));
+	glEnableVertexAttribArray(COLOR_ATTRIBUTE);
+	glVertexAttribPointer(COLOR_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof(RenderVertex), (void *)offsetof(RenderVertex, color));
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	glEnableVertexAttribArray(INSTANCE_ATTRIBUTE);
+	glVertexAttribDivisor(INSTANCE_ATTRIBUTE, 1);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//wide lines are an error in forward compatible contexts, otherwise the driver
+	//tells which widths it can draw
+	GLint flags = 0;
+	glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+	GLfloat lineWidths[2] = { 1.0f, 1.0f };
+	if (!(flags & GL_CONTEXT_FLAG_FORWARD_COMPATIBLE_BIT))
+		glGetFloatv(GL_ALIASED_LINE_WIDTH_RANGE, lineWidths);
+	m_maxLineWidth = std::max(lineWidths[1], 1.0f);
+
+	return glGetError() == GL_NO_ERROR;
+}
+
+std::string CoreRenderer::getName()
+{
+	return "core";
+}
+
+bool CoreRenderer::supportsFormat(TextureFormat format)
+{
+	//RGTC is part of core since 3.0
+	return true;
+}
+
+unsigned int CoreRenderer::createTexture(int width, int height, TextureFormat format, const unsigned char *pixels)
+{
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	if (format == ALPHA)
+	{
+		//there is no alpha format in core profiles, a swizzle gives the same result
+		GLint swizzle[4] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+		glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	else if (format == GRAY_ALPHA || format == RGTC2)
+	{
+		GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+		glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		if (format == RGTC2)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RG_RGTC2, width, height, 0, getRGTC2Size(width, height), pixels);
+		}
+		else
+		{
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, width, height, 0, GL_RG, GL_UNSIGNED_BYTE, pixels);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		}
+	}
+	else
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return texture;
+}
+
+void CoreRenderer::deleteTexture(unsigned int texture)
+{
+	GLuint name = texture;
+	glDeleteTextures(1, &name);
+}
+
+void CoreRenderer::upload(const RenderList &list)
+{
+	const std::vector<RenderVertex> &vertices = list.getVertices();
+	const std::vector<RenderInstance> &instances = list.getInstances();
+
+	//orphan the old storage so the driver does not wait for the previous frame
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(RenderVertex), NULL, GL_STREAM_DRAW);
+	if (!vertices.empty())
+		glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(RenderVertex), &vertices[0]);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(RenderInstance), NULL, GL_STREAM_DRAW);
+	if (!instances.empty())
+		glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(RenderInstance), &instances[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void CoreRenderer::draw(const RenderList &list, const float *projection, const float *view)
+{
+	glDepthFunc(GL_LEQUAL);
+	glClearDepth(1.0f);
+	glClearColor(0.0, 0.0, 0.0, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	const std::vector<RenderCommand> &commands = list.getCommands();
+	if (commands.empty())
+		return;
+
+	float viewProjection[16];
+	multiply(projection, view, viewProjection);
+
+	glUseProgram(m_program);
+	glUniformMatrix4fv(m_viewProjectionLocation, 1, GL_FALSE, viewProjection);
+	glBindVertexArray(m_vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	glActiveTexture(GL_TEXTURE0);
+
+	int matrix = -1;
+	for (std::vector<RenderCommand>::const_iterator it = commands.begin(); it != commands.end(); ++it)
+	{
+		applyState(it->state);
+		if (it->matrix != matrix)
+		{
+			matrix = it->matrix;
+			glUniformMatrix4fv(m_modelLocation, 1, GL_FALSE, list.getMatrix(matrix));
+		}
+
+		//without base instance support the instance range is selected through the pointer
+		glVertexAttribPointer(INSTANCE_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, sizeof(RenderInstance), (void *)(it->instanceFirst * sizeof(RenderInstance)));
+		glDrawArraysInstanced(primitives[it->primitive], it->first, it->count, it->instanceCount);
+	}
+
+	RenderState reset = { 0, RenderList::BLEND_NONE, false, 1.0f, 1.0f };
+	applyState(reset);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
+}
+
+void CoreRenderer::applyState(const RenderState &state)
+{
+	glBindTexture(GL_TEXTURE_2D, state.texture);
+	glUniform1i(m_texturedLocation, state.texture != 0);
+
+	if (state.blend == RenderList::BLEND_NONE)
+	{
+		glDisable(GL_BLEND);
+	}
+	else
+	{
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, (state.blend == RenderList::BLEND_ALPHA) ? GL_ONE_MINUS_SRC_ALPHA : GL_DST_ALPHA);
+	}
+
+	if (state.depthTest)
+	{
+		glEnable(GL_DEPTH_TEST);
+	}
+	else
+	{
+		glDisable(GL_DEPTH_TEST);
+	}
+
+	glLineWidth(std::min(std::max(state.lineWidth, 1.0f), m_maxLineWidth));
+	glPointSize(state.pointSize);
+}
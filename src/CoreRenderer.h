@@ -0,0 +1,36 @@
+#ifndef CORERENDERER_H
+#define CORERENDERER_H
+
+#include "Renderer.h"
+
+//OpenGL 3.3 core backend. The whole list is streamed into one vertex buffer per frame
+//and drawn with a single shader program, offset and alpha come from a per instance
+//attribute so instanced and single draws share the same path.
+class CoreRenderer : public Renderer {
+public:
+	CoreRenderer();
+	virtual ~CoreRenderer();
+
+	bool init();
+
+	virtual std::string getName();
+	virtual bool supportsFormat(TextureFormat format);
+	virtual unsigned int createTexture(int width, int height, TextureFormat format, const unsigned char *pixels);
+	virtual void deleteTexture(unsigned int texture);
+	virtual void upload(const RenderList &list);
+	virtual void draw(const RenderList &list, const float *projection, const float *view);
+
+private:
+	void applyState(const RenderState &state);
+
+	unsigned int m_program;
+	unsigned int m_vertexArray;
+	unsigned int m_vertexBuffer;
+	unsigned int m_instanceBuffer;
+	int m_viewProjectionLocation;
+	int m_modelLocation;
+	int m_texturedLocation;
+	float m_maxLineWidth;
+};
+
+#endif //CORERENDERER_H
@@ -0,0 +1,132 @@
+#ifdef _MSC_VER
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "DataRoot.h"
+#include "ArchiveRoot.h"
+
+#ifdef _MSC_VER
+	#define slash "\\"
+#else
+	#define slash "/"
+#endif
+
+std::vector<std::string> ReadSubDirectories(const std::string &refcstrRootDirectory)
+{
+	std::vector<std::string> subdirectories;
+
+#ifdef _MSC_VER
+	// subdirectories have been found
+	HANDLE          hFile;                       // Handle to directory
+	std::string     strFilePath;                 // Filepath
+	std::string     strPattern;                  // Pattern
+	WIN32_FIND_DATA FileInformation;             // File information
+
+
+	strPattern = refcstrRootDirectory + slash + "*.*";
+	hFile = ::FindFirstFile(strPattern.c_str(), &FileInformation);
+	if (hFile != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if (FileInformation.cFileName[0] != '.')
+			{
+				strFilePath.erase();
+				strFilePath = refcstrRootDirectory + slash + FileInformation.cFileName;
+
+				if (FileInformation.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+				{
+					// Delete subdirectory
+					subdirectories.push_back(FileInformation.cFileName);
+				}
+			}
+		} while (::FindNextFile(hFile, &FileInformation) == TRUE);
+
+		// Close handle
+		::FindClose(hFile);
+	}
+#else
+	DIR *dir;
+	struct dirent *entry;
+
+	dir = opendir(refcstrRootDirectory.c_str());
+	if (dir == NULL) {
+		return subdirectories;
+	}
+
+	while ((entry = readdir(dir)) != NULL) {
+		if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..")) {
+			if (entry->d_type == DT_DIR) {
+				subdirectories.push_back(std::string(entry->d_name));
+			}
+		}
+	}
+	closedir(dir);
+
+#endif
+	std::sort(subdirectories.begin(), subdirectories.end());
+	return subdirectories;
+}
+
+DataRoot * DataRoot::open(const std::string &path, BufferPool &pool)
+{
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0)
+		return NULL;
+	if (info.st_mode & S_IFDIR)
+		return new DirectoryRoot(path, pool);
+
+	ArchiveRoot *archive = new ArchiveRoot(pool);
+	if (archive->open(path))
+		return archive;
+	delete archive;
+	return NULL;
+}
+
+DirectoryRoot::DirectoryRoot(const std::string &path, BufferPool &pool) : m_path(path), m_reader(pool)
+{
+
+}
+
+std::string DirectoryRoot::getName()
+{
+	return m_reader.getName();
+}
+
+std::vector<std::string> DirectoryRoot::getSubDirectories()
+{
+	return ReadSubDirectories(m_path);
+}
+
+bool DirectoryRoot::getInfo(const std::string &path, long long &size, long long &time)
+{
+	struct stat info;
+	if (stat((m_path + slash + path).c_str(), &info) != 0)
+		return false;
+
+	size = info.st_size;
+	time = info.st_mtime;
+	return true;
+}
+
+void DirectoryRoot::read(std::vector<FileRead> &files)
+{
+	for (std::vector<FileRead>::iterator it = files.begin(); it != files.end(); ++it)
+		it->filename = m_path + slash + it->filename;
+	m_reader.read(files);
+	for (std::vector<FileRead>::iterator it = files.begin(); it != files.end(); ++it)
+		it->filename.erase(0, m_path.size() + strlen(slash));
+}
+
+std::string DirectoryRoot::getWritablePath(const std::string &path)
+{
+	return m_path + slash + path;
+}
@@ -0,0 +1,47 @@
+#ifndef DATAROOT_H
+#define DATAROOT_H
+
+#include <string>
+#include <vector>
+
+#include "BufferPool.h"
+#include "BatchReader.h"
+
+std::vector<std::string> ReadSubDirectories(const std::string &refcstrRootDirectory);
+
+//Where the frames of a cruise are read from, either a directory or an archive of it.
+//Paths are relative to the root and use '/' as separator.
+class DataRoot {
+public:
+	virtual ~DataRoot(){}
+
+	//a directory, a tar, tar.gz or zip archive, NULL if path is none of them
+	static DataRoot * open(const std::string &path, BufferPool &pool);
+
+	virtual std::string getName() = 0;
+	//the frame folders, sorted by name
+	virtual std::vector<std::string> getSubDirectories() = 0;
+	//size and modification time of a file without reading it
+	virtual bool getInfo(const std::string &path, long long &size, long long &time) = 0;
+	//reads the files as one batch, the data is taken from the pool
+	virtual void read(std::vector<FileRead> &files) = 0;
+	//the file system path to write a file next to the data, empty if the root is read only
+	virtual std::string getWritablePath(const std::string &path) = 0;
+};
+
+class DirectoryRoot : public DataRoot {
+public:
+	DirectoryRoot(const std::string &path, BufferPool &pool);
+
+	virtual std::string getName();
+	virtual std::vector<std::string> getSubDirectories();
+	virtual bool getInfo(const std::string &path, long long &size, long long &time);
+	virtual void read(std::vector<FileRead> &files);
+	virtual std::string getWritablePath(const std::string &path);
+
+private:
+	std::string m_path;
+	BatchReader m_reader;
+};
+
+#endif //DATAROOT_H
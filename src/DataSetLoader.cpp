@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "DataSetLoader.h"
+#include "PngDecoder.h"
+#include "ReportParser.h"
+
+#define REPORTNAME "reportRaw_refined.xml"
+
+//compressed ROIs are cached next to the image with this extension
+#define CACHE_EXTENSION ".rgtc"
+#define CACHE_MAGIC 0x33435448
+//images whose decoded gray values differ more than this are kept uncompressed
+#define RGTC_MAX_RMSE 4.0
+
+struct CacheHeader {
+	unsigned int magic;
+	unsigned int compressed;
+	int width;
+	int height;
+	int cropX;
+	int cropY;
+	int sourceWidth;
+	int sourceHeight;
+	long long sourceSize;
+	long long sourceTime;
+};
+
+static int getTextureSize(const HologramTexture &texture)
+{
+	return texture.compressed ? getRGTC2Size(texture.width, texture.height) : 2 * texture.width * texture.height;
+}
+
+//moves the quad edges onto the cropped part of the image, the first image row is the top
+static void cropQuad(hologram &q, const HologramTexture &texture)
+{
+	//the image could not be read or decoded, like a fully transparent one the quad
+	//collapses to its center instead of drawing as an untextured rectangle
+	if (texture.sourceWidth == 0 || texture.sourceHeight == 0)
+	{
+		q.halfExtent[0] = 0;
+		q.halfExtent[1] = 0;
+		return;
+	}
+
+	float xmin = q.xmin(), ymax = q.ymax();
+	float pixelWidth = 2 * q.halfExtent[0] / texture.sourceWidth;
+	float pixelHeight = 2 * q.halfExtent[1] / texture.sourceHeight;
+	q.halfExtent[0] = texture.width * pixelWidth / 2;
+	q.halfExtent[1] = texture.height * pixelHeight / 2;
+	q.center[0] = xmin + texture.cropX * pixelWidth + q.halfExtent[0];
+	q.center[1] = ymax - texture.cropY * pixelHeight - q.halfExtent[1];
+}
+
+static void computeBounds(DataSet &set)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		set.boundsMin[k] = 10000000;
+		set.boundsMax[k] = -10000000;
+	}
+	for (std::vector<hologram>::const_iterator it = set.quads.begin(); it != set.quads.end(); ++it)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			float vertex[3];
+			it->getVertex(j, vertex);
+			for (int k = 0; k < 3; k++)
+			{
+				set.boundsMin[k] = std::min(set.boundsMin[k], vertex[k]);
+				set.boundsMax[k] = std::max(set.boundsMax[k], vertex[k]);
+			}
+		}
+	}
+}
+
+DataSetLoader::DataSetLoader(double minZ, std::vector<HologramTexture> &textures, BufferPool &pool, DataRoot &root) : m_minZ(minZ), m_textures(textures), m_pool(pool), m_root(root), m_images(0), m_cached(0), m_uncompressed(0), m_sourcePixels(0), m_croppedPixels(0), m_cacheWritable(true)
+{
+	m_error.sumSquared = 0;
+	m_error.pixels = 0;
+	m_error.maxGray = 0;
+	m_error.maxAlpha = 0;
+
+	//textures loaded before are not known to be cached
+	TextureLocation none = { "", 0 };
+	m_locations.assign(m_textures.size(), none);
+}
+
+DataSetLoader::~DataSetLoader()
+{
+
+}
+
+std::string getReportPath(const std::string &folder)
+{
+	return folder + "/" + REPORTNAME;
+}
+
+std::string getCTDPath(const std::string &folder)
+{
+	return folder + "/data/" + folder.substr(0, folder.rfind(".")) + ".txt";
+}
+
+void DataSetLoader::loadDataSet(const std::string &folder, int id, DataSet &set)
+{
+	set.id = id;
+	set.filename = folder;
+
+	//the report and the CTD values of the frame
+	std::vector<FileRead> files(2);
+	files[0].filename = getReportPath(folder);
+	files[1].filename = getCTDPath(folder);
+	m_root.read(files);
+
+	std::vector<std::string> images;
+	if (files[0].ok && !files[0].data.empty() && parseReport((const char *)&files[0].data[0], files[0].data.size(), m_minZ, set, images))
+	{
+		if (files[1].ok && !files[1].data.empty())
+			parseCTD((const char *)&files[1].data[0], files[1].data.size(), set);
+
+		for (std::vector<std::string>::iterator it = images.begin(); it != images.end(); ++it)
+			*it = folder + "/" + *it;
+		loadTextures(images, set);
+		set.values[0] = std::to_string(set.quads.size());
+	}
+	m_pool.release(files[0].data);
+	m_pool.release(files[1].data);
+	computeBounds(set);
+}
+
+//the images of the last images.size() quads of set. All cache files of the frame are
+//read as one batch, then the images without a valid cache as a second one.
+void DataSetLoader::loadTextures(const std::vector<std::string> &images, DataSet &set)
+{
+	std::vector<HologramTexture> textures(images.size());
+	std::vector<FileRead> caches(images.size());
+	for (int i = 0; i < images.size(); i++)
+		caches[i].filename = images[i] + CACHE_EXTENSION;
+	m_root.read(caches);
+
+	//the caches the textures can be read from later, only for roots on the file system
+	std::vector<std::string> cacheNames(images.size());
+	bool writable = !m_root.getWritablePath(REPORTNAME).empty();
+
+	std::vector<FileRead> files;
+	std::vector<int> fileTextures;
+	for (int i = 0; i < images.size(); i++)
+	{
+		m_images++;
+		if (caches[i].ok && readCache(images[i], caches[i], textures[i]))
+		{
+			m_cached++;
+			if (writable)
+				cacheNames[i] = caches[i].filename;
+		}
+		else
+		{
+			files.push_back(FileRead());
+			files.back().filename = images[i];
+			fileTextures.push_back(i);
+		}
+		m_pool.release(caches[i].data);
+	}
+	m_root.read(files);
+
+	for (int i = 0; i < files.size(); i++)
+	{
+		HologramTexture &texture = textures[fileTextures[i]];
+		if (files[i].ok && keyImage(files[i], texture))
+		{
+			cropTexture(texture);
+			if (!texture.data.empty())
+			{
+				fillTransparentGray(&texture.data[0], texture.width, texture.height);
+				compressTexture(texture);
+			}
+			if (writeCache(files[i], texture))
+				cacheNames[fileTextures[i]] = files[i].filename + CACHE_EXTENSION;
+		}
+		m_pool.release(files[i].data);
+	}
+
+	int first = set.quads.size() - images.size();
+	for (int i = 0; i < images.size(); i++)
+	{
+		m_sourcePixels += (double)textures[i].sourceWidth * textures[i].sourceHeight;
+		m_croppedPixels += (double)textures[i].width * textures[i].height;
+		cropQuad(set.quads[first + i], textures[i]);
+		set.textures.push_back(addTexture(textures[i], cacheNames[i]));
+	}
+}
+
+//pixels where red differs from blue are transparent, blue is the gray value
+bool DataSetLoader::keyImage(const FileRead &file, HologramTexture &texture)
+{
+	texture.cropX = 0;
+	texture.cropY = 0;
+	texture.sourceWidth = 0;
+	texture.sourceHeight = 0;
+	if (file.data.empty())
+		return false;
+
+	if (decodeKeyedPNG(&file.data[0], file.data.size(), texture, m_pool))
+	{
+		texture.sourceWidth = texture.width;
+		texture.sourceHeight = texture.height;
+		return true;
+	}
+
+	cv::Mat image_orig = cv::imdecode(cv::Mat(1, file.data.size(), CV_8UC1, (void *)&file.data[0]), cv::IMREAD_COLOR);
+	texture.width = image_orig.cols;
+	texture.height = image_orig.rows;
+	texture.compressed = false;
+	m_pool.acquire(texture.data, 2 * texture.width * texture.height);
+	texture.sourceWidth = texture.width;
+	texture.sourceHeight = texture.height;
+	if (image_orig.empty())
+		return false;
+
+	for (int i = 0; i < image_orig.rows; i++)
+		keyRow(image_orig.ptr<unsigned char>(i), image_orig.cols, true, &texture.data[2 * i * texture.width]);
+	return true;
+}
+
+//keeps one transparent pixel around the opaque ones, so filtering at the border
+//still fades out like in the uncropped image
+void DataSetLoader::cropTexture(HologramTexture &texture)
+{
+	int xmin = texture.width, xmax = -1;
+	int ymin = texture.height, ymax = -1;
+	for (int y = 0; y < texture.height; y++)
+	{
+		const unsigned char *alpha = &texture.data[2 * y * texture.width + 1];
+		for (int x = 0; x < texture.width; x++, alpha += 2)
+		{
+			if (*alpha == 0)
+				continue;
+			if (x < xmin) xmin = x;
+			if (x > xmax) xmax = x;
+			if (y < ymin) ymin = y;
+			if (y > ymax) ymax = y;
+		}
+	}
+
+	//nothing is visible, the quad collapses to its center
+	if (xmax < 0)
+	{
+		texture.cropX = texture.width / 2;
+		texture.cropY = texture.height / 2;
+		texture.width = 0;
+		texture.height = 0;
+		m_pool.release(texture.data);
+		return;
+	}
+
+	xmin = std::max(xmin - 1, 0);
+	ymin = std::max(ymin - 1, 0);
+	xmax = std::min(xmax + 1, texture.width - 1);
+	ymax = std::min(ymax + 1, texture.height - 1);
+	int width = xmax - xmin + 1;
+	int height = ymax - ymin + 1;
+	if (width == texture.width && height == texture.height)
+		return;
+
+	//rows only move towards the front, so the copy can be done in place
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned char *src = &texture.data[2 * ((y + ymin) * texture.width + xmin)];
+		std::copy(src, src + 2 * width, texture.data.begin() + 2 * y * width);
+	}
+	texture.data.resize(2 * width * height);
+	texture.cropX = xmin;
+	texture.cropY = ymin;
+	texture.width = width;
+	texture.height = height;
+}
+
+void DataSetLoader::compressTexture(HologramTexture &texture)
+{
+	std::vector<unsigned char> blocks, decoded;
+	m_pool.acquire(blocks, getRGTC2Size(texture.width, texture.height));
+	m_pool.acquire(decoded, texture.data.size());
+	encodeRGTC2(&texture.data[0], texture.width, texture.height, blocks);
+
+	//decode again on the CPU, the key must survive unchanged
+	TextureError error = { 0, 0, 0, 0 };
+	decodeRGTC2(&blocks[0], texture.width, texture.height, decoded);
+	compareGrayAlpha(&texture.data[0], &decoded[0], texture.width, texture.height, error);
+	m_pool.release(decoded);
+
+	double rmse = (error.pixels > 0) ? std::sqrt(error.sumSquared / error.pixels) : 0;
+	if (error.maxAlpha > 0 || rmse > RGTC_MAX_RMSE)
+	{
+		m_pool.release(blocks);
+		m_uncompressed++;
+		return;
+	}
+
+	m_error.sumSquared += error.sumSquared;
+	m_error.pixels += error.pixels;
+	m_error.maxGray = std::max(m_error.maxGray, error.maxGray);
+	m_error.maxAlpha = std::max(m_error.maxAlpha, error.maxAlpha);
+
+	texture.compressed = true;
+	texture.data.swap(blocks);
+	m_pool.release(blocks);
+}
+
+int DataSetLoader::addTexture(HologramTexture &texture, const std::string &cache)
+{
+	if (texture.data.empty())
+	{
+		m_pool.release(texture.data);
+		return -1;
+	}
+
+	//the hash only narrows the search, equal hashes are compared byte by byte
+	unsigned long long hash = hashTexture(texture);
+	std::pair<std::multimap<unsigned long long, int>::iterator, std::multimap<unsigned long long, int>::iterator> range = m_textureHashes.equal_range(hash);
+	for (std::multimap<unsigned long long, int>::iterator it = range.first; it != range.second; ++it)
+	{
+		if (sameTexture(m_textures[it->second], texture))
+		{
+			m_pool.release(texture.data);
+			return it->second;
+		}
+	}
+
+	m_textures.push_back(HologramTexture());
+	m_textures.back().width = texture.width;
+	m_textures.back().height = texture.height;
+	m_textures.back().compressed = texture.compressed;
+	m_textures.back().data.swap(texture.data);
+	m_textureHashes.insert(std::make_pair(hash, (int)m_textures.size() - 1));
+
+	TextureLocation location;
+	location.filename = cache;
+	location.offset = sizeof(CacheHeader);
+	m_locations.push_back(location);
+	return m_textures.size() - 1;
+}
+
+//the cache is only valid while the image keeps its size and modification time
+bool DataSetLoader::readCache(const std::string &filename, const FileRead &cache, HologramTexture &texture)
+{
+	CacheHeader header;
+	long long sourceSize, sourceTime;
+	if (cache.data.size() < sizeof(header) || !m_root.getInfo(filename, sourceSize, sourceTime))
+		return false;
+
+	memcpy(&header, &cache.data[0], sizeof(header));
+	if (header.magic != CACHE_MAGIC || header.sourceSize != sourceSize || header.sourceTime != sourceTime)
+		return false;
+
+	texture.width = header.width;
+	texture.height = header.height;
+	texture.compressed = header.compressed != 0;
+	texture.cropX = header.cropX;
+	texture.cropY = header.cropY;
+	texture.sourceWidth = header.sourceWidth;
+	texture.sourceHeight = header.sourceHeight;
+	if (cache.data.size() != sizeof(header) + getTextureSize(texture))
+		return false;
+
+	m_pool.acquire(texture.data, getTextureSize(texture));
+	if (!texture.data.empty())
+		memcpy(&texture.data[0], &cache.data[sizeof(header)], texture.data.size());
+	return true;
+}
+
+bool DataSetLoader::writeCache(const FileRead &image, const HologramTexture &texture)
+{
+	CacheHeader header;
+	header.magic = CACHE_MAGIC;
+	header.compressed = texture.compressed;
+	header.width = texture.width;
+	header.height = texture.height;
+	header.cropX = texture.cropX;
+	header.cropY = texture.cropY;
+	header.sourceWidth = texture.sourceWidth;
+	header.sourceHeight = texture.sourceHeight;
+	header.sourceSize = image.size;
+	header.sourceTime = image.time;
+	std::string path = m_root.getWritablePath(image.filename + CACHE_EXTENSION);
+	if (!m_cacheWritable || path.empty())
+		return false;
+
+	std::ofstream fout(path, std::ios::binary);
+	if (fout.good())
+	{
+		fout.write((const char *)&header, sizeof(header));
+		if (!texture.data.empty())
+			fout.write((const char *)&texture.data[0], texture.data.size());
+	}
+	if (!fout.good())
+	{
+		//read only datasets are still loaded, just without the cache
+		std::cerr << "Could not write the texture cache next to " << image.filename << std::endl;
+		m_cacheWritable = false;
+		return false;
+	}
+	return true;
+}
+
+const std::vector<TextureLocation> & DataSetLoader::getTextureLocations()
+{
+	return m_locations;
+}
+
+void DataSetLoader::printStatistics()
+{
+	double rmse = (m_error.pixels > 0) ? std::sqrt(m_error.sumSquared / m_error.pixels) : 0;
+	std::cerr << "Loaded " << m_images << " images with " << m_root.getName() << ", " << m_cached << " from the cache, "
+		<< m_uncompressed << " kept uncompressed" << std::endl;
+	if (m_images > 0)
+	{
+		std::cerr << m_images << " ROIs share " << m_textures.size() << " textures, dedup ratio "
+			<< (m_textures.empty() ? 0.0 : (double)m_images / m_textures.size()) << std::endl;
+	}
+	if (m_sourcePixels > 0)
+		std::cerr << "Cropping to the opaque pixels kept " << 100.0 * m_croppedPixels / m_sourcePixels << "% of the pixels" << std::endl;
+	if (m_images > m_cached)
+	{
+		std::cerr << "RGTC2 decode check: gray RMSE " << rmse << ", max gray error " << m_error.maxGray
+			<< ", max alpha error " << m_error.maxAlpha << std::endl;
+	}
+}
@@ -0,0 +1,80 @@
+#ifndef DATASETLOADER_H
+#define DATASETLOADER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Hologram.h"
+#include "TextureCodec.h"
+#include "BufferPool.h"
+#include "DataRoot.h"
+
+#define SCALE 200.0
+#define Z_SCALE 1.0 //10
+
+struct DataSet
+{
+	std::vector <hologram> quads;
+	//index into the shared textures of the loader, -1 if the ROI has no visible pixels
+	std::vector <int> textures;
+	//of the corners of all quads
+	float boundsMin[3];
+	float boundsMax[3];
+	std::vector <std::string> value_names;
+	std::vector <std::string> values;
+	int id;
+	std::string filename;
+};
+
+//where the pixels of a shared texture are kept on disk: in the texture cache of the
+//first ROI it was loaded for, relative to the root. The filename is empty if there is
+//no cache, e.g. for archives.
+struct TextureLocation {
+	std::string filename;
+	unsigned long long offset;
+};
+
+//the report and the CTD values of a frame folder, relative to the root
+std::string getReportPath(const std::string &folder);
+std::string getCTDPath(const std::string &folder);
+
+//Reads the frames of a cruise from root. ROI images are keyed, cropped to their opaque
+//pixels and RGTC2 compressed once, the result is stored in a cache file next to the image
+//which later runs read instead, unless root is an archive. Identical ROIs, e.g. static particles seen in several
+//frames, share one entry of textures. All pixel buffers are taken from pool.
+class DataSetLoader {
+public:
+	DataSetLoader(double minZ, std::vector<HologramTexture> &textures, BufferPool &pool, DataRoot &root);
+	~DataSetLoader();
+
+	void loadDataSet(const std::string &folder, int id, DataSet &set);
+	void printStatistics();
+	//one for each of the shared textures
+	const std::vector<TextureLocation> & getTextureLocations();
+
+private:
+	void loadTextures(const std::vector<std::string> &images, DataSet &set);
+	bool keyImage(const FileRead &file, HologramTexture &texture);
+	void cropTexture(HologramTexture &texture);
+	int addTexture(HologramTexture &texture, const std::string &cache);
+	void compressTexture(HologramTexture &texture);
+	bool readCache(const std::string &filename, const FileRead &cache, HologramTexture &texture);
+	bool writeCache(const FileRead &image, const HologramTexture &texture);
+
+	double m_minZ;
+	std::vector<HologramTexture> &m_textures;
+	std::vector<TextureLocation> m_locations;
+	std::multimap<unsigned long long, int> m_textureHashes;
+	BufferPool &m_pool;
+	DataRoot &m_root;
+	int m_images;
+	int m_cached;
+	int m_uncompressed;
+	double m_sourcePixels;
+	double m_croppedPixels;
+	bool m_cacheWritable;
+	TextureError m_error;
+};
+
+#endif //DATASETLOADER_H
@@ -0,0 +1,158 @@
+#include <cstring>
+#include <iostream>
+
+#include "EventLog.h"
+
+#define EVENTLOG_MAGIC "HOLOEVT1"
+//the id of frame markers, names get the ids below it
+#define EVENTLOG_FRAME 0xFFFF
+
+EventLogWriter::EventLogWriter() : m_file(NULL)
+{
+
+}
+
+EventLogWriter::~EventLogWriter()
+{
+	close();
+}
+
+bool EventLogWriter::open(const std::string &filename)
+{
+	close();
+	m_file = fopen(filename.c_str(), "wb");
+	if (m_file == NULL)
+	{
+		std::cerr << "Could not open " << filename << " for recording" << std::endl;
+		return false;
+	}
+	fwrite(EVENTLOG_MAGIC, 1, 8, m_file);
+	return true;
+}
+
+bool EventLogWriter::isOpen()
+{
+	return m_file != NULL;
+}
+
+void EventLogWriter::write(const EventRecord &record)
+{
+	if (m_file == NULL)
+		return;
+
+	unsigned short id = EVENTLOG_FRAME;
+	bool newName = false;
+	if (!record.frame)
+	{
+		std::unordered_map<std::string, int>::const_iterator it = m_ids.find(record.name);
+		if (it == m_ids.end())
+		{
+			if (m_ids.size() >= EVENTLOG_FRAME)
+				return;
+			newName = true;
+			it = m_ids.insert(std::make_pair(record.name, (int)m_ids.size())).first;
+		}
+		id = it->second;
+	}
+
+	fwrite(&id, sizeof(id), 1, m_file);
+	fwrite(&record.time, sizeof(record.time), 1, m_file);
+	if (record.frame)
+		return;
+
+	if (newName)
+	{
+		unsigned short length = record.name.size();
+		fwrite(&length, sizeof(length), 1, m_file);
+		fwrite(record.name.data(), 1, length, m_file);
+	}
+	fwrite(&record.fields, 1, 1, m_file);
+	if (record.fields & EventRecord::POSE)
+		fwrite(record.pose, sizeof(float), 16, m_file);
+	if (record.fields & EventRecord::AXIS1_BUTTON)
+		fwrite(&record.axis1Button, sizeof(int), 1, m_file);
+	if (record.fields & EventRecord::AXIS0_X)
+		fwrite(&record.axis0X, sizeof(float), 1, m_file);
+	if (record.fields & EventRecord::AXIS0_Y)
+		fwrite(&record.axis0Y, sizeof(float), 1, m_file);
+}
+
+void EventLogWriter::close()
+{
+	if (m_file)
+		fclose(m_file);
+	m_file = NULL;
+	m_ids.clear();
+}
+
+EventLogReader::EventLogReader() : m_file(NULL)
+{
+
+}
+
+EventLogReader::~EventLogReader()
+{
+	close();
+}
+
+bool EventLogReader::open(const std::string &filename)
+{
+	close();
+	m_file = fopen(filename.c_str(), "rb");
+	char magic[8];
+	if (m_file == NULL || fread(magic, 1, 8, m_file) != 8 || memcmp(magic, EVENTLOG_MAGIC, 8) != 0)
+	{
+		std::cerr << "Could not read the event log " << filename << std::endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool EventLogReader::read(EventRecord &record)
+{
+	unsigned short id;
+	if (m_file == NULL || fread(&id, sizeof(id), 1, m_file) != 1 || fread(&record.time, sizeof(record.time), 1, m_file) != 1)
+		return false;
+
+	record.frame = id == EVENTLOG_FRAME;
+	record.fields = 0;
+	if (record.frame)
+	{
+		record.name.clear();
+		return true;
+	}
+
+	if (id == m_names.size())
+	{
+		unsigned short length;
+		if (fread(&length, sizeof(length), 1, m_file) != 1)
+			return false;
+		std::string name(length, '\0');
+		if (length > 0 && fread(&name[0], 1, length, m_file) != length)
+			return false;
+		m_names.push_back(name);
+	}
+	if (id >= m_names.size())
+		return false;
+	record.name = m_names[id];
+
+	bool ok = fread(&record.fields, 1, 1, m_file) == 1;
+	if (ok && (record.fields & EventRecord::POSE))
+		ok = fread(record.pose, sizeof(float), 16, m_file) == 16;
+	if (ok && (record.fields & EventRecord::AXIS1_BUTTON))
+		ok = fread(&record.axis1Button, sizeof(int), 1, m_file) == 1;
+	if (ok && (record.fields & EventRecord::AXIS0_X))
+		ok = fread(&record.axis0X, sizeof(float), 1, m_file) == 1;
+	if (ok && (record.fields & EventRecord::AXIS0_Y))
+		ok = fread(&record.axis0Y, sizeof(float), 1, m_file) == 1;
+	return ok;
+}
+
+void EventLogReader::close()
+{
+	if (m_file)
+		fclose(m_file);
+	m_file = NULL;
+	m_names.clear();
+}
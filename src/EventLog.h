@@ -0,0 +1,62 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//An event as the viewer reads it: the pose, trigger and touchpad values of its data
+//index, or a marker where a frame was rendered, so a replay interleaves events and
+//frames exactly like the recorded session.
+struct EventRecord {
+	enum Field {
+		POSE = 1,
+		AXIS1_BUTTON = 2,
+		AXIS0_X = 4,
+		AXIS0_Y = 8
+	};
+
+	double time;
+	bool frame;
+	std::string name;
+	unsigned char fields;
+	float pose[16];
+	int axis1Button;
+	float axis0X;
+	float axis0Y;
+};
+
+//Binary log of event records. Names are written once and referenced by a 16 bit id
+//afterwards, a tracked controller costs 87 bytes per event.
+class EventLogWriter {
+public:
+	EventLogWriter();
+	~EventLogWriter();
+
+	bool open(const std::string &filename);
+	bool isOpen();
+	void write(const EventRecord &record);
+	void close();
+
+private:
+	FILE *m_file;
+	std::unordered_map<std::string, int> m_ids;
+};
+
+class EventLogReader {
+public:
+	EventLogReader();
+	~EventLogReader();
+
+	bool open(const std::string &filename);
+	//false at the end of the log or if it is damaged
+	bool read(EventRecord &record);
+	void close();
+
+private:
+	FILE *m_file;
+	std::vector<std::string> m_names;
+};
+
+#endif //EVENTLOG_H
@@ -0,0 +1,178 @@
+#include <iostream>
+
+#include "FrameExporter.h"
+
+FrameExporter::FrameExporter() : m_sequence(false), m_digits(0), m_padding(' '), m_width(0), m_height(0), m_maxQueue(0), m_added(0), m_written(0), m_running(false)
+{
+
+}
+
+FrameExporter::~FrameExporter()
+{
+	finish();
+}
+
+bool FrameExporter::start(const std::string &filename, int width, int height, double fps, int threads)
+{
+	if (!parsePattern(filename))
+	{
+		std::cerr << "Expected at most one %d in " << filename << std::endl;
+		return false;
+	}
+	m_width = width;
+	m_height = height;
+	m_added = 0;
+	m_written = 0;
+	if (!m_sequence)
+	{
+		std::string extension = (filename.size() > 4) ? filename.substr(filename.size() - 4) : "";
+		int fourcc = (extension == ".mp4") ? cv::VideoWriter::fourcc('m', 'p', '4', 'v') : cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+		if (!m_writer.open(m_filename, fourcc, fps, cv::Size(width, height), true) || !m_writer.isOpened())
+		{
+			std::cerr << "Could not open " << m_filename << " for writing" << std::endl;
+			return false;
+		}
+	}
+
+	if (threads < 1)
+		threads = 1;
+	m_maxQueue = 2 * threads;
+	m_running = true;
+	for (int i = 0; i < threads; i++)
+		m_threads.push_back(std::thread(&FrameExporter::run, this));
+	return true;
+}
+
+void FrameExporter::add(std::vector<unsigned char> &pixels)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_queue.size() >= m_maxQueue)
+		m_condition.wait(lock);
+	m_queue.push_back(Frame());
+	m_queue.back().index = m_added++;
+	std::swap(m_queue.back().pixels, pixels);
+	m_condition.notify_all();
+}
+
+void FrameExporter::finish()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+	}
+	m_condition.notify_all();
+	for (std::vector<std::thread>::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+		it->join();
+	m_threads.clear();
+	m_writer.release();
+}
+
+//the filename is never used as a format string, the frame number is put in by hand
+bool FrameExporter::parsePattern(const std::string &filename)
+{
+	m_filename.clear();
+	m_prefix.clear();
+	m_suffix.clear();
+	m_sequence = false;
+	m_digits = 0;
+	m_padding = ' ';
+	for (size_t i = 0; i < filename.size(); i++)
+	{
+		std::string &text = (m_sequence) ? m_suffix : m_prefix;
+		if (filename[i] != '%')
+		{
+			text += filename[i];
+			continue;
+		}
+		if (++i < filename.size() && filename[i] == '%')
+		{
+			text += '%';
+			continue;
+		}
+		if (m_sequence)
+			return false;
+
+		if (i < filename.size() && filename[i] == '0')
+		{
+			m_padding = '0';
+			i++;
+		}
+		for (; i < filename.size() && filename[i] >= '0' && filename[i] <= '9'; i++)
+		{
+			m_digits = 10 * m_digits + filename[i] - '0';
+			if (m_digits > 64)
+				return false;
+		}
+		if (i >= filename.size() || (filename[i] != 'd' && filename[i] != 'i'))
+			return false;
+		m_sequence = true;
+	}
+	m_filename = (m_sequence) ? filename : m_prefix;
+	return true;
+}
+
+std::string FrameExporter::getFrameName(int index)
+{
+	std::string number = std::to_string(index);
+	if (number.size() < m_digits)
+		number.insert(0, m_digits - number.size(), m_padding);
+	return m_prefix + number + m_suffix;
+}
+
+void FrameExporter::convert(const std::vector<unsigned char> &pixels, cv::Mat &image)
+{
+	//GL rows start at the bottom and are RGBA, OpenCV wants BGR from the top
+	image.create(m_height, m_width, CV_8UC3);
+	for (int y = 0; y < m_height; y++)
+	{
+		const unsigned char *src = &pixels[4 * m_width * (m_height - 1 - y)];
+		unsigned char *dst = image.ptr(y);
+		for (int x = 0; x < m_width; x++, src += 4, dst += 3)
+		{
+			dst[0] = src[2];
+			dst[1] = src[1];
+			dst[2] = src[0];
+		}
+	}
+}
+
+void FrameExporter::run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		while (m_running && m_queue.empty())
+			m_condition.wait(lock);
+		if (m_queue.empty())
+			break;
+
+		Frame frame;
+		std::swap(frame, m_queue.front());
+		m_queue.pop_front();
+		m_condition.notify_all();
+		lock.unlock();
+
+		cv::Mat image;
+		convert(frame.pixels, image);
+		if (m_sequence)
+		{
+			std::string name = getFrameName(frame.index);
+			if (!cv::imwrite(name, image))
+				std::cerr << "Could not write " << name << std::endl;
+		}
+
+		lock.lock();
+		if (!m_sequence)
+		{
+			//the video gets the frames in the order they were rendered, only the
+			//thread with the next frame gets past the wait, so it writes unlocked
+			while (m_written != frame.index)
+				m_condition.wait(lock);
+			lock.unlock();
+			m_writer.write(image);
+			lock.lock();
+		}
+		m_written++;
+		m_condition.notify_all();
+	}
+}
@@ -0,0 +1,61 @@
+#ifndef FRAMEEXPORTER_H
+#define FRAMEEXPORTER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+//Encodes rendered frames on worker threads. A filename with a printf pattern like
+//frames/%05d.png writes one image per frame, the workers encode them in parallel.
+//Only a single %d with an optional zero flag and width is allowed, %% is a percent sign.
+//Any other filename is a video written with cv::VideoWriter, the workers convert
+//the frames in parallel and append them in order.
+class FrameExporter {
+public:
+	FrameExporter();
+	~FrameExporter();
+
+	bool start(const std::string &filename, int width, int height, double fps, int threads);
+	//takes the RGBA rows from the bottom up, waits while too many frames are queued
+	void add(std::vector<unsigned char> &pixels);
+	//waits for the queued frames and closes the output
+	void finish();
+
+private:
+	struct Frame {
+		int index;
+		std::vector<unsigned char> pixels;
+	};
+
+	void run();
+	void convert(const std::vector<unsigned char> &pixels, cv::Mat &image);
+	bool parsePattern(const std::string &filename);
+	std::string getFrameName(int index);
+
+	std::string m_filename;
+	bool m_sequence;
+	//the parts of a sequence pattern around the frame number
+	std::string m_prefix;
+	std::string m_suffix;
+	int m_digits;
+	char m_padding;
+	int m_width;
+	int m_height;
+	cv::VideoWriter m_writer;
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<Frame> m_queue;
+	size_t m_maxQueue;
+	int m_added;
+	int m_written;
+	bool m_running;
+};
+
+#endif //FRAMEEXPORTER_H
@@ -0,0 +1,102 @@
+#include "FrameLoader.h"
+
+FrameLoader::FrameLoader(Manifest &manifest) : m_manifest(manifest), m_reading(false), m_running(false)
+{
+
+}
+
+FrameLoader::~FrameLoader()
+{
+	stop();
+}
+
+void FrameLoader::start()
+{
+	stop();
+	m_running = true;
+	m_thread = std::thread(&FrameLoader::run, this);
+}
+
+void FrameLoader::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+	}
+	m_condition.notify_one();
+	if (m_thread.joinable())
+		m_thread.join();
+
+	m_ready.clear();
+	m_readyFrames.clear();
+	m_requests.clear();
+}
+
+void FrameLoader::request(const std::vector<int> &frames, bool urgent)
+{
+	if (frames.empty())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_requests.insert((urgent) ? m_requests.begin() : m_requests.end(), frames.begin(), frames.end());
+	}
+	m_condition.notify_one();
+}
+
+void FrameLoader::cancel()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_requests.clear();
+}
+
+void FrameLoader::take(std::vector<int> &frames, std::vector<DataSet> &sets, int maxQuads)
+{
+	int taken = 0;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	while (!m_ready.empty() && taken < maxQuads)
+	{
+		frames.push_back(m_readyFrames.front());
+		sets.push_back(DataSet());
+		std::swap(sets.back().quads, m_ready.front().quads);
+		std::swap(sets.back().textures, m_ready.front().textures);
+		taken += sets.back().quads.size();
+		m_readyFrames.pop_front();
+		m_ready.pop_front();
+	}
+}
+
+bool FrameLoader::isIdle()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_requests.empty() && !m_reading && m_ready.empty();
+}
+
+void FrameLoader::run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		while (m_running && m_requests.empty())
+			m_condition.wait(lock);
+		if (!m_running)
+			break;
+
+		int frame = m_requests.front();
+		m_requests.pop_front();
+		m_reading = true;
+		lock.unlock();
+
+		DataSet set;
+		bool ok = m_manifest.readQuads(frame, set);
+
+		lock.lock();
+		m_reading = false;
+		if (ok)
+		{
+			m_readyFrames.push_back(frame);
+			m_ready.push_back(DataSet());
+			std::swap(m_ready.back().quads, set.quads);
+			std::swap(m_ready.back().textures, set.textures);
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef FRAMELOADER_H
+#define FRAMELOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Manifest.h"
+
+//Reads the quads of requested frames from a manifest on its own thread. Urgent
+//requests, the frames a playing movie needs next, are read before the others.
+//The render thread takes what has arrived without waiting.
+class FrameLoader {
+public:
+	FrameLoader(Manifest &manifest);
+	~FrameLoader();
+
+	void start();
+	void stop();
+
+	void request(const std::vector<int> &frames, bool urgent = false);
+	//drops the requests which are not read yet
+	void cancel();
+	//moves read frames out until maxQuads quads are taken
+	void take(std::vector<int> &frames, std::vector<DataSet> &sets, int maxQuads);
+	//nothing is requested or waiting to be taken
+	bool isIdle();
+
+private:
+	void run();
+
+	Manifest &m_manifest;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<int> m_requests;
+	std::deque<int> m_readyFrames;
+	std::deque<DataSet> m_ready;
+	bool m_reading;
+	bool m_running;
+};
+
+#endif //FRAMELOADER_H
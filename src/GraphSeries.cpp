@@ -0,0 +1,54 @@
+#include <limits>
+#include "GraphSeries.h"
+
+void computeSeriesRange(const std::vector<double> &data, double range[2])
+{
+	double min = std::numeric_limits<double>::max();
+	double max = std::numeric_limits<double>::lowest();
+
+	for (std::vector<double>::const_iterator it = data.begin(); it != data.end(); ++it)
+	{
+		if (*it != GRAPHUNDEFINEDVALUE){
+			if (min > *it) min = *it;
+			if (max < *it) max = *it;
+		}
+	}
+	range[0] = min;
+	range[1] = max;
+}
+
+void decimateSeries(const std::vector<double> &data, int maxPoints, std::vector<int> &indices)
+{
+	indices.clear();
+	int n = data.size();
+
+	if (n <= maxPoints)
+	{
+		for (int i = 0; i < n; i++){
+			if (data[i] != GRAPHUNDEFINEDVALUE)
+				indices.push_back(i);
+		}
+		return;
+	}
+
+	//keep the minimum and maximum of each bucket so spikes stay visible
+	int buckets = maxPoints / 2;
+	for (int b = 0; b < buckets; b++){
+		int start = (long long) b * n / buckets;
+		int end = (long long) (b + 1) * n / buckets;
+		int min_i = -1, max_i = -1;
+		for (int i = start; i < end; i++){
+			if (data[i] == GRAPHUNDEFINEDVALUE)
+				continue;
+			if (min_i < 0 || data[i] < data[min_i]) min_i = i;
+			if (max_i < 0 || data[i] > data[max_i]) max_i = i;
+		}
+		if (min_i < 0)
+			continue;
+		int first = (min_i < max_i) ? min_i : max_i;
+		int second = (min_i < max_i) ? max_i : min_i;
+		indices.push_back(first);
+		if (second != first)
+			indices.push_back(second);
+	}
+}
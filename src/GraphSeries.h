@@ -0,0 +1,16 @@
+#ifndef GRAPHSERIES_H
+#define GRAPHSERIES_H
+
+#include <vector>
+
+#define GRAPHUNDEFINEDVALUE -999999999
+
+//min and max of the defined values of a series
+void computeSeriesRange(const std::vector<double> &data, double range[2]);
+
+//indices of the values of a series which are drawn: all defined ones, or for series
+//longer than maxPoints the minimum and maximum of each of maxPoints / 2 buckets, so
+//spikes stay visible
+void decimateSeries(const std::vector<double> &data, int maxPoints, std::vector<int> &indices);
+
+#endif //GRAPHSERIES_H
@@ -0,0 +1,25 @@
+#include <vector>
+#include "Hologram.h"
+
+static std::vector<std::string> & getHologramTypes()
+{
+	static std::vector<std::string> types;
+	return types;
+}
+
+unsigned short internHologramType(const std::string &type)
+{
+	std::vector<std::string> &types = getHologramTypes();
+	for (int i = 0; i < types.size(); i++)
+	{
+		if (types[i] == type)
+			return i;
+	}
+	types.push_back(type);
+	return types.size() - 1;
+}
+
+const std::string & getHologramTypeName(unsigned short type)
+{
+	return getHologramTypes()[type];
+}
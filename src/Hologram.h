@@ -0,0 +1,36 @@
+#ifndef HOLOGRAM_H
+#define HOLOGRAM_H
+
+#include <string>
+
+//Compact record of one particle. The quads are axis aligned, so they are stored as
+//center and half extents and the corners are derived when drawing or picking. The
+//frame of a quad is the DataSet holding it, so it isn't repeated here.
+//Corners are numbered like the texture coordinates of the quad:
+//0 = (xmin, ymin), 1 = (xmax, ymin), 2 = (xmax, ymax), 3 = (xmin, ymax).
+struct hologram {
+	float center[3];
+	float halfExtent[2];
+	float esd;
+	float esv;
+	int ID;
+	unsigned short type;
+
+	float xmin() const { return center[0] - halfExtent[0]; }
+	float xmax() const { return center[0] + halfExtent[0]; }
+	float ymin() const { return center[1] - halfExtent[1]; }
+	float ymax() const { return center[1] + halfExtent[1]; }
+
+	void getVertex(int corner, float vertex[3]) const
+	{
+		vertex[0] = (corner == 0 || corner == 3) ? xmin() : xmax();
+		vertex[1] = (corner < 2) ? ymin() : ymax();
+		vertex[2] = center[2];
+	}
+};
+
+//Particle types are interned, a hologram only stores the id of its type name.
+unsigned short internHologramType(const std::string &type);
+const std::string & getHologramTypeName(unsigned short type);
+
+#endif //HOLOGRAM_H
@@ -0,0 +1,247 @@
+#include <limits>
+#include "HologramPicker.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PICK_SSE
+#endif
+
+HologramSnapshot::HologramSnapshot()
+{
+
+}
+
+HologramSnapshot::~HologramSnapshot()
+{
+
+}
+
+std::shared_ptr<const PickFrame> HologramSnapshot::createFrame(int setID, const std::vector<PickQuad> &quads)
+{
+	std::shared_ptr<PickFrame> frame(new PickFrame());
+	frame->setID = setID;
+	frame->count = quads.size();
+
+	int padded = (quads.size() + PICK_BLOCK - 1) / PICK_BLOCK * PICK_BLOCK;
+	//empty rectangles (min > max) never contain a point
+	frame->xmin.resize(padded, std::numeric_limits<float>::max());
+	frame->xmax.resize(padded, -std::numeric_limits<float>::max());
+	frame->ymin.resize(padded, std::numeric_limits<float>::max());
+	frame->ymax.resize(padded, -std::numeric_limits<float>::max());
+	frame->z.resize(padded, 0.0f);
+
+	for (int i = 0; i < quads.size(); i++)
+	{
+		frame->xmin[i] = quads[i].xmin;
+		frame->xmax[i] = quads[i].xmax;
+		frame->ymin[i] = quads[i].ymin;
+		frame->ymax[i] = quads[i].ymax;
+		frame->z[i] = quads[i].z;
+	}
+	return frame;
+}
+
+void HologramSnapshot::addFrame(int setID, const std::vector<PickQuad> &quads)
+{
+	m_frames.push_back(createFrame(setID, quads));
+}
+
+void HologramSnapshot::addFrame(const std::shared_ptr<const PickFrame> &frame)
+{
+	m_frames.push_back(frame);
+}
+
+int HologramSnapshot::getFrameCount() const
+{
+	return m_frames.size();
+}
+
+const PickFrame & HologramSnapshot::getFrame(int frame) const
+{
+	return *m_frames[frame];
+}
+
+static void clampRange(const HologramSnapshot &snapshot, int &start, int &end)
+{
+	if (start < 0)
+		start = 0;
+	if (end > snapshot.getFrameCount() - 1)
+		end = snapshot.getFrameCount() - 1;
+}
+
+static void setHit(PickHit &hit, int frame, int quad, double d, const float pos[3], const float dir[3])
+{
+	hit.frame = frame;
+	hit.quad = quad;
+	hit.distance = d;
+	hit.point[0] = pos[0] + dir[0] * d;
+	hit.point[1] = pos[1] + dir[1] * d;
+	hit.point[2] = pos[2] + dir[2] * d;
+}
+
+template <class Mode>
+bool pickHologramScalar(const HologramSnapshot &snapshot, const float pos[3], const float dir[3], int start, int end,
+	double zSpacing, double maxDistance, PickHit &hit)
+{
+	clampRange(snapshot, start, end);
+
+	double distance = maxDistance;
+	bool found = false;
+
+	for (int i = start; i <= end; i++){
+		const PickFrame &frame = snapshot.getFrame(i);
+		double offset = -Mode::zOffset(frame.setID, zSpacing);
+		for (int j = 0; j < frame.count; j++){
+			double d = (frame.z[j] - offset - pos[2]) / dir[2];
+
+			if (d > 0 && d < distance){
+				double x = pos[0] + dir[0] * d;
+				double y = pos[1] + dir[1] * d;
+				if (x >= frame.xmin[j]
+					&& y >= frame.ymin[j]
+					&& x <= frame.xmax[j]
+					&& y <= frame.ymax[j])
+				{
+					distance = d;
+					setHit(hit, i, j, d, pos, dir);
+					found = true;
+				}
+			}
+		}
+	}
+	return found;
+}
+
+#if defined(__AVX__)
+
+template <class Mode>
+bool pickHologram(const HologramSnapshot &snapshot, const float pos[3], const float dir[3], int start, int end,
+	double zSpacing, double maxDistance, PickHit &hit)
+{
+	clampRange(snapshot, start, end);
+
+	float distance = maxDistance;
+	int hit_frame = -1, hit_quad = -1;
+	__m256 px = _mm256_set1_ps(pos[0]);
+	__m256 py = _mm256_set1_ps(pos[1]);
+	__m256 dx = _mm256_set1_ps(dir[0]);
+	__m256 dy = _mm256_set1_ps(dir[1]);
+	__m256 inv_dz = _mm256_set1_ps(1.0f / dir[2]);
+	__m256 zero = _mm256_setzero_ps();
+	__m256 inf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+
+	for (int i = start; i <= end; i++){
+		const PickFrame &frame = snapshot.getFrame(i);
+		__m256 pz = _mm256_set1_ps(pos[2] - Mode::zOffset(frame.setID, zSpacing));
+		for (int j = 0; j < frame.xmin.size(); j += PICK_BLOCK){
+			__m256 d = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&frame.z[j]), pz), inv_dz);
+			__m256 x = _mm256_add_ps(px, _mm256_mul_ps(dx, d));
+			__m256 y = _mm256_add_ps(py, _mm256_mul_ps(dy, d));
+
+			__m256 mask = _mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_GT_OQ), _mm256_cmp_ps(d, _mm256_set1_ps(distance), _CMP_LT_OQ));
+			mask = _mm256_and_ps(mask, _mm256_cmp_ps(x, _mm256_loadu_ps(&frame.xmin[j]), _CMP_GE_OQ));
+			mask = _mm256_and_ps(mask, _mm256_cmp_ps(y, _mm256_loadu_ps(&frame.ymin[j]), _CMP_GE_OQ));
+			mask = _mm256_and_ps(mask, _mm256_cmp_ps(x, _mm256_loadu_ps(&frame.xmax[j]), _CMP_LE_OQ));
+			mask = _mm256_and_ps(mask, _mm256_cmp_ps(y, _mm256_loadu_ps(&frame.ymax[j]), _CMP_LE_OQ));
+			if (_mm256_movemask_ps(mask) == 0)
+				continue;
+
+			//min-reduction over the lanes which hit
+			__m256 hits = _mm256_blendv_ps(inf, d, mask);
+			__m256 m = _mm256_min_ps(hits, _mm256_permute2f128_ps(hits, hits, 1));
+			m = _mm256_min_ps(m, _mm256_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+			m = _mm256_min_ps(m, _mm256_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+			int lanes = _mm256_movemask_ps(_mm256_cmp_ps(hits, m, _CMP_EQ_OQ));
+
+			int lane = 0;
+			while (!(lanes & (1 << lane)))
+				lane++;
+			distance = _mm256_cvtss_f32(m);
+			hit_frame = i;
+			hit_quad = j + lane;
+		}
+	}
+
+	if (hit_frame < 0)
+		return false;
+
+	setHit(hit, hit_frame, hit_quad, distance, pos, dir);
+	return true;
+}
+
+#elif defined(PICK_SSE)
+
+template <class Mode>
+bool pickHologram(const HologramSnapshot &snapshot, const float pos[3], const float dir[3], int start, int end,
+	double zSpacing, double maxDistance, PickHit &hit)
+{
+	clampRange(snapshot, start, end);
+
+	float distance = maxDistance;
+	int hit_frame = -1, hit_quad = -1;
+	__m128 px = _mm_set1_ps(pos[0]);
+	__m128 py = _mm_set1_ps(pos[1]);
+	__m128 dx = _mm_set1_ps(dir[0]);
+	__m128 dy = _mm_set1_ps(dir[1]);
+	__m128 inv_dz = _mm_set1_ps(1.0f / dir[2]);
+	__m128 zero = _mm_setzero_ps();
+	__m128 inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+
+	for (int i = start; i <= end; i++){
+		const PickFrame &frame = snapshot.getFrame(i);
+		__m128 pz = _mm_set1_ps(pos[2] - Mode::zOffset(frame.setID, zSpacing));
+		//a block is two SSE vectors
+		for (int j = 0; j < frame.xmin.size(); j += 4){
+			__m128 d = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&frame.z[j]), pz), inv_dz);
+			__m128 x = _mm_add_ps(px, _mm_mul_ps(dx, d));
+			__m128 y = _mm_add_ps(py, _mm_mul_ps(dy, d));
+
+			__m128 mask = _mm_and_ps(_mm_cmpgt_ps(d, zero), _mm_cmplt_ps(d, _mm_set1_ps(distance)));
+			mask = _mm_and_ps(mask, _mm_cmpge_ps(x, _mm_loadu_ps(&frame.xmin[j])));
+			mask = _mm_and_ps(mask, _mm_cmpge_ps(y, _mm_loadu_ps(&frame.ymin[j])));
+			mask = _mm_and_ps(mask, _mm_cmple_ps(x, _mm_loadu_ps(&frame.xmax[j])));
+			mask = _mm_and_ps(mask, _mm_cmple_ps(y, _mm_loadu_ps(&frame.ymax[j])));
+			if (_mm_movemask_ps(mask) == 0)
+				continue;
+
+			//min-reduction over the lanes which hit
+			__m128 hits = _mm_or_ps(_mm_and_ps(mask, d), _mm_andnot_ps(mask, inf));
+			__m128 m = _mm_min_ps(hits, _mm_shuffle_ps(hits, hits, _MM_SHUFFLE(1, 0, 3, 2)));
+			m = _mm_min_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+			int lanes = _mm_movemask_ps(_mm_cmpeq_ps(hits, m));
+
+			int lane = 0;
+			while (!(lanes & (1 << lane)))
+				lane++;
+			distance = _mm_cvtss_f32(m);
+			hit_frame = i;
+			hit_quad = j + lane;
+		}
+	}
+
+	if (hit_frame < 0)
+		return false;
+
+	setHit(hit, hit_frame, hit_quad, distance, pos, dir);
+	return true;
+}
+
+#else
+
+template <class Mode>
+bool pickHologram(const HologramSnapshot &snapshot, const float pos[3], const float dir[3], int start, int end,
+	double zSpacing, double maxDistance, PickHit &hit)
+{
+	return pickHologramScalar<Mode>(snapshot, pos, dir, start, end, zSpacing, maxDistance, hit);
+}
+
+#endif
+
+template bool pickHologram<StackMode>(const HologramSnapshot &, const float[3], const float[3], int, int, double, double, PickHit &);
+template bool pickHologram<OverlayMode>(const HologramSnapshot &, const float[3], const float[3], int, int, double, double, PickHit &);
+template bool pickHologram<MovieMode>(const HologramSnapshot &, const float[3], const float[3], int, int, double, double, PickHit &);
+template bool pickHologramScalar<StackMode>(const HologramSnapshot &, const float[3], const float[3], int, int, double, double, PickHit &);
+template bool pickHologramScalar<OverlayMode>(const HologramSnapshot &, const float[3], const float[3], int, int, double, double, PickHit &);
+template bool pickHologramScalar<MovieMode>(const HologramSnapshot &, const float[3], const float[3], int, int, double, double, PickHit &);
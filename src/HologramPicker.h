@@ -0,0 +1,70 @@
+#ifndef HOLOGRAMPICKER_H
+#define HOLOGRAMPICKER_H
+
+#include <memory>
+#include <vector>
+#include "ViewMode.h"
+
+//Bounds of a hologram quad as seen by the picker. Quads are axis aligned,
+//so a ray hits one if its intersection with the plane z lies inside the rectangle.
+struct PickQuad {
+	float xmin, xmax;
+	float ymin, ymax;
+	float z;
+};
+
+//Quad bounds of one frame stored as structure of arrays. The arrays are padded
+//to a multiple of PICK_BLOCK with empty rectangles so the kernel has no tail loop.
+#define PICK_BLOCK 8
+
+struct PickFrame {
+	int setID;
+	int count;
+	std::vector<float> xmin, xmax;
+	std::vector<float> ymin, ymax;
+	std::vector<float> z;
+};
+
+//Immutable copy of the hologram geometry which can be shared with the picking thread.
+//Frames are shared between snapshots, so a new snapshot only has to build the frames
+//which changed.
+class HologramSnapshot {
+public:
+	HologramSnapshot();
+	~HologramSnapshot();
+
+	static std::shared_ptr<const PickFrame> createFrame(int setID, const std::vector<PickQuad> &quads);
+
+	void addFrame(int setID, const std::vector<PickQuad> &quads);
+	void addFrame(const std::shared_ptr<const PickFrame> &frame);
+	int getFrameCount() const;
+	const PickFrame & getFrame(int frame) const;
+
+private:
+	std::vector<std::shared_ptr<const PickFrame> > m_frames;
+};
+
+struct PickHit {
+	int frame;
+	int quad;
+	double distance;
+	float point[3];
+};
+
+typedef bool (*PickFunction)(const HologramSnapshot &snapshot, const float pos[3], const float dir[3], int start, int end,
+	double zSpacing, double maxDistance, PickHit &hit);
+
+//Finds the closest quad in the frames [start, end] hit by the ray pos + d * dir with 0 < d < maxDistance.
+//Frames are shifted along z as given by Mode::zOffset. Returns false if nothing was hit.
+//Uses AVX or SSE to test PICK_BLOCK rectangles per iteration when available.
+//Instantiated for StackMode, OverlayMode and MovieMode.
+template <class Mode>
+bool pickHologram(const HologramSnapshot &snapshot, const float pos[3], const float dir[3], int start, int end,
+	double zSpacing, double maxDistance, PickHit &hit);
+
+//Reference implementation testing one rectangle at a time.
+template <class Mode>
+bool pickHologramScalar(const HologramSnapshot &snapshot, const float pos[3], const float dir[3], int start, int end,
+	double zSpacing, double maxDistance, PickHit &hit);
+
+#endif //HOLOGRAMPICKER_H
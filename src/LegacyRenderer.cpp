@@ -0,0 +1,182 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+#include <GL/glew.h>
+#include "LegacyRenderer.h"
+#include "TextureCodec.h"
+
+static const GLenum primitives[] = { GL_POINTS, GL_LINES, GL_TRIANGLES };
+
+LegacyRenderer::LegacyRenderer() : m_compressedGrayAlpha(false)
+{
+	//RGTC2 holds gray in red and alpha in green, which needs a swizzle to be sampled
+	m_compressedGrayAlpha = GLEW_VERSION_3_3 || (GLEW_ARB_texture_compression_rgtc && GLEW_ARB_texture_swizzle);
+
+}
+
+LegacyRenderer::~LegacyRenderer()
+{
+
+}
+
+std::string LegacyRenderer::getName()
+{
+	return "legacy";
+}
+
+bool LegacyRenderer::supportsFormat(TextureFormat format)
+{
+	return format != RGTC2 || m_compressedGrayAlpha;
+}
+
+unsigned int LegacyRenderer::createTexture(int width, int height, TextureFormat format, const unsigned char *pixels)
+{
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	if (format == RGTC2)
+	{
+		GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+		glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RG_RGTC2, width, height, 0, getRGTC2Size(width, height), pixels);
+	}
+	else
+	{
+		GLenum glFormat = (format == ALPHA) ? GL_ALPHA : (format == GRAY_ALPHA) ? GL_LUMINANCE_ALPHA : GL_RGBA;
+		glPixelStorei(GL_UNPACK_ALIGNMENT, (format == RGBA) ? 4 : 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, glFormat, width, height, 0, glFormat, GL_UNSIGNED_BYTE, pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return texture;
+}
+
+void LegacyRenderer::deleteTexture(unsigned int texture)
+{
+	GLuint name = texture;
+	glDeleteTextures(1, &name);
+}
+
+void LegacyRenderer::upload(const RenderList &list)
+{
+	//the vertices are read from client memory while drawing
+}
+
+void LegacyRenderer::draw(const RenderList &list, const float *projection, const float *view)
+{
+	glDepthFunc(GL_LEQUAL);
+	glClearDepth(1.0f);
+	glClearColor(0.0, 0.0, 0.0, 1.f);
+	glDisable(GL_LIGHTING);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixf(projection);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixf(view);
+
+	const std::vector<RenderVertex> &vertices = list.getVertices();
+	const std::vector<RenderInstance> &instances = list.getInstances();
+	const std::vector<RenderCommand> &commands = list.getCommands();
+	if (vertices.empty())
+		return;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+
+	for (std::vector<RenderCommand>::const_iterator it = commands.begin(); it != commands.end(); ++it)
+	{
+		applyState(it->state);
+
+		const RenderVertex *first = &vertices[it->first];
+		glVertexPointer(3, GL_FLOAT, sizeof(RenderVertex), first->position);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(RenderVertex), first->texCoord);
+
+		glPushMatrix();
+		glMultMatrixf(list.getMatrix(it->matrix));
+		for (int i = it->instanceFirst; i < it->instanceFirst + it->instanceCount; i++)
+		{
+			if (instances[i].alpha == 1.0f)
+			{
+				glColorPointer(4, GL_FLOAT, sizeof(RenderVertex), first->color);
+			}
+			else
+			{
+				//no shader to apply the fade, so the colors are scaled on the CPU
+				m_fadedColors.resize(it->count * 4);
+				for (int v = 0; v < it->count; v++)
+				{
+					for (int c = 0; c < 4; c++)
+						m_fadedColors[v * 4 + c] = first[v].color[c] * instances[i].alpha;
+				}
+				glColorPointer(4, GL_FLOAT, 0, &m_fadedColors[0]);
+			}
+
+			if (instances[i].offset != 0.0f)
+			{
+				glPushMatrix();
+				glTranslatef(0.0f, 0.0f, instances[i].offset);
+				glDrawArrays(primitives[it->primitive], 0, it->count);
+				glPopMatrix();
+			}
+			else
+			{
+				glDrawArrays(primitives[it->primitive], 0, it->count);
+			}
+		}
+		glPopMatrix();
+	}
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	RenderState reset = { 0, RenderList::BLEND_NONE, false, 1.0f, 1.0f };
+	applyState(reset);
+}
+
+void LegacyRenderer::applyState(const RenderState &state)
+{
+	if (state.texture != 0)
+	{
+		glEnable(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, state.texture);
+	}
+	else
+	{
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glDisable(GL_TEXTURE_2D);
+	}
+
+	if (state.blend == RenderList::BLEND_NONE)
+	{
+		glDisable(GL_BLEND);
+	}
+	else
+	{
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, (state.blend == RenderList::BLEND_ALPHA) ? GL_ONE_MINUS_SRC_ALPHA : GL_DST_ALPHA);
+	}
+
+	if (state.depthTest)
+	{
+		glEnable(GL_DEPTH_TEST);
+	}
+	else
+	{
+		glDisable(GL_DEPTH_TEST);
+	}
+
+	glLineWidth(state.lineWidth);
+	glPointSize(state.pointSize);
+}
@@ -0,0 +1,27 @@
+#ifndef LEGACYRENDERER_H
+#define LEGACYRENDERER_H
+
+#include <vector>
+#include "Renderer.h"
+
+//Fixed function backend using client side vertex arrays, for contexts without GL 3.3.
+class LegacyRenderer : public Renderer {
+public:
+	LegacyRenderer();
+	virtual ~LegacyRenderer();
+
+	virtual std::string getName();
+	virtual bool supportsFormat(TextureFormat format);
+	virtual unsigned int createTexture(int width, int height, TextureFormat format, const unsigned char *pixels);
+	virtual void deleteTexture(unsigned int texture);
+	virtual void upload(const RenderList &list);
+	virtual void draw(const RenderList &list, const float *projection, const float *view);
+
+private:
+	void applyState(const RenderState &state);
+
+	std::vector<float> m_fadedColors;
+	bool m_compressedGrayAlpha;
+};
+
+#endif //LEGACYRENDERER_H
@@ -0,0 +1,495 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "Manifest.h"
+
+#ifdef _MSC_VER
+	#define slash "\\"
+#else
+	#define slash "/"
+#endif
+
+#define MANIFEST_NAME "holo"
+#define MANIFEST_EXTENSION ".manifest"
+#define PIXEL_EXTENSION ".pixels"
+#define MANIFEST_MAGIC 0x4e414d48
+#define MANIFEST_VERSION 6
+
+struct ManifestHeader {
+	unsigned int magic;
+	unsigned int version;
+	//quads are stored as they are in memory
+	unsigned int quadSize;
+	int frames;
+	int textures;
+	int files;
+	int types;
+	int levels;
+	ManifestKey key;
+};
+
+static bool seekFile(FILE *file, unsigned long long offset)
+{
+#ifdef _MSC_VER
+	return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, offset, SEEK_SET) == 0;
+#endif
+}
+
+static unsigned long long getFileSize(FILE *file)
+{
+#ifdef _MSC_VER
+	_fseeki64(file, 0, SEEK_END);
+	unsigned long long size = _ftelli64(file);
+#else
+	fseeko(file, 0, SEEK_END);
+	unsigned long long size = ftello(file);
+#endif
+	seekFile(file, 0);
+	return size;
+}
+
+//Reads the values of a manifest one after the other, every read fails after the first
+//one which went past the end
+class ManifestReader {
+public:
+	ManifestReader(FILE *file) : m_file(file), m_left(getFileSize(file)), m_ok(true)
+	{
+
+	}
+
+	bool read(void *value, size_t size)
+	{
+		m_ok = m_ok && size <= m_left && (size == 0 || fread(value, 1, size, m_file) == size);
+		if (m_ok)
+			m_left -= size;
+		return m_ok;
+	}
+
+	template <class T> bool read(T &value)
+	{
+		return read(&value, sizeof(T));
+	}
+
+	template <class T> bool readArray(std::vector<T> &values, int count)
+	{
+		m_ok = m_ok && count >= 0 && (unsigned long long)count <= m_left / sizeof(T);
+		if (m_ok)
+			values.resize(count);
+		return m_ok && (count == 0 || read(&values[0], count * sizeof(T)));
+	}
+
+	bool readString(std::string &value)
+	{
+		int length = 0;
+		std::vector<char> characters;
+		if (!read(length) || !readArray(characters, length))
+			return false;
+		value.assign(characters.begin(), characters.end());
+		return true;
+	}
+
+	unsigned long long getLeft()
+	{
+		return m_left;
+	}
+
+private:
+	FILE *m_file;
+	unsigned long long m_left;
+	bool m_ok;
+};
+
+template <class T> static void writeValue(std::ofstream &out, const T &value)
+{
+	out.write((const char *)&value, sizeof(T));
+}
+
+template <class T> static void writeArray(std::ofstream &out, const std::vector<T> &values)
+{
+	writeValue(out, (int)values.size());
+	if (!values.empty())
+		out.write((const char *)&values[0], values.size() * sizeof(T));
+}
+
+static void writeString(std::ofstream &out, const std::string &value)
+{
+	writeValue(out, (int)value.size());
+	out.write(value.c_str(), value.size());
+}
+
+static bool isDirectory(const std::string &path)
+{
+	struct stat info;
+	return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR);
+}
+
+static std::string getManifestPath(const std::string &dataPath, const std::string &extension)
+{
+	return isDirectory(dataPath) ? dataPath + slash + MANIFEST_NAME + extension : dataPath + extension;
+}
+
+static unsigned long long getQuadBytes(int quads)
+{
+	return (unsigned long long)quads * (sizeof(hologram) + sizeof(int));
+}
+
+ManifestKey getManifestKey(const std::string &dataPath, double minZ, int skip, int limit)
+{
+	ManifestKey key;
+	struct stat info;
+	if (isDirectory(dataPath))
+	{
+		//the time of the folder changes with the manifest itself, so the frame folders are
+		//compared together with the size and time of their reports and CTD files
+		std::vector<std::string> folders = ReadSubDirectories(dataPath);
+		unsigned long long hash = 14695981039346656037ULL;
+		for (std::vector<std::string>::const_iterator it = folders.begin(); it != folders.end(); ++it)
+		{
+			for (int i = 0; i <= it->size(); i++)
+				hash = (hash ^ (unsigned char)(*it).c_str()[i]) * 1099511628211ULL;
+
+			std::string files[2] = { getReportPath(*it), getCTDPath(*it) };
+			for (int f = 0; f < 2; f++)
+			{
+				long long values[2] = { -1, -1 };
+				if (stat((dataPath + slash + files[f]).c_str(), &info) == 0)
+				{
+					values[0] = info.st_size;
+					values[1] = info.st_mtime;
+				}
+				const unsigned char *bytes = (const unsigned char *)values;
+				for (int i = 0; i < sizeof(values); i++)
+					hash = (hash ^ bytes[i]) * 1099511628211ULL;
+			}
+		}
+		key.sourceSize = folders.size();
+		key.sourceTime = hash;
+	}
+	else
+	{
+		bool found = stat(dataPath.c_str(), &info) == 0;
+		key.sourceSize = found ? info.st_size : -1;
+		key.sourceTime = found ? info.st_mtime : -1;
+	}
+	key.minZ = minZ;
+	key.skip = skip;
+	key.limit = limit;
+	return key;
+}
+
+Manifest::Manifest() : m_file(NULL), m_quadStart(0)
+{
+
+}
+
+Manifest::~Manifest()
+{
+	close();
+}
+
+bool Manifest::write(const std::string &dataPath, const ManifestKey &key, const std::vector<DataSet> &data, const std::vector<HologramTexture> &textures, const std::vector<TextureLocation> &locations)
+{
+	//the pixels are written first, a manifest is only there when its pixel file is complete
+	std::string manifestPath = getManifestPath(dataPath, MANIFEST_EXTENSION);
+	remove(manifestPath.c_str());
+
+	//textures with a cache are read from it, the others are copied to the pixel file
+	std::vector<ManifestTexture> entries(textures.size());
+	std::vector<std::string> files(1);
+	std::ofstream pixels(getManifestPath(dataPath, PIXEL_EXTENSION).c_str(), std::ios::binary);
+	unsigned long long offset = 0;
+	for (int i = 0; i < textures.size() && pixels.good(); i++)
+	{
+		entries[i].width = textures[i].width;
+		entries[i].height = textures[i].height;
+		entries[i].compressed = textures[i].compressed;
+		entries[i].size = textures[i].data.size();
+		if (i < locations.size() && !locations[i].filename.empty())
+		{
+			entries[i].file = files.size();
+			entries[i].offset = locations[i].offset;
+			files.push_back(locations[i].filename);
+			continue;
+		}
+
+		entries[i].file = 0;
+		entries[i].offset = offset;
+		if (!textures[i].data.empty())
+			pixels.write((const char *)&textures[i].data[0], textures[i].data.size());
+		offset += textures[i].data.size();
+	}
+	pixels.close();
+
+	unsigned short types = 0;
+	for (std::vector<DataSet>::const_iterator it = data.begin(); it != data.end(); ++it)
+	{
+		for (std::vector<hologram>::const_iterator it_h = it->quads.begin(); it_h != it->quads.end(); ++it_h)
+			types = std::max(types, (unsigned short)(it_h->type + 1));
+	}
+
+	//every level keeps every MANIFEST_LEVEL_STEP th frame of the one below until one frame is left
+	std::vector<std::vector<int> > levels(1);
+	for (int i = 0; i < data.size(); i++)
+		levels[0].push_back(i);
+	while (levels.back().size() > 1)
+	{
+		std::vector<int> level;
+		for (int i = 0; i < levels.back().size(); i += MANIFEST_LEVEL_STEP)
+			level.push_back(levels.back()[i]);
+		levels.push_back(level);
+	}
+
+	ManifestHeader header;
+	header.magic = MANIFEST_MAGIC;
+	header.version = MANIFEST_VERSION;
+	header.quadSize = sizeof(hologram);
+	header.frames = data.size();
+	header.textures = textures.size();
+	header.files = files.size();
+	header.types = types;
+	header.levels = levels.size();
+	header.key = key;
+
+	std::ofstream out;
+	if (!pixels.fail())
+		out.open(manifestPath.c_str(), std::ios::binary);
+	if (out.is_open())
+	{
+		writeValue(out, header);
+		for (unsigned short i = 0; i < types; i++)
+			writeString(out, getHologramTypeName(i));
+		for (int i = 1; i < files.size(); i++)
+			writeString(out, files[i]);
+		if (!entries.empty())
+			out.write((const char *)&entries[0], entries.size() * sizeof(ManifestTexture));
+
+		//the table of frames, their quads follow after the levels
+		unsigned long long quadOffset = 0;
+		for (std::vector<DataSet>::const_iterator it = data.begin(); it != data.end(); ++it)
+		{
+			writeString(out, it->filename);
+			writeValue(out, it->id);
+			writeValue(out, (int)it->values.size());
+			for (int i = 0; i < it->values.size(); i++)
+			{
+				writeString(out, it->value_names[i]);
+				writeString(out, it->values[i]);
+			}
+			writeValue(out, it->boundsMin);
+			writeValue(out, it->boundsMax);
+			writeValue(out, (int)it->quads.size());
+			writeValue(out, quadOffset);
+			quadOffset += getQuadBytes(it->quads.size());
+		}
+		for (std::vector<std::vector<int> >::const_iterator it = levels.begin(); it != levels.end(); ++it)
+			writeArray(out, *it);
+
+		for (std::vector<DataSet>::const_iterator it = data.begin(); it != data.end(); ++it)
+		{
+			if (it->quads.empty())
+				continue;
+			out.write((const char *)&it->quads[0], it->quads.size() * sizeof(hologram));
+			out.write((const char *)&it->textures[0], it->textures.size() * sizeof(int));
+		}
+		out.close();
+	}
+	if (pixels.fail() || out.fail())
+	{
+		std::cerr << "Could not write the manifest " << manifestPath << std::endl;
+		remove(manifestPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool Manifest::open(const std::string &dataPath, const ManifestKey &key)
+{
+	close();
+	m_file = fopen(getManifestPath(dataPath, MANIFEST_EXTENSION).c_str(), "rb");
+	if (m_file == NULL)
+		return false;
+
+	ManifestReader reader(m_file);
+	ManifestHeader header;
+	if (!reader.read(header) || header.magic != MANIFEST_MAGIC || header.version != MANIFEST_VERSION || header.quadSize != sizeof(hologram)
+		|| header.frames < 0 || header.files < 1 || header.types < 0 || header.levels < 0
+		|| header.key.sourceSize != key.sourceSize || header.key.sourceTime != key.sourceTime || header.key.minZ != key.minZ
+		|| header.key.skip != key.skip || header.key.limit != key.limit)
+	{
+		close();
+		return false;
+	}
+
+	//type ids depend on the order types were seen in
+	bool ok = true;
+	for (int i = 0; ok && i < header.types; i++)
+	{
+		std::string name;
+		ok = reader.readString(name);
+		m_types.push_back(internHologramType(name));
+	}
+
+	//texture caches are relative to the data folder
+	m_files.push_back(getManifestPath(dataPath, PIXEL_EXTENSION));
+	for (int i = 1; ok && i < header.files; i++)
+	{
+		std::string name;
+		ok = reader.readString(name);
+		m_files.push_back(dataPath + slash + name);
+	}
+
+	ok = ok && reader.readArray(m_textures, header.textures);
+	for (int f = 0; ok && f < header.frames; f++)
+	{
+		m_frames.push_back(DataSet());
+		DataSet &set = m_frames.back();
+		int values = 0, quads = 0;
+		unsigned long long offset = 0;
+		ok = reader.readString(set.filename) && reader.read(set.id) && reader.read(values) && values >= 0
+			&& values <= reader.getLeft();
+		set.value_names.resize(ok ? values : 0);
+		set.values.resize(ok ? values : 0);
+		for (int i = 0; ok && i < values; i++)
+			ok = reader.readString(set.value_names[i]) && reader.readString(set.values[i]);
+		ok = ok && reader.read(set.boundsMin) && reader.read(set.boundsMax) && reader.read(quads) && reader.read(offset) && quads >= 0;
+		m_quadCounts.push_back(quads);
+		m_quadOffsets.push_back(offset);
+	}
+
+	m_levels.resize(ok ? header.levels : 0);
+	for (int l = 0; ok && l < header.levels; l++)
+	{
+		int frames = 0;
+		ok = reader.read(frames) && reader.readArray(m_levels[l], frames);
+		long long quads = 0;
+		for (std::vector<int>::const_iterator it = m_levels[l].begin(); ok && it != m_levels[l].end(); ++it)
+		{
+			ok = *it >= 0 && *it < header.frames;
+			quads += ok ? m_quadCounts[*it] : 0;
+		}
+		m_levelQuads.push_back(quads);
+	}
+
+	//the quads of all frames make up the rest of the file
+	unsigned long long quadBytes = 0;
+	for (int f = 0; ok && f < header.frames; f++)
+	{
+		ok = m_quadOffsets[f] == quadBytes;
+		quadBytes += getQuadBytes(m_quadCounts[f]);
+	}
+	ok = ok && reader.getLeft() == quadBytes && !m_levels.empty();
+	m_quadStart = getFileSize(m_file) - quadBytes;
+
+	//the pixel file has to hold every texture which is not in a cache
+	struct stat info;
+	unsigned long long pixelSize = 0;
+	for (std::vector<ManifestTexture>::const_iterator it = m_textures.begin(); ok && it != m_textures.end(); ++it)
+	{
+		ok = it->file >= 0 && it->file < m_files.size();
+		if (ok && it->file == 0)
+			pixelSize = std::max(pixelSize, it->offset + it->size);
+	}
+	ok = ok && stat(m_files[0].c_str(), &info) == 0 && (unsigned long long)info.st_size >= pixelSize;
+
+	if (!ok)
+		close();
+	return ok;
+}
+
+bool Manifest::isOpen()
+{
+	return m_file != NULL;
+}
+
+void Manifest::close()
+{
+	if (m_file)
+		fclose(m_file);
+	m_file = NULL;
+	m_frames.clear();
+	m_quadCounts.clear();
+	m_quadOffsets.clear();
+	m_types.clear();
+	m_textures.clear();
+	m_files.clear();
+	m_levels.clear();
+	m_levelQuads.clear();
+}
+
+void Manifest::getFrames(std::vector<DataSet> &data)
+{
+	data = m_frames;
+}
+
+int Manifest::getQuadCount(int frame)
+{
+	return m_quadCounts[frame];
+}
+
+bool Manifest::readQuads(int frame, DataSet &set)
+{
+	int count = m_quadCounts[frame];
+	set.quads.resize(count);
+	set.textures.resize(count);
+	if (count == 0)
+		return true;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	bool ok = seekFile(m_file, m_quadStart + m_quadOffsets[frame])
+		&& fread(&set.quads[0], sizeof(hologram), count, m_file) == count
+		&& fread(&set.textures[0], sizeof(int), count, m_file) == count;
+	lock.unlock();
+	for (int i = 0; ok && i < count; i++)
+	{
+		ok = set.quads[i].type < m_types.size() && set.textures[i] < (int)m_textures.size();
+		set.quads[i].type = ok ? m_types[set.quads[i].type] : 0;
+	}
+	if (!ok)
+	{
+		std::cerr << "Could not read the quads of " << m_frames[frame].filename << " from the manifest" << std::endl;
+		set.quads.clear();
+		set.textures.clear();
+	}
+	return ok;
+}
+
+const std::vector<ManifestTexture> & Manifest::getTextures()
+{
+	return m_textures;
+}
+
+const std::vector<std::string> & Manifest::getTextureFiles()
+{
+	return m_files;
+}
+
+int Manifest::getLevelCount()
+{
+	return m_levels.size();
+}
+
+int Manifest::getLevelStride(int level)
+{
+	int stride = 1;
+	for (int l = 0; l < level; l++)
+		stride *= MANIFEST_LEVEL_STEP;
+	return stride;
+}
+
+const std::vector<int> & Manifest::getLevelFrames(int level)
+{
+	return m_levels[level];
+}
+
+long long Manifest::getLevelQuads(int level)
+{
+	return m_levelQuads[level];
+}
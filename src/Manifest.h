@@ -0,0 +1,86 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DataSetLoader.h"
+
+//every level keeps every 4th frame of the level below
+#define MANIFEST_LEVEL_STEP 4
+
+//the data and the loading options a manifest was written for
+struct ManifestKey {
+	long long sourceSize;
+	long long sourceTime;
+	double minZ;
+	int skip;
+	int limit;
+};
+
+//where the pixels of a shared texture are, file indexes Manifest::getTextureFiles
+struct ManifestTexture {
+	int width;
+	int height;
+	int compressed;
+	int file;
+	unsigned long long offset;
+	unsigned long long size;
+};
+
+ManifestKey getManifestKey(const std::string &dataPath, double minZ, int skip, int limit);
+
+//The manifest holds everything the viewer needs before the first frame: the frames
+//with their bounds and CTD values, the temporal levels and where the pixels of each
+//shared texture are. The quads of a frame are only read when the frame is needed.
+//It is written after a full load, in the data folder or next to an archive, so later
+//starts read the manifest instead of every report and ROI. Pixels are read from the
+//texture caches of the loader, only textures without one, e.g. from archives, are
+//copied to the pixel file. Delete it to rebuild, also after deleting the caches.
+class Manifest {
+public:
+	Manifest();
+	~Manifest();
+
+	//locations has the texture cache of each texture, see DataSetLoader::getTextureLocations
+	static bool write(const std::string &dataPath, const ManifestKey &key, const std::vector<DataSet> &data, const std::vector<HologramTexture> &textures, const std::vector<TextureLocation> &locations);
+
+	//reads everything but the quads, fails if the manifest is missing or was written for another key
+	bool open(const std::string &dataPath, const ManifestKey &key);
+	bool isOpen();
+
+	//the frames with their CTD values and bounds but without quads
+	void getFrames(std::vector<DataSet> &data);
+	int getQuadCount(int frame);
+	//reads the quads and their texture indices into set, may be called from another thread
+	bool readQuads(int frame, DataSet &set);
+
+	const std::vector<ManifestTexture> & getTextures();
+	//the pixel file first, then the texture caches
+	const std::vector<std::string> & getTextureFiles();
+
+	//level 0 has every frame, level l every MANIFEST_LEVEL_STEP^l th
+	int getLevelCount();
+	static int getLevelStride(int level);
+	const std::vector<int> & getLevelFrames(int level);
+	long long getLevelQuads(int level);
+
+private:
+	void close();
+
+	FILE *m_file;
+	std::mutex m_mutex;
+	std::vector<std::string> m_files;
+	unsigned long long m_quadStart;
+	std::vector<DataSet> m_frames;
+	std::vector<int> m_quadCounts;
+	std::vector<unsigned long long> m_quadOffsets;
+	std::vector<unsigned short> m_types;
+	std::vector<ManifestTexture> m_textures;
+	std::vector<std::vector<int> > m_levels;
+	std::vector<long long> m_levelQuads;
+};
+
+#endif //MANIFEST_H
@@ -0,0 +1,112 @@
+#include <cmath>
+#include <iostream>
+
+#include "MoviePlayer.h"
+
+MoviePlayer::MoviePlayer(double fps, double maxWait, int decodeAhead) : m_fps(fps), m_maxWait(maxWait), m_decodeAhead(decodeAhead),
+	m_playing(false), m_startFrame(0), m_due(0), m_lastFrame(-1), m_waiting(false), m_shown(0), m_dropped(0), m_waits(0), m_waitSeconds(0)
+{
+
+}
+
+void MoviePlayer::start(double frame)
+{
+	m_playing = true;
+	m_playStart = Clock::now();
+	m_shown = 0;
+	m_dropped = 0;
+	m_waits = 0;
+	m_waitSeconds = 0;
+	seek(frame);
+}
+
+void MoviePlayer::stop()
+{
+	if (!m_playing)
+		return;
+	m_playing = false;
+
+	double seconds = std::chrono::duration<double>(Clock::now() - m_playStart).count();
+	std::cerr << "Played " << m_shown << " frames in " << seconds << " s (" << ((seconds > 0) ? m_shown / seconds : 0) << " fps), dropped "
+		<< m_dropped << ", waited " << m_waits << " times for " << m_waitSeconds << " s" << std::endl;
+}
+
+bool MoviePlayer::isPlaying()
+{
+	return m_playing;
+}
+
+void MoviePlayer::seek(double frame)
+{
+	m_start = Clock::now();
+	m_startFrame = frame;
+	m_due = frame;
+	m_lastFrame = -1;
+	m_waiting = false;
+}
+
+double MoviePlayer::getDueFrame(int count)
+{
+	if (count <= 0)
+		return 0;
+	double seconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+	m_due = std::fmod(m_startFrame + seconds * m_fps, (double)count);
+	return m_due;
+}
+
+void MoviePlayer::getAheadFrames(int count, int stride, std::vector<int> &frames)
+{
+	//the frames of a level are the multiples of its stride
+	int levelCount = (count + stride - 1) / stride;
+	int first = (int)m_due / stride;
+	for (int i = 0; i < m_decodeAhead && i < levelCount; i++)
+		frames.push_back(((first + i) % levelCount) * stride);
+}
+
+void MoviePlayer::present(int count, int stride, bool ready)
+{
+	int frame = (int)m_due - (int)m_due % stride;
+	if (ready)
+	{
+		if (m_waiting)
+			m_waitSeconds += std::chrono::duration<double>(Clock::now() - m_waitStart).count();
+		m_waiting = false;
+		if (frame == m_lastFrame)
+			return;
+		if (m_lastFrame >= 0)
+		{
+			int levelCount = (count + stride - 1) / stride;
+			int passed = (frame / stride - m_lastFrame / stride + levelCount) % levelCount;
+			if (passed > 1)
+				m_dropped += passed - 1;
+		}
+		m_lastFrame = frame;
+		m_shown++;
+		return;
+	}
+
+	Clock::time_point now = Clock::now();
+	if (!m_waiting)
+	{
+		m_waiting = true;
+		m_waitStart = now;
+		m_waits++;
+	}
+	double waited = std::chrono::duration<double>(now - m_waitStart).count();
+	if (waited < m_maxWait)
+	{
+		//the clock stands still on the frame waited for, m_due already contains the
+		//time since m_start so it can't be the new start
+		m_start = now;
+		m_startFrame = frame;
+		m_due = frame;
+		return;
+	}
+
+	m_waiting = false;
+	m_waitSeconds += waited;
+	m_dropped++;
+	m_lastFrame = frame;
+	m_start = now;
+	m_startFrame = frame + stride;
+}
@@ -0,0 +1,50 @@
+#ifndef MOVIEPLAYER_H
+#define MOVIEPLAYER_H
+
+#include <chrono>
+#include <vector>
+
+//Plays the frames back at a fixed rate of the wall clock instead of a step per rendered
+//frame. Frames passed because rendering was slower than the rate are dropped. When the
+//due frame is not loaded yet the clock waits for it up to maxWait seconds, after that
+//it is dropped as well and the clock moves on.
+class MoviePlayer {
+public:
+	MoviePlayer(double fps, double maxWait, int decodeAhead);
+
+	void start(double frame);
+	//stops the clock and prints the statistics of the playback
+	void stop();
+	bool isPlaying();
+	//continues from frame, e.g. after scrubbing through the graph
+	void seek(double frame);
+
+	//the frame which is due now, the movie starts over after count frames
+	double getDueFrame(int count);
+	//the due frame and the ones following it which should be read ahead, stride apart
+	void getAheadFrames(int count, int stride, std::vector<int> &frames);
+	//tells whether the due frame could be shown
+	void present(int count, int stride, bool ready);
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	double m_fps;
+	double m_maxWait;
+	int m_decodeAhead;
+	bool m_playing;
+	Clock::time_point m_start;
+	double m_startFrame;
+	double m_due;
+	int m_lastFrame;
+	bool m_waiting;
+	Clock::time_point m_waitStart;
+
+	Clock::time_point m_playStart;
+	int m_shown;
+	int m_dropped;
+	int m_waits;
+	double m_waitSeconds;
+};
+
+#endif //MOVIEPLAYER_H
@@ -0,0 +1,136 @@
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <iostream>
+
+#include "OffscreenContext.h"
+
+OffscreenContext::OffscreenContext() : m_display(EGL_NO_DISPLAY), m_context(EGL_NO_CONTEXT), m_framebuffer(0), m_width(0), m_height(0)
+{
+	m_renderbuffers[0] = 0;
+	m_renderbuffers[1] = 0;
+}
+
+OffscreenContext::~OffscreenContext()
+{
+	destroy();
+}
+
+bool OffscreenContext::create(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+
+	//the surfaceless platform needs neither X nor a GPU, the default display is tried otherwise
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+	if (getPlatformDisplay != NULL)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+#endif
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+		{
+			std::cerr << "Could not initialize EGL" << std::endl;
+			return false;
+		}
+	}
+	m_display = display;
+
+	EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = NULL;
+	EGLint configCount = 0;
+	eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		std::cerr << "EGL does not support desktop OpenGL" << std::endl;
+		destroy();
+		return false;
+	}
+
+	//a compatibility context works with both renderers, the core one is used if it has 3.3
+	m_context = eglCreateContext(display, (configCount > 0) ? config : NULL, EGL_NO_CONTEXT, NULL);
+	if (m_context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext)m_context))
+	{
+		std::cerr << "Could not create an offscreen OpenGL context, EGL error " << std::hex << eglGetError() << std::dec << std::endl;
+		destroy();
+		return false;
+	}
+	std::cerr << "Offscreen context " << glGetString(GL_VERSION) << " on " << glGetString(GL_RENDERER) << std::endl;
+	return true;
+}
+
+bool OffscreenContext::createFramebuffer()
+{
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glGenRenderbuffers(2, m_renderbuffers);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffers[0]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_width, m_height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_renderbuffers[0]);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffers[1]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, m_width, m_height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_renderbuffers[1]);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "The offscreen framebuffer is incomplete" << std::endl;
+		return false;
+	}
+	glViewport(0, 0, m_width, m_height);
+	return true;
+}
+
+void OffscreenContext::clear()
+{
+	glClearColor(0, 0, 0, 1);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void OffscreenContext::finish()
+{
+	glFinish();
+}
+
+void OffscreenContext::readPixels(std::vector<unsigned char> &pixels)
+{
+	pixels.resize(4 * m_width * m_height);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+}
+
+int OffscreenContext::getWidth()
+{
+	return m_width;
+}
+
+int OffscreenContext::getHeight()
+{
+	return m_height;
+}
+
+void OffscreenContext::destroy()
+{
+	if (m_display == EGL_NO_DISPLAY)
+		return;
+	if (m_context != EGL_NO_CONTEXT)
+	{
+		if (m_framebuffer != 0)
+		{
+			glDeleteFramebuffers(1, &m_framebuffer);
+			glDeleteRenderbuffers(2, m_renderbuffers);
+			m_framebuffer = 0;
+		}
+		eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(m_display, m_context);
+		m_context = EGL_NO_CONTEXT;
+	}
+	eglTerminate(m_display);
+	m_display = EGL_NO_DISPLAY;
+}
@@ -0,0 +1,38 @@
+#ifndef OFFSCREENCONTEXT_H
+#define OFFSCREENCONTEXT_H
+
+#include <vector>
+
+//An OpenGL context without a window for rendering on machines without a display.
+//It is created through EGL on the surfaceless Mesa platform if it is available and
+//renders into a framebuffer object of a fixed size.
+class OffscreenContext {
+public:
+	OffscreenContext();
+	~OffscreenContext();
+
+	//creates the context and makes it current
+	bool create(int width, int height);
+	//binds the framebuffer, needs the GL entry points, so it is called after the renderer was created
+	bool createFramebuffer();
+	void clear();
+	//waits until everything drawn so far is done
+	void finish();
+	//the rendered frame as RGBA rows from the bottom up
+	void readPixels(std::vector<unsigned char> &pixels);
+
+	int getWidth();
+	int getHeight();
+
+private:
+	void destroy();
+
+	void *m_display;
+	void *m_context;
+	unsigned int m_framebuffer;
+	unsigned int m_renderbuffers[2];
+	int m_width;
+	int m_height;
+};
+
+#endif //OFFSCREENCONTEXT_H
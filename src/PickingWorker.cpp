@@ -0,0 +1,93 @@
+#include "PickingWorker.h"
+
+PickingWorker::PickingWorker() : m_pick(NULL), m_hasRequest(false), m_running(false), m_front(0), m_sequence(0), m_readSequence(0)
+{
+	m_results[0].sequence = 0;
+	m_results[1].sequence = 0;
+}
+
+PickingWorker::~PickingWorker()
+{
+	stop();
+}
+
+void PickingWorker::start(PickFunction pick)
+{
+	stop();
+	m_pick = pick;
+	m_running = true;
+	m_thread = std::thread(&PickingWorker::run, this);
+}
+
+void PickingWorker::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_requestMutex);
+		m_running = false;
+	}
+	m_requestCondition.notify_one();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void PickingWorker::setSnapshot(std::shared_ptr<const HologramSnapshot> snapshot)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_requestMutex);
+		m_snapshot.swap(snapshot);
+	}
+	//a request may be waiting for the first snapshot
+	m_requestCondition.notify_one();
+}
+
+void PickingWorker::submit(const PickRequest &request)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_requestMutex);
+		m_request = request;
+		m_hasRequest = true;
+	}
+	m_requestCondition.notify_one();
+}
+
+bool PickingWorker::getResult(PickResult &result)
+{
+	//never wait for the worker, if it is just publishing we pick the result up next frame
+	std::unique_lock<std::mutex> lock(m_resultMutex, std::try_to_lock);
+	if (!lock.owns_lock() || m_results[m_front].sequence == m_readSequence)
+		return false;
+
+	result = m_results[m_front];
+	m_readSequence = result.sequence;
+	return true;
+}
+
+void PickingWorker::run()
+{
+	for (;;)
+	{
+		PickRequest request;
+		std::shared_ptr<const HologramSnapshot> snapshot;
+		{
+			std::unique_lock<std::mutex> lock(m_requestMutex);
+			while (m_running && (!m_hasRequest || !m_snapshot))
+				m_requestCondition.wait(lock);
+			if (!m_running)
+				return;
+			request = m_request;
+			snapshot = m_snapshot;
+			m_hasRequest = false;
+		}
+
+		PickResult &result = m_results[1 - m_front];
+		result.sequence = ++m_sequence;
+		result.hoverHit = m_pick(*snapshot, request.pos, request.dir, request.hoverStart, request.hoverEnd,
+			request.zSpacing, 5.0, result.hover);
+		result.measure = request.measure;
+		result.measureHit = request.measure && m_pick(*snapshot, request.pos, request.dir, request.measureStart, request.measureEnd,
+			request.zSpacing, 5.0, result.measurePoint);
+
+		std::lock_guard<std::mutex> lock(m_resultMutex);
+		m_front = 1 - m_front;
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef PICKINGWORKER_H
+#define PICKINGWORKER_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "HologramPicker.h"
+
+struct PickRequest {
+	float pos[3];
+	float dir[3];
+	int hoverStart, hoverEnd;
+	int measureStart, measureEnd;
+	bool measure;
+	double zSpacing;
+};
+
+struct PickResult {
+	unsigned int sequence;
+	bool hoverHit;
+	PickHit hover;
+	bool measure;
+	bool measureHit;
+	PickHit measurePoint;
+};
+
+//Runs picking on its own thread. Requests are coalesced, only the latest one which
+//arrived while the thread was busy is processed. Results are published through a
+//double buffer which can be read without blocking the render thread. The snapshot
+//can be replaced while the thread runs, a pick in progress finishes on the old one.
+class PickingWorker {
+public:
+	PickingWorker();
+	~PickingWorker();
+
+	void start(PickFunction pick);
+	void stop();
+
+	void setSnapshot(std::shared_ptr<const HologramSnapshot> snapshot);
+
+	void submit(const PickRequest &request);
+	bool getResult(PickResult &result);
+
+private:
+	void run();
+
+	std::shared_ptr<const HologramSnapshot> m_snapshot;
+	PickFunction m_pick;
+	std::thread m_thread;
+	std::mutex m_requestMutex;
+	std::condition_variable m_requestCondition;
+	PickRequest m_request;
+	bool m_hasRequest;
+	bool m_running;
+
+	std::mutex m_resultMutex;
+	PickResult m_results[2];
+	int m_front;
+	unsigned int m_sequence;
+	unsigned int m_readSequence;
+};
+
+#endif //PICKINGWORKER_H
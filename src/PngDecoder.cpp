@@ -0,0 +1,114 @@
+#include <png.h>
+
+#include "PngDecoder.h"
+
+#define PNG_SIGNATURE_SIZE 8
+
+struct PngDecodeState {
+	HologramTexture *texture;
+	BufferPool *pool;
+	int channels;
+};
+
+static void onInfo(png_structp png, png_infop info)
+{
+	PngDecodeState *state = (PngDecodeState *)png_get_progressive_ptr(png);
+
+	//interlaced rows arrive in passes, they would need a full intermediate image
+	if (png_get_interlace_type(png, info) != PNG_INTERLACE_NONE)
+		png_longjmp(png, 1);
+
+	//the same conversions imread does for IMREAD_COLOR, 8 bit rgb or gray without alpha
+	png_set_expand(png);
+	png_set_strip_16(png);
+	png_set_strip_alpha(png);
+	png_read_update_info(png, info);
+
+	state->channels = png_get_channels(png, info);
+	if (state->channels != 1 && state->channels != 3)
+		png_longjmp(png, 1);
+
+	HologramTexture *texture = state->texture;
+	texture->width = png_get_image_width(png, info);
+	texture->height = png_get_image_height(png, info);
+	state->pool->acquire(texture->data, 2 * texture->width * texture->height);
+}
+
+static void onRow(png_structp png, png_bytep row, png_uint_32 y, int pass)
+{
+	PngDecodeState *state = (PngDecodeState *)png_get_progressive_ptr(png);
+	HologramTexture *texture = state->texture;
+	if (row == NULL || y >= (png_uint_32)texture->height)
+		return;
+
+	unsigned char *grayAlpha = &texture->data[2 * y * texture->width];
+	if (state->channels == 3)
+	{
+		keyRow(row, texture->width, false, grayAlpha);
+	}
+	else
+	{
+		for (int x = 0; x < texture->width; x++)
+		{
+			*grayAlpha++ = row[x];
+			*grayAlpha++ = 255;
+		}
+	}
+}
+
+void keyRow(const unsigned char *pixels, int width, bool bgr, unsigned char *grayAlpha)
+{
+	//separate loops keep the channel offsets constant for the compiler
+	if (bgr)
+	{
+		for (int x = 0; x < width; x++, pixels += 3)
+		{
+			*grayAlpha++ = pixels[0];
+			*grayAlpha++ = (pixels[2] != pixels[0]) ? 0 : 255;
+		}
+	}
+	else
+	{
+		for (int x = 0; x < width; x++, pixels += 3)
+		{
+			*grayAlpha++ = pixels[2];
+			*grayAlpha++ = (pixels[0] != pixels[2]) ? 0 : 255;
+		}
+	}
+}
+
+bool decodeKeyedPNG(const unsigned char *bytes, size_t size, HologramTexture &texture, BufferPool &pool)
+{
+	if (size < PNG_SIGNATURE_SIZE || png_sig_cmp(bytes, 0, PNG_SIGNATURE_SIZE) != 0)
+		return false;
+
+	png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	png_infop info = png ? png_create_info_struct(png) : NULL;
+	if (info == NULL)
+	{
+		png_destroy_read_struct(&png, NULL, NULL);
+		return false;
+	}
+
+	PngDecodeState state;
+	state.texture = &texture;
+	state.pool = &pool;
+	state.channels = 0;
+	texture.width = 0;
+	texture.height = 0;
+	texture.compressed = false;
+
+	if (setjmp(png_jmpbuf(png)))
+	{
+		png_destroy_read_struct(&png, &info, NULL);
+		return false;
+	}
+
+	//the whole file is pushed at once, rows are still handed out one by one
+	png_set_progressive_read_fn(png, &state, onInfo, onRow, NULL);
+	png_process_data(png, info, (png_bytep)bytes, size);
+	png_destroy_read_struct(&png, &info, NULL);
+
+	//a truncated file never delivers its info
+	return state.channels != 0;
+}
@@ -0,0 +1,19 @@
+#ifndef PNGDECODER_H
+#define PNGDECODER_H
+
+#include <cstddef>
+
+#include "TextureCodec.h"
+#include "BufferPool.h"
+
+//Decodes a ROI png from memory and keys it in the same pass, every decoded row is
+//written as gray+alpha straight into texture.data, which is taken from pool. Returns
+//false for files which are not non-interlaced pngs or cannot be decoded, these are
+//left to OpenCV.
+bool decodeKeyedPNG(const unsigned char *bytes, size_t size, HologramTexture &texture, BufferPool &pool);
+
+//keys a row of 8 bit color pixels into gray+alpha, pixels where red differs from blue
+//are transparent, blue is the gray value. libpng rows are rgb, OpenCV rows bgr.
+void keyRow(const unsigned char *pixels, int width, bool bgr, unsigned char *grayAlpha);
+
+#endif //PNGDECODER_H
@@ -0,0 +1,300 @@
+#include <cmath>
+#include <cstring>
+#include "RenderList.h"
+
+static void multiply(const float *a, const float *b, float *result)
+{
+	//column major like OpenGL, result = a * b
+	float tmp[16];
+	for (int c = 0; c < 4; c++)
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			tmp[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1] + a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+		}
+	}
+	memcpy(result, tmp, sizeof(tmp));
+}
+
+static bool sameState(const RenderState &a, const RenderState &b)
+{
+	return a.texture == b.texture && a.blend == b.blend && a.depthTest == b.depthTest
+		&& a.lineWidth == b.lineWidth && a.pointSize == b.pointSize;
+}
+
+static void identity(float *m)
+{
+	memset(m, 0, 16 * sizeof(float));
+	m[0] = m[5] = m[10] = m[15] = 1.0f;
+}
+
+RenderList::RenderList()
+{
+	clear();
+}
+
+RenderList::~RenderList()
+{
+
+}
+
+void RenderList::clear()
+{
+	m_vertices.clear();
+	m_commands.clear();
+	m_instances.clear();
+	m_matrices.clear();
+	m_pending.clear();
+	m_primitive = -1;
+
+	memset(&m_current, 0, sizeof(m_current));
+	for (int i = 0; i < 4; i++)
+		m_current.color[i] = 1.0f;
+
+	m_stack.resize(1);
+	identity(m_stack[0].m);
+	m_matrixChanged = true;
+
+	m_state.texture = 0;
+	m_state.blend = BLEND_NONE;
+	m_state.depthTest = false;
+	m_state.lineWidth = 1.0f;
+	m_state.pointSize = 1.0f;
+
+	//instance 0 is the default without offset and fade
+	resetInstances();
+}
+
+void RenderList::begin(Primitive primitive)
+{
+	m_primitive = primitive;
+	m_pending.clear();
+}
+
+void RenderList::end()
+{
+	int first = m_vertices.size();
+	int primitive = m_primitive;
+	if (m_primitive == QUADS)
+	{
+		for (int i = 0; i + 3 < m_pending.size(); i += 4)
+		{
+			int order[6] = { 0, 1, 2, 0, 2, 3 };
+			for (int j = 0; j < 6; j++)
+				m_vertices.push_back(m_pending[i + order[j]]);
+		}
+		primitive = TRIANGLES;
+	}
+	else if (m_primitive == LINE_STRIP)
+	{
+		for (int i = 0; i + 1 < m_pending.size(); i++)
+		{
+			m_vertices.push_back(m_pending[i]);
+			m_vertices.push_back(m_pending[i + 1]);
+		}
+		primitive = LINES;
+	}
+	else
+	{
+		m_vertices.insert(m_vertices.end(), m_pending.begin(), m_pending.end());
+	}
+	m_pending.clear();
+	m_primitive = -1;
+
+	if (m_vertices.size() > first)
+		addCommand(primitive, first, m_vertices.size() - first);
+}
+
+void RenderList::color(float r, float g, float b, float a)
+{
+	m_current.color[0] = r;
+	m_current.color[1] = g;
+	m_current.color[2] = b;
+	m_current.color[3] = a;
+}
+
+void RenderList::color(const float *rgb)
+{
+	color(rgb[0], rgb[1], rgb[2]);
+}
+
+void RenderList::texCoord(float s, float t)
+{
+	m_current.texCoord[0] = s;
+	m_current.texCoord[1] = t;
+}
+
+void RenderList::vertex(float x, float y, float z)
+{
+	m_current.position[0] = x;
+	m_current.position[1] = y;
+	m_current.position[2] = z;
+	m_pending.push_back(m_current);
+}
+
+void RenderList::pushMatrix()
+{
+	m_stack.push_back(m_stack.back());
+}
+
+void RenderList::popMatrix()
+{
+	if (m_stack.size() > 1)
+	{
+		m_stack.pop_back();
+		m_matrixChanged = true;
+	}
+}
+
+void RenderList::multMatrix(const float *matrix)
+{
+	multiply(m_stack.back().m, matrix, m_stack.back().m);
+	m_matrixChanged = true;
+}
+
+void RenderList::translate(float x, float y, float z)
+{
+	float m[16];
+	identity(m);
+	m[12] = x;
+	m[13] = y;
+	m[14] = z;
+	multMatrix(m);
+}
+
+void RenderList::scale(float s)
+{
+	float m[16];
+	identity(m);
+	m[0] = m[5] = m[10] = s;
+	multMatrix(m);
+}
+
+void RenderList::rotateY(float degrees)
+{
+	float m[16];
+	identity(m);
+	float a = degrees * 3.14159265f / 180.0f;
+	m[0] = std::cos(a);
+	m[2] = -std::sin(a);
+	m[8] = std::sin(a);
+	m[10] = std::cos(a);
+	multMatrix(m);
+}
+
+const RenderState & RenderList::getState() const
+{
+	return m_state;
+}
+
+void RenderList::setState(const RenderState &state)
+{
+	m_state = state;
+}
+
+void RenderList::setTexture(unsigned int texture)
+{
+	m_state.texture = texture;
+}
+
+void RenderList::setBlend(Blend blend)
+{
+	m_state.blend = blend;
+}
+
+void RenderList::setDepthTest(bool depthTest)
+{
+	m_state.depthTest = depthTest;
+}
+
+void RenderList::setLineWidth(float width)
+{
+	m_state.lineWidth = width;
+}
+
+void RenderList::setPointSize(float size)
+{
+	m_state.pointSize = size;
+}
+
+void RenderList::setInstances(const RenderInstance *instances, int count)
+{
+	m_instanceFirst = m_instances.size();
+	m_instanceCount = count;
+	m_instances.insert(m_instances.end(), instances, instances + count);
+}
+
+void RenderList::setInstance(float offset, float alpha)
+{
+	RenderInstance instance = { offset, alpha };
+	setInstances(&instance, 1);
+}
+
+void RenderList::resetInstances()
+{
+	if (m_instances.empty())
+	{
+		RenderInstance instance = { 0.0f, 1.0f };
+		m_instances.push_back(instance);
+	}
+	m_instanceFirst = 0;
+	m_instanceCount = 1;
+}
+
+const std::vector<RenderVertex> & RenderList::getVertices() const
+{
+	return m_vertices;
+}
+
+const std::vector<RenderCommand> & RenderList::getCommands() const
+{
+	return m_commands;
+}
+
+const std::vector<RenderInstance> & RenderList::getInstances() const
+{
+	return m_instances;
+}
+
+const float * RenderList::getMatrix(int matrix) const
+{
+	return m_matrices[matrix].m;
+}
+
+void RenderList::addCommand(int primitive, int first, int count)
+{
+	int matrix = getCurrentMatrix();
+	if (!m_commands.empty())
+	{
+		//extend the last draw if nothing but the vertices changed
+		RenderCommand &last = m_commands.back();
+		if (last.primitive == primitive && last.matrix == matrix
+			&& last.first + last.count == first
+			&& last.instanceFirst == m_instanceFirst && last.instanceCount == m_instanceCount
+			&& sameState(last.state, m_state))
+		{
+			last.count += count;
+			return;
+		}
+	}
+
+	RenderCommand command;
+	command.primitive = primitive;
+	command.state = m_state;
+	command.matrix = matrix;
+	command.first = first;
+	command.count = count;
+	command.instanceFirst = m_instanceFirst;
+	command.instanceCount = m_instanceCount;
+	m_commands.push_back(command);
+}
+
+int RenderList::getCurrentMatrix()
+{
+	if (m_matrixChanged || m_matrices.empty())
+	{
+		m_matrices.push_back(m_stack.back());
+		m_matrixChanged = false;
+	}
+	return m_matrices.size() - 1;
+}
@@ -0,0 +1,116 @@
+#ifndef RENDERLIST_H
+#define RENDERLIST_H
+
+#include <vector>
+
+struct RenderVertex {
+	float position[3];
+	float texCoord[2];
+	float color[4];
+};
+
+//z offset and fade of one draw. The offset is added to z before the model matrix
+//is applied, the alpha scales the whole vertex color.
+struct RenderInstance {
+	float offset;
+	float alpha;
+};
+
+struct RenderState {
+	unsigned int texture;
+	int blend;
+	bool depthTest;
+	float lineWidth;
+	float pointSize;
+};
+
+struct RenderCommand {
+	int primitive;
+	RenderState state;
+	int matrix;
+	int first, count;
+	int instanceFirst, instanceCount;
+};
+
+//Draw commands recorded once per frame and executed by a Renderer for every view.
+//Recording follows the immediate mode calls it replaces, quads and line strips are
+//converted to triangles and lines so consecutive draws with the same state merge.
+class RenderList {
+public:
+	enum Primitive {
+		POINTS,
+		LINES,
+		TRIANGLES,
+		LINE_STRIP,
+		QUADS
+	};
+
+	enum Blend {
+		BLEND_NONE,
+		//src alpha, one minus src alpha
+		BLEND_ALPHA,
+		//src alpha, dst alpha
+		BLEND_DST_ALPHA
+	};
+
+	RenderList();
+	~RenderList();
+
+	void clear();
+
+	void begin(Primitive primitive);
+	void end();
+	void color(float r, float g, float b, float a = 1.0f);
+	void color(const float *rgb);
+	void texCoord(float s, float t);
+	void vertex(float x, float y, float z);
+
+	void pushMatrix();
+	void popMatrix();
+	void multMatrix(const float *matrix);
+	void translate(float x, float y, float z);
+	void scale(float s);
+	void rotateY(float degrees);
+
+	const RenderState & getState() const;
+	void setState(const RenderState &state);
+	void setTexture(unsigned int texture);
+	void setBlend(Blend blend);
+	void setDepthTest(bool depthTest);
+	void setLineWidth(float width);
+	void setPointSize(float size);
+	//following draws are repeated for each instance until resetInstances is called
+	void setInstances(const RenderInstance *instances, int count);
+	void setInstance(float offset, float alpha);
+	void resetInstances();
+
+	const std::vector<RenderVertex> & getVertices() const;
+	const std::vector<RenderCommand> & getCommands() const;
+	const std::vector<RenderInstance> & getInstances() const;
+	const float * getMatrix(int matrix) const;
+
+private:
+	struct Matrix {
+		float m[16];
+	};
+
+	void addCommand(int primitive, int first, int count);
+	int getCurrentMatrix();
+
+	std::vector<RenderVertex> m_vertices;
+	std::vector<RenderCommand> m_commands;
+	std::vector<RenderInstance> m_instances;
+	std::vector<Matrix> m_matrices;
+
+	std::vector<RenderVertex> m_pending;
+	int m_primitive;
+	RenderVertex m_current;
+
+	std::vector<Matrix> m_stack;
+	bool m_matrixChanged;
+	RenderState m_state;
+	int m_instanceFirst;
+	int m_instanceCount;
+};
+
+#endif //RENDERLIST_H
@@ -0,0 +1,41 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+#include <GL/glew.h>
+#include <iostream>
+#include "CoreRenderer.h"
+#include "LegacyRenderer.h"
+
+Renderer * Renderer::create(const std::string &name)
+{
+	//core profile contexts do not list their entry points as extensions
+	glewExperimental = GL_TRUE;
+	GLenum error = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	//offscreen EGL contexts have no GLX display, the GL entry points are loaded anyway
+	if (error == GLEW_ERROR_NO_GLX_DISPLAY)
+		error = GLEW_OK;
+#endif
+	if (error != GLEW_OK)
+	{
+		std::cerr << "Could not initialize GLEW: " << glewGetErrorString(error) << std::endl;
+		return new LegacyRenderer();
+	}
+	//glewInit can leave a harmless GL_INVALID_ENUM behind on core contexts
+	glGetError();
+
+	if (name != "legacy")
+	{
+		if (GLEW_VERSION_3_3)
+		{
+			CoreRenderer * renderer = new CoreRenderer();
+			if (renderer->init())
+				return renderer;
+			delete renderer;
+		}
+		if (name == "core")
+			std::cerr << "OpenGL 3.3 is not available, using the legacy renderer" << std::endl;
+	}
+	return new LegacyRenderer();
+}
@@ -0,0 +1,35 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <string>
+#include "RenderList.h"
+
+//Executes recorded render lists. A list is uploaded once per frame from the context
+//callback and drawn for every view, so nothing is rebuilt per eye or wall.
+class Renderer {
+public:
+	enum TextureFormat {
+		RGBA,
+		//single channel, sampled as white with the value as alpha
+		ALPHA,
+		//two channels, gray replicated to rgb and the second as alpha
+		GRAY_ALPHA,
+		//RGTC2 (BC5) blocks of gray and alpha, see TextureCodec.h
+		RGTC2
+	};
+
+	virtual ~Renderer(){};
+
+	//needs a current context, returns NULL if neither backend can be used.
+	//name is "core" or "legacy", an empty name picks core if the context supports it.
+	static Renderer * create(const std::string &name);
+
+	virtual std::string getName() = 0;
+	virtual bool supportsFormat(TextureFormat format) = 0;
+	virtual unsigned int createTexture(int width, int height, TextureFormat format, const unsigned char *pixels) = 0;
+	virtual void deleteTexture(unsigned int texture) = 0;
+	virtual void upload(const RenderList &list) = 0;
+	virtual void draw(const RenderList &list, const float *projection, const float *view) = 0;
+};
+
+#endif //RENDERER_H
@@ -0,0 +1,118 @@
+#include <cstdlib>
+#include <sstream>
+
+#include "tinyxml2.h"
+#include "ReportParser.h"
+
+static std::istream& safeGetline(std::istream& is, std::string& t)
+{
+	t.clear();
+
+	// The characters in the stream are read one-by-one using a std::streambuf.
+	// That is faster than reading them one-by-one using the std::istream.
+	// Code that uses streambuf this way must be guarded by a sentry object.
+	// The sentry object performs various tasks,
+	// such as thread synchronization and updating the stream state.
+
+	std::istream::sentry se(is, true);
+	std::streambuf* sb = is.rdbuf();
+
+	for (;;)
+	{
+		int c = sb->sbumpc();
+		switch (c)
+		{
+		case '\n':
+			return is;
+		case '\r':
+			if (sb->sgetc() == '\n')
+				sb->sbumpc();
+			return is;
+		case EOF:
+			// Also handle the case when the last line has no line ending
+			if (t.empty())
+			{
+				is.setstate(std::ios::eofbit);
+			}
+			return is;
+		default:
+			t += (char)c;
+		}
+	}
+}
+
+bool parseReport(const char *text, size_t size, double minZ, DataSet &set, std::vector<std::string> &images)
+{
+	tinyxml2::XMLDocument doc;
+	if (doc.Parse(text, size) != tinyxml2::XML_SUCCESS || doc.FirstChildElement("doc") == NULL)
+		return false;
+
+	tinyxml2::XMLElement* titleElement;
+	titleElement = doc.FirstChildElement("doc")->FirstChildElement("DATA");
+	if (titleElement == NULL)
+		return false;
+
+	set.value_names.push_back("NB Particles detected");
+	set.values.push_back(titleElement->FirstChildElement("NBCONTOURS")->GetText());
+
+	for (tinyxml2::XMLElement* child = titleElement->FirstChildElement("ROI"); child != NULL; child = child->NextSiblingElement())
+	{
+		// do something with each child element
+		addHologram(std::atof(child->FirstChildElement("X")->GetText()),
+					std::atof(child->FirstChildElement("Y")->GetText()),
+					std::atof(child->FirstChildElement("DEPTH")->GetText()),
+					std::atof(child->FirstChildElement("WIDTH")->GetText()),
+					std::atof(child->FirstChildElement("HEIGHT")->GetText()),
+					std::atof(child->FirstChildElement("ESD")->GetText()),
+					std::atof(child->FirstChildElement("ESV")->GetText()),
+					"Diatom",
+					minZ,
+					set,
+					std::atof(child->FirstChildElement("CONTOUR")->GetText()));
+		images.push_back(child->FirstChildElement("IMAGE")->GetText());
+	}
+	return true;
+}
+
+void parseCTD(const char *text, size_t size, DataSet &set)
+{
+	std::istringstream fin(std::string(text, size));
+	std::istringstream in;
+	std::string line;
+	std::string s;
+	int count = 0;
+	while (!safeGetline(fin, line).eof())
+	{
+		in.clear();
+		in.str(line);
+		std::vector<std::string> tmp;
+		while (getline(in, s, ' ')) {
+			tmp.push_back(s);
+		}
+
+		if (tmp.size() == 2)
+		{
+			set.value_names.push_back(tmp[0]);
+			set.values.push_back(tmp[1]);
+		}
+		line.clear();
+		tmp.clear();
+		count++;
+	}
+}
+
+void addHologram(float x, float y, float z, float width, float height, double esd, double esv, const std::string &type, double minZ, DataSet &set, int ID)
+{
+	hologram q;
+	q.center[0] = x / SCALE;
+	q.center[1] = -y / SCALE;
+	q.center[2] = (-z + minZ) / SCALE / Z_SCALE;
+	q.halfExtent[0] = width / 2 / SCALE;
+	q.halfExtent[1] = height / 2 / SCALE;
+
+	q.esd = esd;
+	q.esv = esv;
+	q.type = internHologramType(type);
+	q.ID = ID;
+	set.quads.push_back(q);
+}
@@ -0,0 +1,21 @@
+#ifndef REPORTPARSER_H
+#define REPORTPARSER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "DataSetLoader.h"
+
+//Parses the report of a frame, reportRaw_refined.xml. Adds the particle count to the
+//values of set and a quad for every ROI, images gets the file name of each ROI image
+//relative to the frame folder. Returns false if the text is not a report.
+bool parseReport(const char *text, size_t size, double minZ, DataSet &set, std::vector<std::string> &images);
+
+//adds the "NAME value" lines of a CTD file to the values of set
+void parseCTD(const char *text, size_t size, DataSet &set);
+
+//adds a quad for a ROI, positions are moved so that minZ is at z = 0
+void addHologram(float x, float y, float z, float width, float height, double esd, double esv, const std::string &type, double minZ, DataSet &set, int ID);
+
+#endif //REPORTPARSER_H
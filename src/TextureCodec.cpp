@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "TextureCodec.h"
+
+static void propagateGray(unsigned char *grayAlpha, std::vector<int> &distance, int width, int height, int x, int y, const int neighbours[4][2])
+{
+	int i = y * width + x;
+	if (distance[i] == 0)
+		return;
+	for (int n = 0; n < 4; n++)
+	{
+		int nx = x + neighbours[n][0];
+		int ny = y + neighbours[n][1];
+		if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+			continue;
+		int j = ny * width + nx;
+		if (distance[j] + 1 < distance[i])
+		{
+			distance[i] = distance[j] + 1;
+			grayAlpha[2 * i] = grayAlpha[2 * j];
+		}
+	}
+}
+
+//the 8 values a BC4 block can represent for the two endpoints, the spec interpolates
+//exactly so the values are rounded, decoders may still differ by one
+static void getPalette(int e0, int e1, int palette[8])
+{
+	palette[0] = e0;
+	palette[1] = e1;
+	if (e0 > e1)
+	{
+		for (int i = 1; i < 7; i++)
+			palette[i + 1] = ((7 - i) * e0 + i * e1 + 3) / 7;
+	}
+	else
+	{
+		for (int i = 1; i < 5; i++)
+			palette[i + 1] = ((5 - i) * e0 + i * e1 + 2) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+//picks the closest palette entry for every pixel, returns the squared error
+static int fitBlock(const int values[16], int e0, int e1, int indices[16])
+{
+	int palette[8];
+	getPalette(e0, e1, palette);
+
+	int error = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		int best = 0;
+		int bestDiff = 256 * 256;
+		for (int p = 0; p < 8; p++)
+		{
+			int diff = (values[i] - palette[p]) * (values[i] - palette[p]);
+			if (diff < bestDiff)
+			{
+				bestDiff = diff;
+				best = p;
+			}
+		}
+		indices[i] = best;
+		error += bestDiff;
+	}
+	return error;
+}
+
+static void encodeBC4(const int values[16], unsigned char *block)
+{
+	int min = 255, max = 0;
+	int innerMin = 255, innerMax = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		if (values[i] < min) min = values[i];
+		if (values[i] > max) max = values[i];
+		//the 6 value mode has 0 and 255 for free, its endpoints only cover the rest
+		if (values[i] != 0 && values[i] < innerMin) innerMin = values[i];
+		if (values[i] != 255 && values[i] > innerMax) innerMax = values[i];
+	}
+
+	int indices[16];
+	int e0 = max, e1 = min;
+	int error = fitBlock(values, e0, e1, indices);
+
+	if (innerMin <= innerMax && error > 0)
+	{
+		int alternative[16];
+		int alternativeError = fitBlock(values, innerMin, innerMax, alternative);
+		if (alternativeError < error)
+		{
+			e0 = innerMin;
+			e1 = innerMax;
+			for (int i = 0; i < 16; i++)
+				indices[i] = alternative[i];
+		}
+	}
+
+	block[0] = e0;
+	block[1] = e1;
+	unsigned long long bits = 0;
+	for (int i = 0; i < 16; i++)
+		bits |= (unsigned long long)indices[i] << (3 * i);
+	for (int i = 0; i < 6; i++)
+		block[2 + i] = (bits >> (8 * i)) & 0xff;
+}
+
+static void decodeBC4(const unsigned char *block, int values[16])
+{
+	int palette[8];
+	getPalette(block[0], block[1], palette);
+
+	unsigned long long bits = 0;
+	for (int i = 0; i < 6; i++)
+		bits |= (unsigned long long)block[2 + i] << (8 * i);
+	for (int i = 0; i < 16; i++)
+		values[i] = palette[(bits >> (3 * i)) & 7];
+}
+
+//two passes of a chessboard distance transform, every transparent pixel takes the gray
+//of the neighbour it got its distance from
+void fillTransparentGray(unsigned char *grayAlpha, int width, int height)
+{
+	const int far = width + height;
+	std::vector<int> distance(width * height);
+	for (int i = 0; i < width * height; i++)
+		distance[i] = (grayAlpha[2 * i + 1] == 0) ? far : 0;
+
+	static const int forward[4][2] = { { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+			propagateGray(grayAlpha, distance, width, height, x, y, forward);
+	}
+	static const int backward[4][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 } };
+	for (int y = height - 1; y >= 0; y--)
+	{
+		for (int x = width - 1; x >= 0; x--)
+			propagateGray(grayAlpha, distance, width, height, x, y, backward);
+	}
+
+	for (int i = 0; i < width * height; i++)
+	{
+		if (distance[i] == far)
+			grayAlpha[2 * i] = 0;
+	}
+}
+
+int getRGTC2Size(int width, int height)
+{
+	return ((width + 3) / 4) * ((height + 3) / 4) * 16;
+}
+
+void encodeRGTC2(const unsigned char *grayAlpha, int width, int height, std::vector<unsigned char> &blocks)
+{
+	blocks.resize(getRGTC2Size(width, height));
+	unsigned char *block = blocks.empty() ? NULL : &blocks[0];
+
+	for (int by = 0; by < height; by += 4)
+	{
+		for (int bx = 0; bx < width; bx += 4)
+		{
+			int gray[16], alpha[16];
+			for (int i = 0; i < 16; i++)
+			{
+				int x = bx + i % 4;
+				int y = by + i / 4;
+				if (x >= width) x = width - 1;
+				if (y >= height) y = height - 1;
+				gray[i] = grayAlpha[2 * (y * width + x)];
+				alpha[i] = grayAlpha[2 * (y * width + x) + 1];
+			}
+			encodeBC4(gray, block);
+			encodeBC4(alpha, block + 8);
+			block += 16;
+		}
+	}
+}
+
+void decodeRGTC2(const unsigned char *blocks, int width, int height, std::vector<unsigned char> &grayAlpha)
+{
+	grayAlpha.resize(2 * width * height);
+	const unsigned char *block = blocks;
+
+	for (int by = 0; by < height; by += 4)
+	{
+		for (int bx = 0; bx < width; bx += 4)
+		{
+			int gray[16], alpha[16];
+			decodeBC4(block, gray);
+			decodeBC4(block + 8, alpha);
+			for (int i = 0; i < 16; i++)
+			{
+				int x = bx + i % 4;
+				int y = by + i / 4;
+				if (x < width && y < height)
+				{
+					grayAlpha[2 * (y * width + x)] = gray[i];
+					grayAlpha[2 * (y * width + x) + 1] = alpha[i];
+				}
+			}
+			block += 16;
+		}
+	}
+}
+
+//linear filtering mixes a pixel with its 8 neighbours at most
+static bool isReachable(const unsigned char *grayAlpha, int width, int height, int x, int y)
+{
+	for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ny++)
+	{
+		for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); nx++)
+		{
+			if (grayAlpha[2 * (ny * width + nx) + 1] != 0)
+				return true;
+		}
+	}
+	return false;
+}
+
+void compareGrayAlpha(const unsigned char *a, const unsigned char *b, int width, int height, TextureError &error)
+{
+	for (int i = 0; i < width * height; i++)
+	{
+		int alphaDiff = std::abs(a[2 * i + 1] - b[2 * i + 1]);
+		if (alphaDiff > error.maxAlpha)
+			error.maxAlpha = alphaDiff;
+
+		//the gray value of pixels away from the opaque ones is never visible
+		if (a[2 * i + 1] == 0 && !isReachable(a, width, height, i % width, i / width))
+			continue;
+
+		int grayDiff = std::abs(a[2 * i] - b[2 * i]);
+		if (grayDiff > error.maxGray)
+			error.maxGray = grayDiff;
+		error.sumSquared += grayDiff * grayDiff;
+		error.pixels++;
+	}
+}
+
+#define PRIME64_1 11400714785074694791ULL
+#define PRIME64_2 14029467366897019519ULL
+#define PRIME64_3 1609587929392839161ULL
+#define PRIME64_4 9650029242287828579ULL
+#define PRIME64_5 2870177450012600261ULL
+
+static unsigned long long rotateLeft(unsigned long long value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+static unsigned long long mixLane(unsigned long long hash, unsigned long long lane)
+{
+	lane *= PRIME64_2;
+	lane = rotateLeft(lane, 31);
+	lane *= PRIME64_1;
+	hash ^= lane;
+	return rotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+}
+
+unsigned long long hashTexture(const HologramTexture &texture)
+{
+	size_t size = texture.data.size();
+	const unsigned char *bytes = size ? &texture.data[0] : NULL;
+
+	//the layout is part of the content, the same bytes with another width are another image
+	unsigned long long hash = PRIME64_5 + size;
+	hash = mixLane(hash, ((unsigned long long)texture.width << 32) | (unsigned int)texture.height);
+	hash = mixLane(hash, texture.compressed);
+
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		unsigned long long lane;
+		memcpy(&lane, bytes + i, 8);
+		hash = mixLane(hash, lane);
+	}
+	for (; i < size; i++)
+	{
+		hash ^= bytes[i] * PRIME64_5;
+		hash = rotateLeft(hash, 11) * PRIME64_1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= PRIME64_2;
+	hash ^= hash >> 29;
+	hash *= PRIME64_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+bool sameTexture(const HologramTexture &a, const HologramTexture &b)
+{
+	return a.width == b.width && a.height == b.height && a.compressed == b.compressed && a.data == b.data;
+}
@@ -0,0 +1,46 @@
+#ifndef TEXTURECODEC_H
+#define TEXTURECODEC_H
+
+#include <vector>
+
+//Pixel data of one hologram ROI. Keyed images only carry a gray value and a binary
+//alpha, so they are stored as gray+alpha pairs or as RGTC2 (BC5) blocks, red holds
+//the gray value and green the alpha. Both are expanded to RGBA by a texture swizzle.
+struct HologramTexture {
+	int width;
+	int height;
+	bool compressed;
+	std::vector<unsigned char> data;
+	//position of the pixels in the source image, transparent borders are cropped
+	int cropX;
+	int cropY;
+	int sourceWidth;
+	int sourceHeight;
+};
+
+//difference between the source and the decoded blocks, only opaque pixels count for gray
+struct TextureError {
+	double sumSquared;
+	int pixels;
+	int maxGray;
+	int maxAlpha;
+};
+
+//gives transparent pixels the gray of the nearest opaque one (zero if there is none), so
+//linear filtering doesn't blend an arbitrary background into the visible edge and the
+//background doesn't take palette entries in blocks along the edge
+void fillTransparentGray(unsigned char *grayAlpha, int width, int height);
+
+//4x4 pixel blocks of 16 bytes, partial blocks at the border repeat the edge pixels
+int getRGTC2Size(int width, int height);
+void encodeRGTC2(const unsigned char *grayAlpha, int width, int height, std::vector<unsigned char> &blocks);
+void decodeRGTC2(const unsigned char *blocks, int width, int height, std::vector<unsigned char> &grayAlpha);
+//gray counts for the pixels linear filtering can blend into a visible one, the opaque
+//ones of a and their transparent neighbours
+void compareGrayAlpha(const unsigned char *a, const unsigned char *b, int width, int height, TextureError &error);
+
+//64 bit content hash of the stored pixels (xxHash64 mixing), used to share identical ROIs
+unsigned long long hashTexture(const HologramTexture &texture);
+bool sameTexture(const HologramTexture &a, const HologramTexture &b);
+
+#endif //TEXTURECODEC_H
@@ -0,0 +1,168 @@
+#include <iostream>
+
+#include "TextureStreamer.h"
+
+//pixels read ahead of the uploads
+#define STREAM_QUEUE_BYTES (64 * 1024 * 1024)
+
+static bool seekFile(FILE *file, unsigned long long offset)
+{
+#ifdef _MSC_VER
+	return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, offset, SEEK_SET) == 0;
+#endif
+}
+
+TextureStreamer::TextureStreamer(BufferPool &pool) : m_pool(pool), m_pixelFile(NULL), m_cacheFile(NULL), m_cacheIndex(-1), m_readyBytes(0), m_reading(false), m_running(false)
+{
+
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	stop();
+}
+
+void TextureStreamer::start(const std::vector<std::string> &files, const std::vector<ManifestTexture> &textures)
+{
+	stop();
+	m_files = files;
+	m_textures = textures;
+	m_running = true;
+	m_thread = std::thread(&TextureStreamer::run, this);
+}
+
+void TextureStreamer::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+	}
+	m_condition.notify_one();
+	if (m_thread.joinable())
+		m_thread.join();
+
+	for (std::deque<HologramTexture>::iterator it = m_ready.begin(); it != m_ready.end(); ++it)
+		m_pool.release(it->data);
+	m_ready.clear();
+	m_readyIndices.clear();
+	m_requests.clear();
+	m_readyBytes = 0;
+}
+
+void TextureStreamer::request(const std::vector<int> &indices, bool urgent)
+{
+	if (indices.empty())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_requests.insert((urgent) ? m_requests.begin() : m_requests.end(), indices.begin(), indices.end());
+	}
+	m_condition.notify_one();
+}
+
+void TextureStreamer::cancel()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_requests.clear();
+}
+
+void TextureStreamer::take(std::vector<int> &indices, std::vector<HologramTexture> &textures, size_t maxBytes)
+{
+	size_t taken = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		while (!m_ready.empty() && taken < maxBytes)
+		{
+			indices.push_back(m_readyIndices.front());
+			textures.push_back(HologramTexture());
+			std::swap(textures.back(), m_ready.front());
+			taken += textures.back().data.size();
+			m_readyIndices.pop_front();
+			m_ready.pop_front();
+		}
+		m_readyBytes -= taken;
+	}
+	if (taken > 0)
+		m_condition.notify_one();
+}
+
+bool TextureStreamer::isIdle()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_requests.empty() && !m_reading && m_ready.empty();
+}
+
+FILE * TextureStreamer::openFile(int file)
+{
+	if (file == 0)
+		return m_pixelFile;
+	if (file != m_cacheIndex)
+	{
+		if (m_cacheFile != NULL)
+			fclose(m_cacheFile);
+		m_cacheFile = fopen(m_files[file].c_str(), "rb");
+		m_cacheIndex = file;
+	}
+	return m_cacheFile;
+}
+
+void TextureStreamer::run()
+{
+	m_pixelFile = fopen(m_files[0].c_str(), "rb");
+	if (m_pixelFile == NULL)
+		std::cerr << "Could not open " << m_files[0] << std::endl;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		while (m_running && (m_requests.empty() || m_readyBytes > STREAM_QUEUE_BYTES))
+			m_condition.wait(lock);
+		if (!m_running)
+			break;
+
+		int index = m_requests.front();
+		m_requests.pop_front();
+		m_reading = true;
+		lock.unlock();
+
+		const ManifestTexture &entry = m_textures[index];
+		HologramTexture texture;
+		texture.width = entry.width;
+		texture.height = entry.height;
+		texture.compressed = entry.compressed != 0;
+		texture.cropX = 0;
+		texture.cropY = 0;
+		texture.sourceWidth = entry.width;
+		texture.sourceHeight = entry.height;
+		m_pool.acquire(texture.data, entry.size);
+		FILE *file = openFile(entry.file);
+		bool ok = file != NULL && seekFile(file, entry.offset)
+			&& (entry.size == 0 || fread(&texture.data[0], 1, entry.size, file) == entry.size);
+		if (!ok)
+		{
+			std::cerr << "Could not read texture " << index << " from " << m_files[entry.file] << std::endl;
+			m_pool.release(texture.data);
+		}
+
+		lock.lock();
+		m_reading = false;
+		if (ok)
+		{
+			m_readyIndices.push_back(index);
+			m_ready.push_back(HologramTexture());
+			std::swap(m_ready.back(), texture);
+			m_readyBytes += entry.size;
+		}
+	}
+	lock.unlock();
+
+	if (m_pixelFile != NULL)
+		fclose(m_pixelFile);
+	if (m_cacheFile != NULL)
+		fclose(m_cacheFile);
+	m_pixelFile = NULL;
+	m_cacheFile = NULL;
+	m_cacheIndex = -1;
+}
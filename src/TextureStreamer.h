@@ -0,0 +1,58 @@
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BufferPool.h"
+#include "Manifest.h"
+
+//Reads the pixels of requested textures from the files of a manifest on its own
+//thread, in the order they were requested. The render thread takes what has arrived
+//without waiting, the reader pauses while too much is waiting to be uploaded.
+class TextureStreamer {
+public:
+	TextureStreamer(BufferPool &pool);
+	~TextureStreamer();
+
+	//files are indexed by ManifestTexture::file, see Manifest::getTextureFiles
+	void start(const std::vector<std::string> &files, const std::vector<ManifestTexture> &textures);
+	void stop();
+
+	//urgent requests are read before the ones waiting
+	void request(const std::vector<int> &indices, bool urgent = false);
+	//drops the requests which are not read yet
+	void cancel();
+	//moves arrived textures and their indices out until maxBytes of pixels are taken
+	void take(std::vector<int> &indices, std::vector<HologramTexture> &textures, size_t maxBytes);
+	//nothing is requested or waiting to be taken
+	bool isIdle();
+
+private:
+	void run();
+	FILE * openFile(int file);
+
+	BufferPool &m_pool;
+	std::vector<std::string> m_files;
+	//the pixel file stays open, caches are opened one at a time
+	FILE *m_pixelFile;
+	FILE *m_cacheFile;
+	int m_cacheIndex;
+	std::vector<ManifestTexture> m_textures;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<int> m_requests;
+	std::deque<int> m_readyIndices;
+	std::deque<HologramTexture> m_ready;
+	size_t m_readyBytes;
+	bool m_reading;
+	bool m_running;
+};
+
+#endif //TEXTURESTREAMER_H
@@ -0,0 +1,38 @@
+#include "Traces.h"
+
+int getContourByID(const DataSet &set, int contourID)
+{
+	for (int i = 0; i < set.quads.size(); i++)
+	{
+		if (set.quads[i].ID == contourID)
+			return i;
+	}
+
+	return -1;
+}
+
+void buildTraceVertices(const std::vector<DataSet> &data, int frame, int length, int stride, std::vector<float> &vertices)
+{
+	vertices.clear();
+	if (frame < 0 || frame >= data.size() || stride < 1)
+		return;
+
+	for (int j = 0; j < data[frame].quads.size(); j++)
+	{
+		int id = data[frame].quads[j].ID;
+		int prev_slot = j;
+		for (int i = frame - stride; i > frame - length * stride && i >= 0; i -= stride)
+		{
+			int next_slot = getContourByID(data[i], id);
+
+			if (prev_slot >= 0 && next_slot >= 0){
+				const float *pts[2] = { data[i + stride].quads[prev_slot].center, data[i].quads[next_slot].center };
+				vertices.insert(vertices.end(), pts[0], pts[0] + 3);
+				vertices.insert(vertices.end(), pts[1], pts[1] + 3);
+			}
+
+			//next
+			prev_slot = next_slot;
+		}
+	}
+}
@@ -0,0 +1,16 @@
+#ifndef TRACES_H
+#define TRACES_H
+
+#include <vector>
+
+#include "DataSetLoader.h"
+
+//index of the quad of set with the contour id, -1 if the particle is not in the frame
+int getContourByID(const DataSet &set, int contourID);
+
+//line segments, two points each, following every particle of frame back through the
+//previous frames it was seen in, at most length - 1 frames back. Only every stride-th
+//frame is looked at, the others are not loaded at coarser temporal levels.
+void buildTraceVertices(const std::vector<DataSet> &data, int frame, int length, int stride, std::vector<float> &vertices);
+
+#endif //TRACES_H
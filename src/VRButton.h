@@ -8,7 +8,7 @@ class VRButton : public VRMenuElement {
 		VRButton(std::string name, std::string text = "");
 		virtual ~VRButton();
 
-		virtual void draw();
+		virtual void draw(RenderList &list);
 		virtual void click(double x, double y, bool isDown);
 
 	private:
@@ -0,0 +1,68 @@
+#ifndef VREVENTDISPATCHER_H
+#define VREVENTDISPATCHER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+//Dispatch table from event names to member function handlers. Names are interned
+//to an id when the handlers are registered, so dispatching an event costs a single
+//hash lookup instead of comparing the name against every known event.
+template <class Owner, class Event>
+class VREventDispatcher {
+public:
+	typedef void (Owner::*Handler)(const Event &event);
+
+	VREventDispatcher() : m_defaultHandler(NULL){};
+	~VREventDispatcher(){};
+
+	void registerHandler(const std::string &name, Handler handler)
+	{
+		m_handlers[intern(name)].push_back(handler);
+	}
+
+	void setDefaultHandler(Handler handler)
+	{
+		m_defaultHandler = handler;
+	}
+
+	int getID(const std::string &name) const
+	{
+		typename std::unordered_map<std::string, int>::const_iterator it = m_ids.find(name);
+		return (it == m_ids.end()) ? -1 : it->second;
+	}
+
+	bool dispatch(Owner * owner, const std::string &name, const Event &event) const
+	{
+		int id = getID(name);
+		if (id < 0)
+		{
+			if (m_defaultHandler)
+				(owner->*m_defaultHandler)(event);
+			return false;
+		}
+
+		for (typename std::vector<Handler>::const_iterator it = m_handlers[id].begin(); it != m_handlers[id].end(); ++it)
+			(owner->*(*it))(event);
+		return true;
+	}
+
+private:
+	int intern(const std::string &name)
+	{
+		int id = getID(name);
+		if (id >= 0)
+			return id;
+
+		id = m_handlers.size();
+		m_ids[name] = id;
+		m_handlers.push_back(std::vector<Handler>());
+		return id;
+	}
+
+	std::unordered_map<std::string, int> m_ids;
+	std::vector<std::vector<Handler> > m_handlers;
+	Handler m_defaultHandler;
+};
+
+#endif //VREVENTDISPATCHER_H
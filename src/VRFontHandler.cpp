@@ -1,27 +1,32 @@
-#ifdef _WIN32
-#include <windows.h>
-#endif
-#include <GL/gl.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
 
 #include "VRFontHandler.h"
+#include "Renderer.h"
+#include <algorithm>
 #include <iostream>
 
 #define TEXTBORDER 0.003
 
+//glyphs are rasterized once at FONT_ATLAS_PIXELS per em and laid out in units of
+//FONT_FACE_SIZE per em, which keeps the text scale of the former polygon font
+#define FONT_FACE_SIZE 10
+#define FONT_ATLAS_PIXELS 64
+#define FONT_ATLAS_WIDTH 1024
+#define FONT_FIRST_CHAR 32
+#define FONT_LAST_CHAR 126
+
 VRFontHandler* VRFontHandler::instance = NULL;
 
-VRFontHandler::VRFontHandler() 
+VRFontHandler::VRFontHandler() : m_texture(0)
 {
-	font= new FTGLPolygonFont("calibri.ttf");
-
-	if (font->Error()){
-		std::cerr << "Font load error" << std::endl;
-	}
-	font->FaceSize(10);
+	m_atlasSize[0] = 0;
+	m_atlasSize[1] = 0;
+	buildAtlas("calibri.ttf");
 
-	float ll[3], ur[3];
+	float ll[2], ur[2];
 	std::string test = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
-	font->BBox(test.c_str(), ll[0], ll[1], ll[2], ur[0], ur[1], ur[2]);
+	getBBox(test, ll, ur);
 	m_fontMinMax[0] = ll[1];
 	m_fontMinMax[1] = ur[1];
 }
@@ -29,7 +34,6 @@ VRFontHandler::VRFontHandler()
 VRFontHandler::~VRFontHandler()
 {
 	instance = NULL;
-	delete font;
 }
 
 VRFontHandler* VRFontHandler::getInstance()
@@ -41,16 +45,173 @@ VRFontHandler* VRFontHandler::getInstance()
 	return instance;
 }
 
-FTFont* VRFontHandler::getFont()
+void VRFontHandler::buildAtlas(const char * filename)
 {
-	return font;
+	Glyph empty = { 0, { 0, 0, 0, 0 }, { 0, 0, 0, 0 } };
+	m_glyphs.assign(FONT_LAST_CHAR + 1, empty);
+
+	FT_Library library;
+	FT_Face face;
+	if (FT_Init_FreeType(&library))
+	{
+		std::cerr << "Font load error" << std::endl;
+		return;
+	}
+	if (FT_New_Face(library, filename, 0, &face))
+	{
+		std::cerr << "Font load error" << std::endl;
+		FT_Done_FreeType(library);
+		return;
+	}
+	FT_Set_Pixel_Sizes(face, 0, FONT_ATLAS_PIXELS);
+	float unit = (float)FONT_FACE_SIZE / FONT_ATLAS_PIXELS;
+
+	//shelf packing, the bitmaps are kept until the final atlas height is known
+	std::vector<std::vector<unsigned char> > bitmaps(FONT_LAST_CHAR + 1);
+	std::vector<int> positions(2 * (FONT_LAST_CHAR + 1), 0);
+	std::vector<int> sizes(2 * (FONT_LAST_CHAR + 1), 0);
+	int x = 1, y = 1, rowHeight = 0;
+	for (int c = FONT_FIRST_CHAR; c <= FONT_LAST_CHAR; c++)
+	{
+		if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+			continue;
+
+		FT_GlyphSlot slot = face->glyph;
+		int width = slot->bitmap.width;
+		int rows = slot->bitmap.rows;
+		m_glyphs[c].advance = (slot->advance.x >> 6) * unit;
+		if (width == 0 || rows == 0)
+			continue;
+
+		if (x + width + 1 > FONT_ATLAS_WIDTH)
+		{
+			x = 1;
+			y += rowHeight + 1;
+			rowHeight = 0;
+		}
+		positions[2 * c] = x;
+		positions[2 * c + 1] = y;
+		sizes[2 * c] = width;
+		sizes[2 * c + 1] = rows;
+		bitmaps[c].resize(width * rows);
+		for (int r = 0; r < rows; r++)
+		{
+			const unsigned char * src = slot->bitmap.buffer + r * slot->bitmap.pitch;
+			std::copy(src, src + width, bitmaps[c].begin() + r * width);
+		}
+
+		m_glyphs[c].box[0] = slot->bitmap_left * unit;
+		m_glyphs[c].box[3] = slot->bitmap_top * unit;
+		m_glyphs[c].box[2] = m_glyphs[c].box[0] + width * unit;
+		m_glyphs[c].box[1] = m_glyphs[c].box[3] - rows * unit;
+
+		x += width + 1;
+		if (rows > rowHeight)
+			rowHeight = rows;
+	}
+	FT_Done_Face(face);
+	FT_Done_FreeType(library);
+
+	int height = 1;
+	while (height < y + rowHeight + 1)
+		height *= 2;
+	m_atlasSize[0] = FONT_ATLAS_WIDTH;
+	m_atlasSize[1] = height;
+	m_atlas.assign(m_atlasSize[0] * m_atlasSize[1], 0);
+
+	for (int c = FONT_FIRST_CHAR; c <= FONT_LAST_CHAR; c++)
+	{
+		if (bitmaps[c].empty())
+			continue;
+
+		int px = positions[2 * c], py = positions[2 * c + 1];
+		int width = sizes[2 * c], rows = sizes[2 * c + 1];
+		for (int r = 0; r < rows; r++)
+			std::copy(bitmaps[c].begin() + r * width, bitmaps[c].begin() + (r + 1) * width, m_atlas.begin() + (py + r) * m_atlasSize[0] + px);
+
+		//the first bitmap row is the top of the glyph
+		m_glyphs[c].texCoords[0] = (float)px / m_atlasSize[0];
+		m_glyphs[c].texCoords[1] = (float)py / m_atlasSize[1];
+		m_glyphs[c].texCoords[2] = (float)(px + width) / m_atlasSize[0];
+		m_glyphs[c].texCoords[3] = (float)(py + rows) / m_atlasSize[1];
+	}
 }
 
-void VRFontHandler::renderTextBox(std::string text, double x, double y, double z, double width, double height, TextAlignment alignment, bool rotateY)
+void VRFontHandler::createTexture(Renderer * renderer)
 {
-	float ll[3], ur[3], fontWidth, fontHeight;
+	if (m_atlas.empty())
+		return;
+
+	m_texture = renderer->createTexture(m_atlasSize[0], m_atlasSize[1], Renderer::ALPHA, &m_atlas[0]);
+	m_atlas.clear();
+}
+
+void VRFontHandler::getBBox(const std::string &text, float ll[2], float ur[2])
+{
+	ll[0] = ll[1] = ur[0] = ur[1] = 0;
+
+	bool first = true;
+	float pen = 0;
+	for (std::string::const_iterator it = text.begin(); it != text.end(); ++it)
+	{
+		unsigned char c = *it;
+		if (c > FONT_LAST_CHAR)
+			continue;
+
+		const Glyph &glyph = m_glyphs[c];
+		if (glyph.box[2] > glyph.box[0])
+		{
+			if (first || pen + glyph.box[0] < ll[0]) ll[0] = pen + glyph.box[0];
+			if (first || glyph.box[1] < ll[1]) ll[1] = glyph.box[1];
+			if (first || pen + glyph.box[2] > ur[0]) ur[0] = pen + glyph.box[2];
+			if (first || glyph.box[3] > ur[1]) ur[1] = glyph.box[3];
+			first = false;
+		}
+		pen += glyph.advance;
+	}
+}
+
+void VRFontHandler::renderText(RenderList &list, const std::string &text)
+{
+	if (m_texture == 0)
+		return;
+
+	RenderState state = list.getState();
+	list.setTexture(m_texture);
+	list.setBlend(RenderList::BLEND_ALPHA);
+
+	list.begin(RenderList::QUADS);
+	float pen = 0;
+	for (std::string::const_iterator it = text.begin(); it != text.end(); ++it)
+	{
+		unsigned char c = *it;
+		if (c > FONT_LAST_CHAR)
+			continue;
+
+		const Glyph &glyph = m_glyphs[c];
+		if (glyph.box[2] > glyph.box[0])
+		{
+			list.texCoord(glyph.texCoords[0], glyph.texCoords[3]);
+			list.vertex(pen + glyph.box[0], glyph.box[1], 0);
+			list.texCoord(glyph.texCoords[2], glyph.texCoords[3]);
+			list.vertex(pen + glyph.box[2], glyph.box[1], 0);
+			list.texCoord(glyph.texCoords[2], glyph.texCoords[1]);
+			list.vertex(pen + glyph.box[2], glyph.box[3], 0);
+			list.texCoord(glyph.texCoords[0], glyph.texCoords[1]);
+			list.vertex(pen + glyph.box[0], glyph.box[3], 0);
+		}
+		pen += glyph.advance;
+	}
+	list.end();
+
+	list.setState(state);
+}
+
+void VRFontHandler::renderTextBox(RenderList &list, std::string text, double x, double y, double z, double width, double height, TextAlignment alignment, bool rotateY)
+{
+	float ll[2], ur[2], fontWidth, fontHeight;
 	float scale = 0.02;
-	font->BBox(text.c_str(), ll[0], ll[1], ll[2], ur[0], ur[1], ur[2]);
+	getBBox(text, ll, ur);
 	fontWidth = (ur[0] - ll[0]) * scale;
 	fontHeight = (ur[1] - ll[1]) * scale;
 
@@ -73,33 +234,33 @@ void VRFontHandler::renderTextBox(std::string text, double x, double y, double z
 	off_x -= ll[0] * scale;
 	off_y -= ll[1] * scale;
 
-	glPushMatrix();
-	glTranslatef(x + off_x, y + off_y, z);
-	glScalef(scale, scale, scale);
-	if (rotateY)glRotatef(180, 0, 1, 0);
-	font->Render(text.c_str());
-	glPopMatrix();
+	list.pushMatrix();
+	list.translate(x + off_x, y + off_y, z);
+	list.scale(scale);
+	if (rotateY)list.rotateY(180);
+	renderText(list, text);
+	list.popMatrix();
 }
 
-void VRFontHandler::renderMultiLineTextBox(std::vector<std::string> text, double x, double y, double z, double width, double height, TextAlignment alignment, bool rotateY)
+void VRFontHandler::renderMultiLineTextBox(RenderList &list, std::vector<std::string> text, double x, double y, double z, double width, double height, TextAlignment alignment, bool rotateY)
 {
 	if (text.size() == 0)
 		return;
 
-	float ll[3], ur[3], fontWidth, fontHeight;
+	float ll[2], ur[2], fontWidth, fontHeight;
 	float scale = 0.02;
 	double textheight = height / text.size();
 
 	for (std::vector <std::string>::const_iterator it = text.begin(); it != text.end(); ++it){
-		font->BBox(it->c_str(), ll[0], ll[1], ll[2], ur[0], ur[1], ur[2]);
+		getBBox(*it, ll, ur);
 		fontWidth = (ur[0] - ll[0]) * scale;
-		
+
 		if (fontWidth > (width - 2.0*TEXTBORDER))
 		{
 			scale = (width - 2.0*TEXTBORDER) / fontWidth * scale;
 		}
 	}
-	
+
 	fontHeight = (m_fontMinMax[1] - m_fontMinMax[0]) * scale;
 	if (fontHeight > (textheight - 2.0*TEXTBORDER))
 	{
@@ -110,19 +271,19 @@ void VRFontHandler::renderMultiLineTextBox(std::vector<std::string> text, double
 	double off_y = (textheight - fontHeight) / 2.0f - m_fontMinMax[0] * scale;  //Bounding box isn't centered, so we need to add fudge factor
 
 	for (int i = 0; i < text.size(); i++){
-		font->BBox(text[i].c_str(), ll[0], ll[1], ll[2], ur[0], ur[1], ur[2]);
+		getBBox(text[i], ll, ur);
 		fontWidth = (ur[0] - ll[0]) * scale;
 		double off_x = (width  - fontWidth) / 2.0f;
-		
+
 		if (alignment == TextAlignment::LEFT) off_x = TEXTBORDER;
 		if (alignment == TextAlignment::RIGHT) off_x = width - TEXTBORDER - fontWidth;
 		off_x -= ll[0] * scale;
 
-		glPushMatrix();
-		glTranslatef(x + off_x, y + off_y + (text.size() - i - 1) * textheight, z);
-		glScalef(scale, scale, scale);
-		if (rotateY)glRotatef(180, 0, 1, 0);
-		font->Render(text[i].c_str());
-		glPopMatrix();
+		list.pushMatrix();
+		list.translate(x + off_x, y + off_y + (text.size() - i - 1) * textheight, z);
+		list.scale(scale);
+		if (rotateY)list.rotateY(180);
+		renderText(list, text[i]);
+		list.popMatrix();
 	}
 }
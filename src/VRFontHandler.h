@@ -1,8 +1,11 @@
 #ifndef VRFONT_H_
 #define VRFONT_H_
 
-#include <FTGL/ftgl.h>
 #include <string>
+#include <vector>
+#include "RenderList.h"
+
+class Renderer;
 
 class VRFontHandler
 	{
@@ -17,18 +20,33 @@ class VRFontHandler
 			virtual ~VRFontHandler();
 			static VRFontHandler* getInstance();
 
-			FTFont* getFont();
+			//uploads the glyph atlas, needs a current context
+			void createTexture(Renderer * renderer);
 
-			void renderTextBox(std::string text, double x, double y, double z, double width, double height, TextAlignment alignment = CENTER, bool rotateY = false);
-			void renderMultiLineTextBox(std::vector<std::string> text, double x, double y, double z, double width, double height, TextAlignment alignment = CENTER, bool rotateY = false);
+			void renderTextBox(RenderList &list, std::string text, double x, double y, double z, double width, double height, TextAlignment alignment = CENTER, bool rotateY = false);
+			void renderMultiLineTextBox(RenderList &list, std::vector<std::string> text, double x, double y, double z, double width, double height, TextAlignment alignment = CENTER, bool rotateY = false);
 
 		private:
+			//metrics are in font units, one em is FONT_FACE_SIZE units
+			struct Glyph
+			{
+				float advance;
+				float box[4];
+				float texCoords[4];
+			};
+
 			VRFontHandler();
 			static VRFontHandler* instance;
 
-			FTFont* font;
+			void buildAtlas(const char * filename);
+			void getBBox(const std::string &text, float ll[2], float ur[2]);
+			void renderText(RenderList &list, const std::string &text);
+
+			std::vector<Glyph> m_glyphs;
+			std::vector<unsigned char> m_atlas;
+			int m_atlasSize[2];
+			unsigned int m_texture;
 			double m_fontMinMax[2];
 	};
 
 #endif /* VRFONT_H_ */
-
@@ -1,14 +1,12 @@
-#ifdef _WIN32
-#define NOMINMAX 
-#include <windows.h>
-#endif
-#include <GL/gl.h>
 #include <limits>
 #include "VRGraph.h"
 
-VRGraph::VRGraph(std::string name, std::vector<double> data, bool vertical) : VRMenuElement(name, ""), m_data(data), m_current(-1), m_selection(-1), m_mouseDown(false), m_vertical(vertical)
+VRGraph::VRGraph(std::string name, std::vector<double> data, bool vertical) : VRMenuElement(name, ""), m_scatterFirst(0), m_scatterCount(0), m_size(0), m_spacing(0), m_active(0), m_overlay(false), m_current(-1), m_selection(-1), m_mouseDown(false), m_vertical(vertical)
 {
-	computeBounds();
+	m_scatter[0] = -1;
+	m_scatter[1] = -1;
+	if (!data.empty())
+		addSeries(data);
 }
 
 VRGraph::~VRGraph()
@@ -22,84 +20,118 @@ void VRGraph::addToMenu(VRMenu * menu, double x, double y, double width, double
 	computeBounds();
 }
 
-void VRGraph::draw()
+void VRGraph::draw(RenderList &list)
 {
 	// Draw Outline
-	glColor3f(0.0f, 0.0, 0.0f);
-	glBegin(GL_LINE_STRIP);
-	glVertex3f(m_x, m_y + m_height, Z_OFFSET);					// Top Left
-	glVertex3f(m_x + m_width, m_y + m_height, Z_OFFSET);		// Top Right
-	glVertex3f(m_x + m_width, m_y, Z_OFFSET);					// Bottom Right
-	glVertex3f(m_x, m_y, Z_OFFSET);							// Bottom Left
-	glVertex3f(m_x, m_y + m_height, Z_OFFSET);					// Top Left
-	glEnd();
+	list.color(0.0f, 0.0, 0.0f);
+	list.begin(RenderList::LINE_STRIP);
+	list.vertex(m_x, m_y + m_height, Z_OFFSET);					// Top Left
+	list.vertex(m_x + m_width, m_y + m_height, Z_OFFSET);		// Top Right
+	list.vertex(m_x + m_width, m_y, Z_OFFSET);					// Bottom Right
+	list.vertex(m_x, m_y, Z_OFFSET);							// Bottom Left
+	list.vertex(m_x, m_y + m_height, Z_OFFSET);					// Top Left
+	list.end();
 
-	if (!m_vertical){
-		glColor3f(0.0f, 0.0, 0.0f);
-		glBegin(GL_LINE_STRIP);
-		for (int i = 0; i < m_data.size(); i++){
-			if (m_data[i] != GRAPHUNDEFINEDVALUE)
-				glVertex3f(m_x + m_spacing[0] * i, m_y + (m_data[i] - m_range[0]) * m_spacing[1], Z_OFFSET);
+	if (!m_vertices.empty())
+	{
+		//all series share one vertex array, each one is a range within it
+		if (isScatter())
+		{
+			list.color(0.0f, 0.0, 0.0f);
+			list.setPointSize(3.0f);
+			addVertices(list, RenderList::POINTS, m_scatterFirst, m_scatterCount);
+			list.setPointSize(1.0f);
+		}
+		else
+		{
+			for (int i = 0; i < m_series.size(); i++){
+				if (i == m_active || m_overlay)
+				{
+					if (m_overlay)
+					{
+						list.color(m_series[i].color);
+					}
+					else
+					{
+						list.color(0.0f, 0.0, 0.0f);
+					}
+					list.setLineWidth((i == m_active && m_overlay) ? 2.0f : 1.0f);
+					addVertices(list, RenderList::LINE_STRIP, m_series[i].first, m_series[i].count);
+				}
+			}
+			list.setLineWidth(1.0f);
 		}
-		glEnd();
+	}
 
-		if (m_current >= 0 && m_current < m_data.size())
+	if (isScatter())
+	{
+		int marker[2] = { m_current, m_selection };
+		float color[2][3] = { { 0.9f, 0.0f, 0.0f }, { 0.0f, 0.9f, 0.0f } };
+		list.setPointSize(7.0f);
+		list.begin(RenderList::POINTS);
+		for (int i = 0; i < 2; i++){
+			double x = getScatterValue(m_scatter[0], marker[i], 0);
+			double y = getScatterValue(m_scatter[1], marker[i], 1);
+			if (x != GRAPHUNDEFINEDVALUE && y != GRAPHUNDEFINEDVALUE)
+			{
+				list.color(color[i]);
+				list.vertex(x, y, 2.0 * Z_OFFSET);
+			}
+		}
+		list.end();
+		list.setPointSize(1.0f);
+	}
+	else if (!m_vertical){
+		if (m_current >= 0 && m_current < m_size)
 		{
-			glColor3f(0.9f, 0.0, 0.0f);
-			glBegin(GL_LINE_STRIP);
-			glVertex3f(m_x + m_spacing[0] * m_current, m_y, Z_OFFSET);
-			glVertex3f(m_x + m_spacing[0] * m_current, m_y + (m_range[1] - m_range[0]) * m_spacing[1], Z_OFFSET);
-			glEnd();
+			list.color(0.9f, 0.0, 0.0f);
+			list.begin(RenderList::LINE_STRIP);
+			list.vertex(m_x + m_spacing * m_current, m_y, Z_OFFSET);
+			list.vertex(m_x + m_spacing * m_current, m_y + m_height, Z_OFFSET);
+			list.end();
 		}
 
-		if (m_selection >= 0 && m_selection < m_data.size())
+		if (m_selection >= 0 && m_selection < m_size)
 		{
-			glColor3f(0.0f, 0.9, 0.0f);
-			glBegin(GL_LINE_STRIP);
-			glVertex3f(m_x + m_spacing[0] * m_selection, m_y, Z_OFFSET);
-			glVertex3f(m_x + m_spacing[0] * m_selection, m_y + (m_range[1] - m_range[0]) * m_spacing[1], Z_OFFSET);
-			glEnd();
+			list.color(0.0f, 0.9, 0.0f);
+			list.begin(RenderList::LINE_STRIP);
+			list.vertex(m_x + m_spacing * m_selection, m_y, Z_OFFSET);
+			list.vertex(m_x + m_spacing * m_selection, m_y + m_height, Z_OFFSET);
+			list.end();
 		}
 	} else{
-		glColor3f(0.0f, 0.0, 0.0f);
-		glBegin(GL_LINE_STRIP);
-		for (int i = 0; i < m_data.size(); i++){
-			if (m_data[i] != GRAPHUNDEFINEDVALUE)
-				glVertex3f(m_x + (m_data[i] - m_range[0]) * m_spacing[1] , (m_y + m_height - m_spacing[0] * i) , Z_OFFSET);
-		}
-		glEnd();
-
-		if (m_current >= 0 && m_current < m_data.size())
+		if (m_current >= 0 && m_current < m_size)
 		{
-			glColor3f(0.9f, 0.0, 0.0f);
-			glBegin(GL_LINE_STRIP);
-			glVertex3f(m_x, m_y + m_height - m_spacing[0] * m_current, Z_OFFSET);
-			glVertex3f(m_x + (m_range[1] - m_range[0]) * m_spacing[1], m_y + m_height - m_spacing[0] * m_current, Z_OFFSET);
-			glEnd();
+			list.color(0.9f, 0.0, 0.0f);
+			list.begin(RenderList::LINE_STRIP);
+			list.vertex(m_x, m_y + m_height - m_spacing * m_current, Z_OFFSET);
+			list.vertex(m_x + m_width, m_y + m_height - m_spacing * m_current, Z_OFFSET);
+			list.end();
 		}
 
-		if (m_selection >= 0 && m_selection < m_data.size())
+		if (m_selection >= 0 && m_selection < m_size)
 		{
-			glColor3f(0.0f, 0.9, 0.0f);
-			glBegin(GL_LINE_STRIP);
-			glVertex3f(m_x, m_y + m_height - m_spacing[0] * m_current, Z_OFFSET);
-			glVertex3f(m_x + (m_range[1] - m_range[0]) * m_spacing[1], m_y + m_height - m_spacing[0] * m_current, Z_OFFSET);
-			glEnd();
+			list.color(0.0f, 0.9, 0.0f);
+			list.begin(RenderList::LINE_STRIP);
+			list.vertex(m_x, m_y + m_height - m_spacing * m_selection, Z_OFFSET);
+			list.vertex(m_x + m_width, m_y + m_height - m_spacing * m_selection, Z_OFFSET);
+			list.end();
 		}
 	}
 }
 
+void VRGraph::resetHover()
+{
+	VRMenuElement::resetHover();
+	if (!m_mouseDown)
+		m_selection = -1;
+}
+
 bool VRGraph::checkIntersect(MinVR::VRPoint3& pt)
 {
 	if (VRMenuElement::checkIntersect(pt))
 	{
-		if (!m_vertical){
-			m_selection = (pt.x - m_x) / m_spacing[0] + 0.5;
-		} else {
-			m_selection = (m_height - pt.y + m_y) / m_spacing[0] + 0.5;
-		}
-		if (m_selection < 0) m_selection = 0;
-		if (m_selection >= m_data.size()) m_selection = m_data.size() - 1;
+		m_selection = getSelection(pt.x, pt.y);
  		return true;
 	}
 	m_selection = -1;
@@ -123,25 +155,86 @@ void VRGraph::updateMousePosition(double x, double y)
 {
 	if (m_mouseDown)
 	{
-		if (!m_vertical){
-			m_selection = (x - m_x) / m_spacing[0] + 0.5;
-		} else
-		{
-			m_selection = (m_height - y + m_y) / m_spacing[0] + 0.5;
-		}
-
-		if (m_selection < 0) m_selection = 0;
-		if (m_selection >= m_data.size()) m_selection = m_data.size() - 1;
+		m_selection = getSelection(x, y);
 		m_menu->sendEvent(this);
 	}
 }
 
 void VRGraph::setData(std::vector<double> data)
 {
-	m_data = data;
+	if (m_series.empty())
+	{
+		addSeries(data);
+		return;
+	}
+	m_series[m_active].data = data;
+	computeRange(m_series[m_active]);
+	computeBounds();
+}
+
+int VRGraph::addSeries(const std::vector<double> &data, float r, float g, float b)
+{
+	appendSeries(data, r, g, b);
+	computeBounds();
+	return m_series.size() - 1;
+}
+
+void VRGraph::setSeries(const std::vector<std::vector<double> > &data, const float colors[][3], int colorCount)
+{
+	m_series.clear();
+	m_series.reserve(data.size());
+	for (int i = 0; i < data.size(); i++)
+		appendSeries(data[i], colors[i % colorCount][0], colors[i % colorCount][1], colors[i % colorCount][2]);
+	if (m_active >= m_series.size())
+		m_active = 0;
+	computeBounds();
+}
+
+void VRGraph::appendSeries(const std::vector<double> &data, float r, float g, float b)
+{
+	m_series.push_back(Series());
+	Series &series = m_series.back();
+	series.data = data;
+	series.color[0] = r;
+	series.color[1] = g;
+	series.color[2] = b;
+	series.first = 0;
+	series.count = 0;
+	computeRange(series);
+}
+
+void VRGraph::clearSeries()
+{
+	m_series.clear();
+	m_active = 0;
+	m_scatter[0] = -1;
+	m_scatter[1] = -1;
 	computeBounds();
 }
 
+void VRGraph::setActiveSeries(int series)
+{
+	//the vertices of all series are already built, switching only changes what is drawn
+	if (series >= 0 && series < m_series.size())
+		m_active = series;
+}
+
+void VRGraph::setOverlay(bool overlay)
+{
+	m_overlay = overlay;
+}
+
+void VRGraph::setScatter(int seriesX, int seriesY)
+{
+	if (seriesX == m_scatter[0] && seriesY == m_scatter[1])
+		return;
+
+	m_scatter[0] = seriesX;
+	m_scatter[1] = seriesY;
+	m_selection = -1;
+	buildVertices();
+}
+
 void VRGraph::setCurrent(int current)
 {
 	m_current = current;
@@ -154,27 +247,125 @@ int VRGraph::getSelection()
 
 void VRGraph::computeBounds()
 {
-	double min = std::numeric_limits<double>::max();
-	double max = std::numeric_limits<double>::min();
+	m_size = 0;
+	//the ranges are computed when the data of a series is set
+	for (std::vector<Series>::const_iterator it = m_series.begin(); it != m_series.end(); ++it)
+	{
+		if (m_size < it->data.size()) m_size = it->data.size();
+	}
 
-	if (m_data.size() <= 0)
-		return;
+	if (m_size > 0)
+		m_spacing = ((!m_vertical) ? m_width : m_height) / m_size;
+
+	buildVertices();
+}
+
+void VRGraph::computeRange(Series &series)
+{
+	computeSeriesRange(series.data, series.range);
+}
+
+void VRGraph::buildVertices()
+{
+	m_vertices.clear();
+	m_scatterFrames.clear();
+
+	for (std::vector<Series>::iterator it = m_series.begin(); it != m_series.end(); ++it)
+	{
+		it->first = m_vertices.size() / 3;
+		double range = it->range[1] - it->range[0];
+		decimateSeries(it->data, GRAPHMAXPOINTS, m_indices);
+		for (std::vector<int>::const_iterator i = m_indices.begin(); i != m_indices.end(); ++i)
+			addVertex(*i, (range > 0) ? (it->data[*i] - it->range[0]) / range : 0.5);
+		it->count = m_vertices.size() / 3 - it->first;
+	}
+
+	m_scatterFirst = m_vertices.size() / 3;
+	if (isScatter())
+	{
+		for (int i = 0; i < m_size; i++){
+			double x = getScatterValue(m_scatter[0], i, 0);
+			double y = getScatterValue(m_scatter[1], i, 1);
+			if (x != GRAPHUNDEFINEDVALUE && y != GRAPHUNDEFINEDVALUE)
+			{
+				m_vertices.push_back(x);
+				m_vertices.push_back(y);
+				m_vertices.push_back(Z_OFFSET);
+				m_scatterFrames.push_back(i);
+			}
+		}
+	}
+	m_scatterCount = m_vertices.size() / 3 - m_scatterFirst;
+}
+
+void VRGraph::addVertices(RenderList &list, RenderList::Primitive primitive, int first, int count)
+{
+	list.begin(primitive);
+	for (int i = first; i < first + count; i++)
+		list.vertex(m_vertices[3 * i], m_vertices[3 * i + 1], m_vertices[3 * i + 2]);
+	list.end();
+}
+
+void VRGraph::addVertex(double index, double value)
+{
+	if (!m_vertical){
+		m_vertices.push_back(m_x + m_spacing * index);
+		m_vertices.push_back(m_y + value * m_height);
+	} else
+	{
+		m_vertices.push_back(m_x + value * m_width);
+		m_vertices.push_back(m_y + m_height - m_spacing * index);
+	}
+	m_vertices.push_back(Z_OFFSET);
+}
 
-	for (std::vector<double>::const_iterator it = m_data.begin(); it != m_data.end(); ++it)
+bool VRGraph::isScatter()
+{
+	return m_scatter[0] >= 0 && m_scatter[0] < m_series.size() && m_scatter[1] >= 0 && m_scatter[1] < m_series.size();
+}
+
+int VRGraph::getSelection(double x, double y)
+{
+	int selection;
+	if (isScatter())
 	{
-		if (*it != GRAPHUNDEFINEDVALUE){
-			if (min > *it) min = *it;
-			if (max < *it) max = *it;
+		//pick the closest point
+		selection = -1;
+		double min_dist = std::numeric_limits<double>::max();
+		for (int i = 0; i < m_scatterCount; i++){
+			double dx = m_vertices[(m_scatterFirst + i) * 3] - x;
+			double dy = m_vertices[(m_scatterFirst + i) * 3 + 1] - y;
+			if (dx * dx + dy * dy < min_dist)
+			{
+				min_dist = dx * dx + dy * dy;
+				selection = m_scatterFrames[i];
+			}
 		}
+		return selection;
 	}
-	m_range[0] = min;
-	m_range[1] = max;
+
 	if (!m_vertical){
-		m_spacing[0] = m_width / m_data.size();
-		m_spacing[1] = m_height / (m_range[1] - m_range[0]);
+		selection = (x - m_x) / m_spacing + 0.5;
 	} else
 	{
-		m_spacing[0] = m_height / m_data.size();
-		m_spacing[1] = m_width / (m_range[1] - m_range[0]);
+		selection = (m_height - y + m_y) / m_spacing + 0.5;
 	}
+
+	if (selection < 0) selection = 0;
+	if (selection >= m_size) selection = m_size - 1;
+	return selection;
+}
+
+double VRGraph::getScatterValue(int series, int frame, int axis)
+{
+	if (series < 0 || series >= m_series.size() || frame < 0 || frame >= m_series[series].data.size())
+		return GRAPHUNDEFINEDVALUE;
+
+	const Series &s = m_series[series];
+	if (s.data[frame] == GRAPHUNDEFINEDVALUE)
+		return GRAPHUNDEFINEDVALUE;
+
+	double range = s.range[1] - s.range[0];
+	double value = (range > 0) ? (s.data[frame] - s.range[0]) / range : 0.5;
+	return (axis == 0) ? m_x + value * m_width : m_y + value * m_height;
 }
@@ -3,8 +3,10 @@
 
 #include "VRMenuElement.h"
 #include "VRFontHandler.h"
+#include "GraphSeries.h"
 
-#define GRAPHUNDEFINEDVALUE -999999999
+//series longer than this are decimated to min/max pairs per bucket
+#define GRAPHMAXPOINTS 2048
 
 class VRGraph : public VRMenuElement {
 public:
@@ -12,24 +14,56 @@ public:
 	virtual ~VRGraph();
 
 	virtual void addToMenu(VRMenu * menu, double x, double y, double width, double height);
-	virtual void draw();
+	virtual void draw(RenderList &list);
+	virtual void resetHover();
 	virtual bool checkIntersect(MinVR::VRPoint3 &pt);
 	virtual void click(double x, double y, bool isDown);
 	virtual void updateMousePosition(double x, double y);
 
 	void setData(std::vector<double> data);
+	int addSeries(const std::vector<double> &data, float r = 0.0f, float g = 0.0f, float b = 0.0f);
+	//replaces all series and builds the vertices once, the colors are used in turn
+	void setSeries(const std::vector<std::vector<double> > &data, const float colors[][3], int colorCount);
+	void clearSeries();
+	void setActiveSeries(int series);
+	void setOverlay(bool overlay);
+	void setScatter(int seriesX, int seriesY);
 	void setCurrent(int current);
 	int getSelection();
 
 private:
-	std::vector <double> m_data;
-	double m_spacing[2];
-	double m_range[2];
+	struct Series {
+		std::vector <double> data;
+		double range[2];
+		float color[3];
+		int first;
+		int count;
+	};
+
+	std::vector <Series> m_series;
+	std::vector <float> m_vertices;
+	std::vector <int> m_scatterFrames;
+	std::vector <int> m_indices;
+	int m_scatterFirst;
+	int m_scatterCount;
+	int m_size;
+	double m_spacing;
+	int m_active;
+	bool m_overlay;
+	int m_scatter[2];
 	int m_current;
 	int m_selection;
 	bool m_mouseDown;
 	bool m_vertical;
 	void computeBounds();
+	void computeRange(Series &series);
+	void appendSeries(const std::vector<double> &data, float r, float g, float b);
+	void buildVertices();
+	void addVertex(double index, double value);
+	void addVertices(RenderList &list, RenderList::Primitive primitive, int first, int count);
+	bool isScatter();
+	int getSelection(double x, double y);
+	double getScatterValue(int series, int frame, int axis);
 };
 
-#endif //VRGRAPH_H
\ No newline at end of file
+#endif //VRGRAPH_H
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include "VRListView.h"
+
+#define SCROLLBAR_RATIO 0.08
+
+VRListView::VRListView(std::string name, int rows) : VRMenuElement(name, ""), m_rows(rows), m_first(0), m_rowHeight(0), m_scrollbarWidth(0), m_hoverRow(-1), m_current(-1), m_selection(-1), m_scrolling(false)
+{
+
+}
+
+VRListView::~VRListView()
+{
+
+}
+
+void VRListView::addToMenu(VRMenu * menu, double x, double y, double width, double height)
+{
+	VRMenuElement::addToMenu(menu, x, y, width, height);
+	m_rowHeight = m_height / m_rows;
+	m_scrollbarWidth = m_width * SCROLLBAR_RATIO;
+}
+
+void VRListView::draw(RenderList &list)
+{
+	double listWidth = m_width - m_scrollbarWidth;
+
+	// Draw Outline
+	list.color(0.0f, 0.0, 0.0f);
+	list.begin(RenderList::LINE_STRIP);
+	list.vertex(m_x, m_y + m_height, Z_OFFSET);					// Top Left
+	list.vertex(m_x + m_width, m_y + m_height, Z_OFFSET);		// Top Right
+	list.vertex(m_x + m_width, m_y, Z_OFFSET);					// Bottom Right
+	list.vertex(m_x, m_y, Z_OFFSET);							// Bottom Left
+	list.vertex(m_x, m_y + m_height, Z_OFFSET);					// Top Left
+	list.end();
+
+	//only the visible rows are touched
+	int count = getCount();
+	for (int i = 0; i < m_rows && m_first + i < count; i++)
+	{
+		int item = getItem(m_first + i);
+		double row_y = m_y + m_height - (i + 1) * m_rowHeight;
+
+		if (item == m_current || i == m_hoverRow)
+		{
+			if (item == m_current)
+			{
+				list.color(0.9f, 0.5f, 0.5f);
+			}
+			else
+			{
+				list.color(0.8f, 0.8f, 0.8f);
+			}
+			list.begin(RenderList::QUADS);
+			list.vertex(m_x, row_y + m_rowHeight, Z_OFFSET);
+			list.vertex(m_x + listWidth, row_y + m_rowHeight, Z_OFFSET);
+			list.vertex(m_x + listWidth, row_y, Z_OFFSET);
+			list.vertex(m_x, row_y, Z_OFFSET);
+			list.end();
+		}
+
+		list.color(0.0f, 0.0, 0.0f);
+		VRFontHandler::getInstance()->renderTextBox(list, m_labels[item], m_x, row_y, 2.0 * Z_OFFSET, listWidth * 0.7, m_rowHeight, VRFontHandler::LEFT);
+		if (!m_infos[item].empty())
+			VRFontHandler::getInstance()->renderTextBox(list, m_infos[item], m_x + listWidth * 0.7, row_y, 2.0 * Z_OFFSET, listWidth * 0.3, m_rowHeight, VRFontHandler::RIGHT);
+	}
+
+	// Draw Scrollbar
+	list.color(0.0f, 0.0, 0.0f);
+	list.begin(RenderList::LINES);
+	list.vertex(m_x + listWidth, m_y + m_height, Z_OFFSET);
+	list.vertex(m_x + listWidth, m_y, Z_OFFSET);
+	list.end();
+
+	if (count > m_rows)
+	{
+		double thumb_height = std::max(m_height * m_rows / count, m_rowHeight * 0.5);
+		double thumb_y = m_y + m_height - thumb_height - (m_height - thumb_height) * m_first / (count - m_rows);
+		list.color(0.5f, 0.5f, 0.5f);
+		list.begin(RenderList::QUADS);
+		list.vertex(m_x + listWidth, thumb_y + thumb_height, 2.0 * Z_OFFSET);
+		list.vertex(m_x + m_width, thumb_y + thumb_height, 2.0 * Z_OFFSET);
+		list.vertex(m_x + m_width, thumb_y, 2.0 * Z_OFFSET);
+		list.vertex(m_x + listWidth, thumb_y, 2.0 * Z_OFFSET);
+		list.end();
+	}
+}
+
+void VRListView::resetHover()
+{
+	VRMenuElement::resetHover();
+	m_hoverRow = -1;
+}
+
+bool VRListView::checkIntersect(MinVR::VRPoint3& pt)
+{
+	if (pt.x >= m_x && pt.y >= m_y && pt.x <= m_x + m_width && pt.y <= m_y + m_height) {
+		m_hover = true;
+		m_hoverRow = (pt.x < m_x + m_width - m_scrollbarWidth) ? getRow(pt.y) : -1;
+		return true;
+	}
+	m_hoverRow = -1;
+	return false;
+}
+
+void VRListView::click(double x, double y, bool isDown)
+{
+	if (!isDown)
+	{
+		m_scrolling = false;
+		return;
+	}
+
+	if (x >= m_x + m_width - m_scrollbarWidth)
+	{
+		m_scrolling = true;
+		scrollToPosition(y);
+		return;
+	}
+
+	int row = getRow(y);
+	if (row >= 0 && m_first + row < getCount())
+	{
+		m_selection = getItem(m_first + row);
+		m_menu->sendEvent(this);
+	}
+}
+
+void VRListView::updateMousePosition(double x, double y)
+{
+	if (m_scrolling)
+		scrollToPosition(y);
+}
+
+void VRListView::addItem(std::string label, std::string info)
+{
+	m_labels.push_back(label);
+	m_infos.push_back(info);
+	if (!m_filter.empty() && label.find(m_filter) != std::string::npos)
+		m_filtered.push_back(m_labels.size() - 1);
+}
+
+void VRListView::clearItems()
+{
+	m_labels.clear();
+	m_infos.clear();
+	m_filtered.clear();
+	m_first = 0;
+	m_selection = -1;
+}
+
+void VRListView::setFilter(std::string filter)
+{
+	m_filter = filter;
+	m_filtered.clear();
+	if (!m_filter.empty())
+	{
+		for (int i = 0; i < m_labels.size(); i++){
+			if (m_labels[i].find(m_filter) != std::string::npos)
+				m_filtered.push_back(i);
+		}
+	}
+	scrollTo(0);
+}
+
+std::string VRListView::getFilter()
+{
+	return m_filter;
+}
+
+void VRListView::scrollTo(int row)
+{
+	int max_first = getCount() - m_rows;
+	if (row > max_first) row = max_first;
+	if (row < 0) row = 0;
+	m_first = row;
+}
+
+void VRListView::setCurrent(int item)
+{
+	m_current = item;
+
+	//the user is looking at or dragging the list, don't move it away
+	if (m_hover || m_scrolling)
+		return;
+
+	//keep the current item in view, the filtered list is sorted so we can search it
+	int row = item;
+	if (!m_filter.empty())
+	{
+		std::vector<int>::const_iterator it = std::lower_bound(m_filtered.begin(), m_filtered.end(), item);
+		if (it == m_filtered.end() || *it != item)
+			return;
+		row = it - m_filtered.begin();
+	}
+	//during playback the item leaves the window one step at a time, the list then
+	//only moves as far as needed instead of recentering on every step
+	if (row < m_first - m_rows || row >= m_first + 2 * m_rows)
+		scrollTo(row - m_rows / 2);
+	else if (row < m_first)
+		scrollTo(row);
+	else if (row >= m_first + m_rows)
+		scrollTo(row - m_rows + 1);
+}
+
+int VRListView::getSelection()
+{
+	return m_selection;
+}
+
+int VRListView::getCount()
+{
+	return (m_filter.empty()) ? m_labels.size() : m_filtered.size();
+}
+
+int VRListView::getItem(int row)
+{
+	return (m_filter.empty()) ? row : m_filtered[row];
+}
+
+int VRListView::getRow(double y)
+{
+	int row = (m_y + m_height - y) / m_rowHeight;
+	if (row < 0 || row >= m_rows)
+		return -1;
+	return row;
+}
+
+void VRListView::scrollToPosition(double y)
+{
+	double position = (m_y + m_height - y) / m_height;
+	if (position < 0) position = 0;
+	if (position > 1) position = 1;
+	scrollTo(position * (getCount() - m_rows) + 0.5);
+}
@@ -0,0 +1,50 @@
+#ifndef VRLISTVIEW_H
+#define VRLISTVIEW_H
+
+#include "VRMenuElement.h"
+#include "VRFontHandler.h"
+
+//Scrolling list which only lays out and draws the rows currently visible,
+//so the number of items does not change the cost of drawing or scrolling.
+class VRListView : public VRMenuElement {
+public:
+	VRListView(std::string name, int rows = 10);
+	virtual ~VRListView();
+
+	virtual void addToMenu(VRMenu * menu, double x, double y, double width, double height);
+	virtual void draw(RenderList &list);
+	virtual void resetHover();
+	virtual bool checkIntersect(MinVR::VRPoint3 &pt);
+	virtual void click(double x, double y, bool isDown);
+	virtual void updateMousePosition(double x, double y);
+
+	void addItem(std::string label, std::string info = "");
+	void clearItems();
+	void setFilter(std::string filter);
+	std::string getFilter();
+	void scrollTo(int row);
+	void setCurrent(int item);
+	int getSelection();
+
+private:
+	std::vector<std::string> m_labels;
+	std::vector<std::string> m_infos;
+	std::vector<int> m_filtered;
+	std::string m_filter;
+
+	int m_rows;
+	int m_first;
+	double m_rowHeight;
+	double m_scrollbarWidth;
+	int m_hoverRow;
+	int m_current;
+	int m_selection;
+	bool m_scrolling;
+
+	int getCount();
+	int getItem(int row);
+	int getRow(double y);
+	void scrollToPosition(double y);
+};
+
+#endif //VRLISTVIEW_H
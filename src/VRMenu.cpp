@@ -1,8 +1,5 @@
-#ifdef _WIN32
-#include <windows.h>
-#endif
-#include <GL/gl.h>
 #include <math.h>
+#include <string.h>
 #include "VRMenu.h"
 #include "VRFontHandler.h"
 #include "VRMenuElement.h"
@@ -11,7 +8,7 @@
 #define BORDER 0.002
 
 VRMenu::VRMenu(double width, double height, int col, int row, std::string title, double titleHeight) :m_width(width), m_height(height), m_col(col), m_row(row),
-m_hover(false), m_title(title), m_titleHeight(titleHeight), m_activeElement(NULL), m_isMouseDown(false)
+m_hover(false), m_visible(false), m_title(title), m_titleHeight(titleHeight), m_grid(col, row, width, height), m_activeElement(NULL), m_hoverElement(NULL), m_isMouseDown(false)
 {
 	m_col_width = width/col;
 	m_row_height = height / row;	
@@ -28,58 +25,54 @@ VRMenu::~VRMenu()
 	m_handlers.clear();
 }
 
-void VRMenu::draw()
+void VRMenu::draw(RenderList &list)
 {
 	if (m_visible)
 	{
-		GLint depth_funct;
-		glGetIntegerv(GL_DEPTH_FUNC, &depth_funct);
-		glDepthFunc(GL_LEQUAL);
-		glPushMatrix();
-		glMultMatrixf(m_transformation.getArray());
+		list.pushMatrix();
+		list.multMatrix(m_transformation.getArray());
 
-		glBegin(GL_QUADS);			
+		list.begin(RenderList::QUADS);			
 			// Draw A Quad		
 			if (m_hover)
 			{
-				glColor3f(1.0f, 1.0f, 1.0f);
+				list.color(1.0f, 1.0f, 1.0f);
 			}
 			else
 			{
-				glColor3f(1.0f, 1.0f, 1.0f);
+				list.color(1.0f, 1.0f, 1.0f);
 			}	
-			glVertex3f(-m_width*0.5, m_height + m_titleHeight, 0.0f);              // Top Left
-			glVertex3f(m_width*0.5, m_height + m_titleHeight, 0.0f);				// Top Right
-			glVertex3f(m_width*0.5, 0.0f, 0.0f);					// Bottom Right
-			glVertex3f(-m_width*0.5, 0.0f, 0.0f);              // Bottom Left
-		glEnd();
-
-		glColor3f(0.0f, 0.0, 0.0f);
-		glBegin(GL_LINE_STRIP);
+			list.vertex(-m_width*0.5, m_height + m_titleHeight, 0.0f);              // Top Left
+			list.vertex(m_width*0.5, m_height + m_titleHeight, 0.0f);				// Top Right
+			list.vertex(m_width*0.5, 0.0f, 0.0f);					// Bottom Right
+			list.vertex(-m_width*0.5, 0.0f, 0.0f);              // Bottom Left
+		list.end();
+
+		list.color(0.0f, 0.0, 0.0f);
+		list.begin(RenderList::LINE_STRIP);
 		// Draw A Quad
-		glVertex3f(-m_width*0.5, m_height + m_titleHeight, Z_OFFSET);              // Top Left
-		glVertex3f(m_width*0.5, m_height + m_titleHeight, Z_OFFSET);				// Top Right
-		glVertex3f(m_width*0.5, 0.0f, 0.001f);					// Bottom Right
-		glVertex3f(-m_width*0.5, 0.0f, 0.001f);              // Bottom Left
-		glVertex3f(-m_width*0.5, m_height + m_titleHeight, Z_OFFSET);              // Top Left
-		glEnd();
-
-		glColor3f(0.0f, 0.0, 0.0f);
-		glBegin(GL_LINES);
+		list.vertex(-m_width*0.5, m_height + m_titleHeight, Z_OFFSET);              // Top Left
+		list.vertex(m_width*0.5, m_height + m_titleHeight, Z_OFFSET);				// Top Right
+		list.vertex(m_width*0.5, 0.0f, 0.001f);					// Bottom Right
+		list.vertex(-m_width*0.5, 0.0f, 0.001f);              // Bottom Left
+		list.vertex(-m_width*0.5, m_height + m_titleHeight, Z_OFFSET);              // Top Left
+		list.end();
+
+		list.color(0.0f, 0.0, 0.0f);
+		list.begin(RenderList::LINES);
 		// Draw A Quad
-		glVertex3f(-m_width*0.5, m_height, Z_OFFSET);              // Top Left
-		glVertex3f(m_width*0.5, m_height, Z_OFFSET);				// Top Right
-		glEnd();
+		list.vertex(-m_width*0.5, m_height, Z_OFFSET);              // Top Left
+		list.vertex(m_width*0.5, m_height, Z_OFFSET);				// Top Right
+		list.end();
 
 		if (!m_title.empty())
-			VRFontHandler::getInstance()->renderTextBox(m_title, -m_width*0.5 + BORDER, m_height + BORDER, Z_OFFSET, m_width - 2.0 * BORDER, m_titleHeight - 2.0 * BORDER);
+			VRFontHandler::getInstance()->renderTextBox(list, m_title, -m_width*0.5 + BORDER, m_height + BORDER, Z_OFFSET, m_width - 2.0 * BORDER, m_titleHeight - 2.0 * BORDER);
 
 		for (std::vector<VRMenuElement*>::const_iterator it = m_elements.begin(); it != m_elements.end(); ++it)
 		{
-			(*it)->draw();
+			(*it)->draw(list);
 		}
-		glPopMatrix();
-		glDepthFunc(depth_funct);
+		list.popMatrix();
 	}
 }
 
@@ -88,13 +81,14 @@ VRMenuElement* VRMenu::intersect(MinVR::VRPoint3& position, MinVR::VRVector3& di
 	if (m_visible)
 	{
 		m_hover = false;
-		for (std::vector<VRMenuElement*>::const_iterator it = m_elements.begin(); it != m_elements.end(); ++it)
+		if (m_hoverElement)
 		{
-			(*it)->resetHover();
+			m_hoverElement->resetHover();
+			m_hoverElement = NULL;
 		}
 
-		MinVR::VRPoint3 pt = m_transformation.inverse() * position;
-		MinVR::VRVector3 dir = m_transformation.inverse() * direction;
+		MinVR::VRPoint3 pt = m_inverseTransformation * position;
+		MinVR::VRVector3 dir = m_inverseTransformation * direction;
 
 		distance = - pt.z / dir.z; 
 		m_interactionPoint = pt + dir * distance;
@@ -105,12 +99,15 @@ VRMenuElement* VRMenu::intersect(MinVR::VRPoint3& position, MinVR::VRVector3& di
 		}
 		else{
 			if (distance > 0 && distance < 1.0 && fabs(m_interactionPoint.x) <= m_width * 0.5 && m_interactionPoint.y >= 0 && m_interactionPoint.y <= m_height + m_titleHeight){
-				for (std::vector<VRMenuElement*>::const_iterator it = m_elements.begin(); it != m_elements.end(); ++it)
+				//only the elements covering the cell below the pointer can be hit
+				const std::vector<int> &candidates = m_grid.getElements(m_interactionPoint.x, m_interactionPoint.y);
+				for (std::vector<int>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
 				{
-					if ((*it)->checkIntersect(m_interactionPoint))
+					if (m_elements[*it]->checkIntersect(m_interactionPoint))
 					{
-						m_activeElement = *it;
-						return (*it);
+						m_activeElement = m_elements[*it];
+						m_hoverElement = m_activeElement;
+						return m_activeElement;
 					}
 				}
 				m_hover = true;
@@ -136,12 +133,17 @@ void VRMenu::addElement(VRMenuElement* element, int col, int row, int width, int
 	double el_x = -m_width * 0.5 + m_col_width * (col-1);
 	double el_y = m_height - m_row_height * (row + height - 1);//
 	element->addToMenu(this, el_x + BORDER, el_y + BORDER, m_col_width * width - 2.0f * BORDER, m_row_height * height - 2.0f * BORDER);
+	m_grid.addElement(m_elements.size(), col, row, width, height);
 	m_elements.push_back(element);
 }
 
 void VRMenu::setTransformation(MinVR::VRMatrix4& transformation)
 {
+	if (memcmp(m_transformation.getArray(), transformation.getArray(), 16 * sizeof(*transformation.getArray())) == 0)
+		return;
+
 	m_transformation = transformation;
+	m_inverseTransformation = m_transformation.inverse();
 }
 
 void VRMenu::setVisible(bool visible)
@@ -153,10 +155,20 @@ void VRMenu::setVisible(bool visible)
 			m_activeElement->click(m_interactionPoint.x, m_interactionPoint.y, false);
 			m_isMouseDown = false;
 		}
+		if (m_hoverElement)
+		{
+			m_hoverElement->resetHover();
+			m_hoverElement = NULL;
+		}
 		m_activeElement = NULL;
 	}
 }
 
+bool VRMenu::isVisible()
+{
+	return m_visible;
+}
+
 void VRMenu::sendEvent(VRMenuElement* element)
 {
 	for (std::vector<VRMenuHandler*>::const_iterator it = m_handlers.begin(); it != m_handlers.end(); ++it)
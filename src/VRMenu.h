@@ -2,6 +2,8 @@
 #define VRMENU_H
 
 #include <math/VRMath.h>
+#include "VRMenuGrid.h"
+#include "RenderList.h"
 
 class VRMenuElement;
 class VRMenuHandler;
@@ -11,13 +13,14 @@ public:
 	VRMenu(double width, double height, int col, int row, std::string title, double titleHeight = 0.05);
 	~VRMenu();
 
-	void draw();
+	void draw(RenderList &list);
 	VRMenuElement * intersect(MinVR::VRPoint3& position, MinVR::VRVector3& direction, double &distance);
 	void click(bool isDown);
 
 	void addElement(VRMenuElement * element, int col, int row, int width, int height);
 	void setTransformation(MinVR::VRMatrix4& transformation);
 	void setVisible(bool visible);
+	bool isVisible();
 	void sendEvent(VRMenuElement * element);
 	void addMenuHandler(VRMenuHandler * handler);
 
@@ -34,11 +37,14 @@ private:
 	bool m_visible;
 	bool m_hover;
 	MinVR::VRMatrix4 m_transformation;
+	MinVR::VRMatrix4 m_inverseTransformation;
 
 	std::vector<VRMenuElement *> m_elements;
+	VRMenuGrid m_grid;
 	std::vector<VRMenuHandler *> m_handlers;
 
 	VRMenuElement * m_activeElement;
+	VRMenuElement * m_hoverElement;
 	MinVR::VRPoint3 m_interactionPoint;
 	bool m_isMouseDown;
 };
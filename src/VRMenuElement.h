@@ -6,13 +6,14 @@
 #include <math/VRMath.h>
 
 #include "VRMenu.h"
+#include "RenderList.h"
 
 	class VRMenuElement {
 	public:
 		VRMenuElement(std::string name, std::string text = "");
 		virtual ~VRMenuElement();
 
-		virtual void draw() = 0;
+		virtual void draw(RenderList &list) = 0;
 		virtual void addToMenu(VRMenu * menu, double x, double y, double width, double height);
 		virtual void resetHover();
 		virtual void click(double x, double y, bool isDown){};
@@ -0,0 +1,45 @@
+#include <math.h>
+#include "VRMenuGrid.h"
+
+VRMenuGrid::VRMenuGrid(int col, int row, double width, double height) : m_col(col), m_row(row), m_width(width), m_height(height)
+{
+	m_col_width = width / col;
+	m_row_height = height / row;
+	m_cells.resize(col * row);
+}
+
+VRMenuGrid::~VRMenuGrid()
+{
+
+}
+
+void VRMenuGrid::addElement(int element, int col, int row, int width, int height)
+{
+	//col and row are 1-based like in VRMenu::addElement
+	for (int r = row - 1; r < row - 1 + height && r < m_row; r++)
+	{
+		for (int c = col - 1; c < col - 1 + width && c < m_col; c++)
+		{
+			if (r >= 0 && c >= 0)
+				m_cells[r * m_col + c].push_back(element);
+		}
+	}
+}
+
+const std::vector<int> & VRMenuGrid::getElements(double x, double y) const
+{
+	//x is relative to the menu center, y to the bottom of the element area
+	int c = floor((x + m_width * 0.5) / m_col_width);
+	int r = floor((m_height - y) / m_row_height);
+
+	if (c < 0 || c >= m_col || r < 0 || r >= m_row)
+		return m_empty;
+
+	return m_cells[r * m_col + c];
+}
+
+void VRMenuGrid::clear()
+{
+	for (std::vector<std::vector<int> >::iterator it = m_cells.begin(); it != m_cells.end(); ++it)
+		it->clear();
+}
@@ -0,0 +1,28 @@
+#ifndef VRMENUGRID_H
+#define VRMENUGRID_H
+
+#include <vector>
+
+//Maps the col/row layout of a VRMenu to the elements covering each cell,
+//so hit-testing only has to look at the elements under the pointer.
+class VRMenuGrid {
+public:
+	VRMenuGrid(int col, int row, double width, double height);
+	~VRMenuGrid();
+
+	void addElement(int element, int col, int row, int width, int height);
+	const std::vector<int> & getElements(double x, double y) const;
+	void clear();
+
+private:
+	int m_col;
+	int m_row;
+	double m_width, m_height;
+	double m_col_width;
+	double m_row_height;
+
+	std::vector<std::vector<int> > m_cells;
+	std::vector<int> m_empty;
+};
+
+#endif //VRMENUGRID_H
@@ -1,7 +1,3 @@
-#ifdef _WIN32
-#include <windows.h>
-#endif
-#include <GL/gl.h>
 
 #include "VRMultiLineTextBox.h"
 
@@ -15,21 +11,21 @@ VRMultiLineTextBox::~VRMultiLineTextBox()
 
 }
 
-void VRMultiLineTextBox::draw()
+void VRMultiLineTextBox::draw(RenderList &list)
 {
 	if (m_drawOutline){
 		// Draw Outline
-		glColor3f(0.0f, 0.0, 0.0f);
-		glBegin(GL_LINE_STRIP);
-		glVertex3f(m_x, m_y + m_height, Z_OFFSET);					// Top Left
-		glVertex3f(m_x + m_width, m_y + m_height, Z_OFFSET);		// Top Right
-		glVertex3f(m_x + m_width, m_y, Z_OFFSET);					// Bottom Right
-		glVertex3f(m_x, m_y, Z_OFFSET);							// Bottom Left
-		glVertex3f(m_x, m_y + m_height, Z_OFFSET);					// Top Left
-		glEnd();
+		list.color(0.0f, 0.0, 0.0f);
+		list.begin(RenderList::LINE_STRIP);
+		list.vertex(m_x, m_y + m_height, Z_OFFSET);					// Top Left
+		list.vertex(m_x + m_width, m_y + m_height, Z_OFFSET);		// Top Right
+		list.vertex(m_x + m_width, m_y, Z_OFFSET);					// Bottom Right
+		list.vertex(m_x, m_y, Z_OFFSET);							// Bottom Left
+		list.vertex(m_x, m_y + m_height, Z_OFFSET);					// Top Left
+		list.end();
 	}
 
-	VRFontHandler::getInstance()->renderMultiLineTextBox(m_multiLineText, m_x, m_y, Z_OFFSET, m_width, m_height, m_alignment);
+	VRFontHandler::getInstance()->renderMultiLineTextBox(list, m_multiLineText, m_x, m_y, Z_OFFSET, m_width, m_height, m_alignment);
 }
 
 void VRMultiLineTextBox::setText(std::vector<std::string> text)
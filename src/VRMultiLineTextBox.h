@@ -9,7 +9,7 @@ public:
 	VRMultiLineTextBox(std::string name, std::vector<std::string> text, VRFontHandler::TextAlignment alignment = VRFontHandler::CENTER);
 	virtual ~VRMultiLineTextBox();
 
-	virtual void draw();
+	virtual void draw(RenderList &list);
 
 	void setText(std::vector<std::string> text);
 
@@ -9,7 +9,7 @@ class VRTextBox : public VRMenuElement {
 		VRTextBox(std::string name, std::string text = "", VRFontHandler::TextAlignment alignment = VRFontHandler::CENTER);
 		virtual ~VRTextBox();
 
-		virtual void draw();
+		virtual void draw(RenderList &list);
 
 		void setText(std::string text);
 
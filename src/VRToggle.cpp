@@ -1,7 +1,3 @@
-#ifdef _WIN32
-#include <windows.h>
-#endif
-#include <GL/gl.h>
 #include "VRFontHandler.h"
 
 #include "VRToggle.h"
@@ -16,39 +12,39 @@ VRToggle::~VRToggle()
 
 }
 
-void VRToggle::draw()
+void VRToggle::draw(RenderList &list)
 {
-	glBegin(GL_QUADS);
+	list.begin(RenderList::QUADS);
 	// Draw A Quad
 	if (m_hover){
-		glColor3f(0.9f, 0.5f, 0.5f);
+		list.color(0.9f, 0.5f, 0.5f);
 	}
 	else if (m_isToggled)
 	{
-		glColor3f(0.9f, 0.0f, 0.0f);
+		list.color(0.9f, 0.0f, 0.0f);
 	}
 	else
 	{
-		glColor3f(1.0f, 1.0, 1.0f);
+		list.color(1.0f, 1.0, 1.0f);
 	}
-	glVertex3f(m_x, m_y + m_height, Z_OFFSET);              // Top Left
-	glVertex3f(m_x + m_width, m_y + m_height, Z_OFFSET);				// Top Right
-	glVertex3f(m_x + m_width, m_y, Z_OFFSET);					// Bottom Right
-	glVertex3f(m_x, m_y, Z_OFFSET);              // Bottom Left
-	glEnd();
+	list.vertex(m_x, m_y + m_height, Z_OFFSET);              // Top Left
+	list.vertex(m_x + m_width, m_y + m_height, Z_OFFSET);				// Top Right
+	list.vertex(m_x + m_width, m_y, Z_OFFSET);					// Bottom Right
+	list.vertex(m_x, m_y, Z_OFFSET);              // Bottom Left
+	list.end();
 
-	glColor3f(0.0f, 0.0, 0.0f);
-	glBegin(GL_LINE_STRIP);
+	list.color(0.0f, 0.0, 0.0f);
+	list.begin(RenderList::LINE_STRIP);
 	// Draw A Quad
-	glVertex3f(m_x, m_y + m_height, 2.0 * Z_OFFSET);					// Top Left
-	glVertex3f(m_x + m_width, m_y + m_height, 2.0 * Z_OFFSET);		// Top Right
-	glVertex3f(m_x + m_width, m_y, 2.0 * Z_OFFSET);					// Bottom Right
-	glVertex3f(m_x, m_y, 2.0 * Z_OFFSET);							// Bottom Left
-	glVertex3f(m_x, m_y + m_height, 2.0 * Z_OFFSET);					// Top Left
-	glEnd();
+	list.vertex(m_x, m_y + m_height, 2.0 * Z_OFFSET);					// Top Left
+	list.vertex(m_x + m_width, m_y + m_height, 2.0 * Z_OFFSET);		// Top Right
+	list.vertex(m_x + m_width, m_y, 2.0 * Z_OFFSET);					// Bottom Right
+	list.vertex(m_x, m_y, 2.0 * Z_OFFSET);							// Bottom Left
+	list.vertex(m_x, m_y + m_height, 2.0 * Z_OFFSET);					// Top Left
+	list.end();
 
 	if (!m_text.empty())
-		VRFontHandler::getInstance()->renderTextBox(m_text, m_x, m_y, 2.0*Z_OFFSET, m_width, m_height);
+		VRFontHandler::getInstance()->renderTextBox(list, m_text, m_x, m_y, 2.0*Z_OFFSET, m_width, m_height);
 }
 
 void VRToggle::click(double x, double y, bool isDown)
@@ -8,7 +8,7 @@ class VRToggle : public VRMenuElement {
 		VRToggle(std::string name, std::string text = "");
 		virtual ~VRToggle();
 
-		virtual void draw();
+		virtual void draw(RenderList &list);
 		virtual void click(double x, double y, bool isDown);
 
 		void setToggled(bool isToggled);
@@ -0,0 +1,82 @@
+#ifndef VIEWMODE_H
+#define VIEWMODE_H
+
+//Compile-time policies for the viewing modes. Picking, drawing and range selection
+//are templated on them, so the mode is chosen once at startup and the per-quad
+//loops do not have to test it. stride is the spacing of the frames of the active
+//temporal level, the ranges grow with it so the same number of frames is shown.
+
+//mode 0: the frames are stacked behind each other along z
+struct StackMode {
+	enum { showLimit = 7 };
+
+	static double zOffset(int setID, double zSpacing)
+	{
+		return -setID * zSpacing;
+	}
+
+	static void getVisibleRange(int current, int count, int stride, int &start, int &end)
+	{
+		start = current - showLimit * stride;
+		end = current + showLimit * stride;
+		clamp(count, start, end);
+	}
+
+	static void getPickRange(int current, int count, int stride, int maxRange, int &start, int &end)
+	{
+		start = current - maxRange * stride;
+		end = current + maxRange * stride;
+	}
+
+	static void clamp(int count, int &start, int &end)
+	{
+		if (start < 0)
+			start = 0;
+		if (end > count - 1)
+			end = count - 1;
+	}
+};
+
+//mode 1: all frames are drawn on top of each other
+struct OverlayMode {
+	static double zOffset(int setID, double zSpacing)
+	{
+		return 0;
+	}
+
+	static void getVisibleRange(int current, int count, int stride, int &start, int &end)
+	{
+		start = 0;
+		end = count - 1;
+	}
+
+	static void getPickRange(int current, int count, int stride, int maxRange, int &start, int &end)
+	{
+		start = 0;
+		end = count - 1;
+	}
+};
+
+//mode 2 and 3: only the current frame is drawn and played back as a movie
+struct MovieMode {
+	static double zOffset(int setID, double zSpacing)
+	{
+		return 0;
+	}
+
+	//the last frame of the level at or before the current one
+	static void getVisibleRange(int current, int count, int stride, int &start, int &end)
+	{
+		start = current - current % stride;
+		end = start;
+		StackMode::clamp(count, start, end);
+	}
+
+	static void getPickRange(int current, int count, int stride, int maxRange, int &start, int &end)
+	{
+		start = 0;
+		end = count - 1;
+	}
+};
+
+#endif //VIEWMODE_H
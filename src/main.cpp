@@ -1,17 +1,6 @@
 
-// OpenGL platform-specific headers
 #if defined(WIN32)
 #define NOMINMAX
-#include <windows.h>
-#include <GL/gl.h>
-#include <gl/GLU.h>
-#elif defined(__APPLE__)
-#include <OpenGL/OpenGL.h>
-#include <OpenGL/glu.h>
-#else
-#define GL_GLEXT_PROTOTYPES
-#include <GL/gl.h>
-#include <GL/glu.h>
 #endif
 
 
@@ -27,8 +16,30 @@
 #include "VRTextBox.h"
 #include "VRGraph.h"
 #include "VRToggle.h"
+#include "VRListView.h"
+#include "VREventDispatcher.h"
+#include "PickingWorker.h"
+#include "Hologram.h"
+#include "ViewMode.h"
+#include "Renderer.h"
+#include "DataSetLoader.h"
+#include "Traces.h"
+#include "Manifest.h"
+#include "TextureStreamer.h"
+#include "FrameLoader.h"
+#include "MoviePlayer.h"
+#include "FrameExporter.h"
+#include "EventLog.h"
+#ifdef HAVE_EGL
+#include "OffscreenContext.h"
+#endif
 using namespace MinVR;
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
 
@@ -42,17 +53,31 @@ using namespace MinVR;
 #define rad2deg (180.0/3.14159265)
 #define 	M_PI   3.14159265358979323846	/* pi */
 
-#define REPORTNAME "reportRaw_refined.xml"
 int skip_nth_Image = 1;
 double min_Z = 500;
 double max_Z = 25000;
 bool draw_Boundary = true;
 
-#define MOVIE_FPS_MODIFIER 1.0/6.0
+//frames per second of the movie, frames not loaded in time are waited for up to MOVIE_MAX_WAIT seconds
+#define MOVIE_FPS 10.0
+#define MOVIE_MAX_WAIT 0.25
+//frames read ahead of the playing movie
+#define MOVIE_DECODE_AHEAD 8
 #define LOAD_LIMIT 1000000000
-#define SHOW_LIMIT 7
-#define SCALE 200.0
-#define Z_SCALE 1.0 //10
+//pixels of streamed textures uploaded per frame
+#define TEXTURE_UPLOAD_BYTES (8 * 1024 * 1024)
+//quads of a temporal level which may be resident, coarser levels are used above it
+#define LEVEL_MAX_QUADS 2000000
+//frames passed per second before the next coarser level is used
+#define LEVEL_FRAMES_PER_SECOND 30.0
+//changes of the current frame larger than this are jumps through the list, graph or movie loop
+#define LEVEL_JUMP_FRAMES 256
+//seconds the speed has to stay low before a finer level is used
+#define LEVEL_SETTLE_SECONDS 1.0
+//quads read from the manifest per frame while a level is filled in
+#define LEVEL_LOAD_QUADS 50000
+//frames a trace reaches back, including the current one
+#define TRACE_LENGTH 20
 #define MOVE_SCALE 5.0f;
 
 
@@ -63,24 +88,6 @@ bool draw_Boundary = true;
 #define RATIO_P_TO_UM 1024.0f / SCALE / SCREEN_TO_SOURCE * PIXEL_SIZE 
 
 
-#ifdef _MSC_VER
-	#define slash "\\"
-#else
-	#define slash "/"
-	#include <dirent.h>
-#endif
-
-struct hologram {
-	float vertices[4][3];
-	unsigned int texture;
-	float esd;
-	float esv;
-	std::string type;
-	int setID;
-	int ID;
-};
-
-
 int mode = 0;
 bool show_menu = 0;
 bool move_menu = 1;
@@ -90,241 +97,63 @@ bool play = false;
 bool trace = false;
 float frame_strength = 1.0;
 
-struct DataSet
-{
-	std::vector <hologram> quads;
-	std::vector <cv::Mat> opencvImages;
-	std::vector <std::string> value_names;
-	std::vector <std::string> values;
-	int id;
-	std::string filename;
-};
-
 std::vector <DataSet> data;
+std::vector <HologramTexture> hologramTextures;
+BufferPool imageBuffers;
 
-int getContourByID(int frame, int contourID)
+//data index paths of a controller, built once instead of on every event
+struct ControllerPaths
 {
-	if (frame < 0 || frame >= data.size())
-		return -1;
-
-	for (int i = 0; i < data[frame].quads.size(); i++)
-	{
-		if (data[frame].quads[i].ID == contourID)
-			return i;
-	}
-
-	return -1;
-}
+	std::string pose;
+	std::string axis1ButtonPressed;
+	std::string axis0XPos;
+	std::string axis0YPos;
+};
 
-std::istream& safeGetline(std::istream& is, std::string& t)
+//everything the view callbacks need which does not depend on the eye or wall,
+//built once per frame in onVRRenderGraphicsContext
+struct FramePacket
 {
-	t.clear();
-
-	// The characters in the stream are read one-by-one using a std::streambuf.
-	// That is faster than reading them one-by-one using the std::istream.
-	// Code that uses streambuf this way must be guarded by a sentry object.
-	// The sentry object performs various tasks,
-	// such as thread synchronization and updating the stream state.
-
-	std::istream::sentry se(is, true);
-	std::streambuf* sb = is.rdbuf();
-
-	for (;;)
-	{
-		int c = sb->sbumpc();
-		switch (c)
-		{
-		case '\n':
-			return is;
-		case '\r':
-			if (sb->sgetc() == '\n')
-				sb->sbumpc();
-			return is;
-		case EOF:
-			// Also handle the case when the last line has no line ending
-			if (t.empty())
-			{
-				is.setstate(std::ios::eofbit);
-			}
-			return is;
-		default:
-			t += (char)c;
-		}
-	}
-}
+	int start;
+	int end;
+	int traceFrame;
+	std::vector <float> traceVertices;
+	std::vector <RenderInstance> boundaries;
+	std::vector <std::string> hoverText;
+	bool measure;
+	float measureVertices[6];
+	std::string measureText;
+	bool textFacing;
+	RenderList scene;
+};
 
-std::vector<string> ReadSubDirectories(const std::string &refcstrRootDirectory)
+//the headless export, given as --export <movie or camera path> <output> [width height fps]
+struct ExportOptions
 {
-	std::vector<string> subdirectories;
-	
-#ifdef _MSC_VER
-	// subdirectories have been found
-	HANDLE          hFile;                       // Handle to directory
-	std::string     strFilePath;                 // Filepath
-	std::string     strPattern;                  // Pattern
-	WIN32_FIND_DATA FileInformation;             // File information
-
-
-	strPattern = refcstrRootDirectory + slash + "*.*";
-	hFile = ::FindFirstFile(strPattern.c_str(), &FileInformation);
-	if (hFile != INVALID_HANDLE_VALUE)
-	{
-		do
-		{
-			if (FileInformation.cFileName[0] != '.')
-			{
-				strFilePath.erase();
-				strFilePath = refcstrRootDirectory + slash + FileInformation.cFileName;
-
-				if (FileInformation.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-				{
-					// Delete subdirectory
-					subdirectories.push_back(FileInformation.cFileName);
-				}
-			}
-		} while (::FindNextFile(hFile, &FileInformation) == TRUE);
-
-		// Close handle
-		::FindClose(hFile);
-	}
-#else
-	DIR *dir;
-	struct dirent *entry;
-	char path[256];
-
-	dir = opendir(refcstrRootDirectory.c_str());
-	if (dir == NULL) {
-		return subdirectories;
-	}
-
-	while ((entry = readdir(dir)) != NULL) {
-		if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..")) {
-			if (entry->d_type == DT_DIR) {
-				subdirectories.push_back(std::string(entry->d_name));
-			}
-		}
-	}
-	closedir(dir);
-
-#endif
-	std::sort(subdirectories.begin(), subdirectories.end());
-	return subdirectories;
-}
+	std::string source;
+	std::string output;
+	int width;
+	int height;
+	double fps;
+};
 
-void addHologram(float x, float y, float z, float width, float height, std::string filename, double esd, double esv, std::string type, DataSet &set, int ID)
+//a key of a camera path: the viewer position in data coordinates and its rotation around y in degrees
+struct CameraKey
 {
-	hologram q;
-	q.vertices[0][0] = (x - width / 2) / SCALE;
-	q.vertices[0][1] = -(y + height / 2) / SCALE;
-	q.vertices[0][2] = (-z + min_Z) / SCALE / Z_SCALE;
-
-	q.vertices[1][0] = (x + width / 2) / SCALE;
-	q.vertices[1][1] = -(y + height / 2) / SCALE;
-	q.vertices[1][2] = (-z + min_Z) / SCALE / Z_SCALE;
-
-	q.vertices[2][0] = (x + width / 2) / SCALE;
-	q.vertices[2][1] = -(y - height / 2) / SCALE;
-	q.vertices[2][2] = (-z + min_Z) / SCALE / Z_SCALE;
-
-	q.vertices[3][0] = (x - width / 2) / SCALE;
-	q.vertices[3][1] = -(y - height / 2) / SCALE;
-	q.vertices[3][2] = (-z + min_Z) / SCALE / Z_SCALE;
-
-	q.esd = esd;
-	q.esv = esv;
-	q.type = type;
-	q.setID = set.id;
-	q.ID = ID;
-	set.quads.push_back(q);
-
-	cv::Mat image_orig = cv::imread(filename, cv::IMREAD_COLOR);
-	cv::Mat image_transparent = cv::Mat(image_orig.rows, image_orig.cols, CV_8UC4);
-
-	for (int i = 0; i < image_orig.rows; i++)
-	{
-		for (int j = 0; j < image_orig.cols; j++)
-		{
-			uchar val = image_orig.at<cv::Vec3b>(i, j)[0];
-			image_transparent.at<cv::Vec4b>(i, j)[0] = val;
-			image_transparent.at<cv::Vec4b>(i, j)[1] = val;
-			image_transparent.at<cv::Vec4b>(i, j)[2] = val;
-			if (image_orig.at<cv::Vec3b>(i, j)[2] != image_orig.at<cv::Vec3b>(i, j)[0])
-			{
-				image_transparent.at<cv::Vec4b>(i, j)[3] = 0;
-			}
-			else
-			{
-				image_transparent.at<cv::Vec4b>(i, j)[3] = 255;
-			}
-		}
-	}
-	set.opencvImages.push_back(image_transparent);
-}
+	double time;
+	float position[3];
+	float yaw;
+};
 
-void loadDataSet(std::string parentFolder, std::string folder, int id)
+//sorts the frames to load so the one closest to the current frame is first
+struct FrameDistance
 {
-	DataSet set;
-	std::string reportName = parentFolder + slash + folder + slash + REPORTNAME;
-	tinyxml2::XMLDocument doc;
-	if (doc.LoadFile(reportName.c_str()) == tinyxml2::XML_SUCCESS){
-		tinyxml2::XMLElement* titleElement;
-		titleElement = doc.FirstChildElement("doc")->FirstChildElement("DATA");
-
-		set.id = id;
-		set.filename = folder;
-		set.value_names.push_back("NB Particles detected");
-		set.values.push_back(titleElement->FirstChildElement("NBCONTOURS")->GetText());
-
-		//Load values
-		std::ifstream fin(parentFolder + slash + folder + slash + "data" + slash + folder.substr(0, folder.rfind(".")) + ".txt");
-		if (fin.good())
-		{
-			std::istringstream in;
-			std::string line;
-			std::string s;
-			int count = 0;
-			while (!safeGetline(fin, line).eof())
-			{
-				in.clear();
-				in.str(line);
-				std::vector<std::string> tmp;
-				while (getline(in, s, ' ')) {
-					tmp.push_back(s);
-				}
-
-				if (tmp.size() == 2)
-				{
-					set.value_names.push_back(tmp[0]);
-					set.values.push_back(tmp[1]);
-				}
-				line.clear();
-				tmp.clear();
-				count++;
-			}
-			fin.close();
-		}
-
-		for (tinyxml2::XMLElement* child = titleElement->FirstChildElement("ROI"); child != NULL; child = child->NextSiblingElement())
-		{
-			// do something with each child element
-			addHologram(std::atof(child->FirstChildElement("X")->GetText()),
-						std::atof(child->FirstChildElement("Y")->GetText()),
-						std::atof(child->FirstChildElement("DEPTH")->GetText()),
-						std::atof(child->FirstChildElement("WIDTH")->GetText()),
-						std::atof(child->FirstChildElement("HEIGHT")->GetText()),
-						parentFolder + slash + folder + slash + child->FirstChildElement("IMAGE")->GetText(),
-						std::atof(child->FirstChildElement("ESD")->GetText()), 
-						std::atof(child->FirstChildElement("ESV")->GetText()), 
-						"Diatom",
-						set,
-						std::atof(child->FirstChildElement("CONTOUR")->GetText()));
-		}
-		set.values[0] = std::to_string(set.quads.size());
+	float current;
+	bool operator()(int a, int b) const
+	{
+		return std::fabs(a - current) < std::fabs(b - current);
 	}
-	
-
-	data.push_back(set);
-}
+};
 
 /** MyVRApp is a subclass of VRApp and overrides two key methods: 1. onVREvent(..)
     and 2. onVRRenderGraphics(..).  This is all that is needed to create a
@@ -333,7 +162,7 @@ void loadDataSet(std::string parentFolder, std::string folder, int id)
  */
 class MyVRApp : public VRApp, VRMenuHandler {
 public:
-	MyVRApp(int argc, char** argv, const std::string& configFile) : currentSet(0), VRApp(argc, argv), texturesloaded(false), movement_y(0.0), movement_x(0.0), currentMenu(0), hoverHologram(NULL), menuVisible(false), measuring(false), measureSet(false){
+	MyVRApp(int argc, char** argv, const std::string& configFile) : currentSet(0), VRApp(argc, argv), texturesloaded(false), movement_y(0.0), movement_x(0.0), currentMenu(0), hoverHologram(NULL), hoverSetID(0), menuVisible(false), measuring(false), measureSet(false), ctd_data_graph_overlay(NULL), ctd_data_graph_scatter(NULL), ctd_data_graph_axis(NULL), menusDirty(false), pickDirty(false), renderer(NULL), textureBytes(0), rgbaTextureBytes(0), texturesStreaming(false), textureStreamer(imageBuffers), frameLoader(manifest), level(0), minLevel(0), frameSpeed(0), levelSet(0), framesArrived(false), pickFramesDirty(false), player(MOVIE_FPS, MOVIE_MAX_WAIT, MOVIE_DECODE_AHEAD){
 		if (argc >= 5)
 		{
 			mode = stoi(argv[4]);
@@ -354,6 +183,11 @@ public:
 		{
 			frame_strength = stof(argv[8]);
 		}
+		if (argc >= 10)
+		{
+			//"core" or "legacy", by default core is used if the context supports it
+			rendererName = argv[9];
+		}
 		if (mode == 3)
 		{
 			mode = 2;
@@ -383,26 +217,91 @@ public:
 			play = true;
 		}
 
+		if (mode == 0)
+		{
+			selectViewMode<StackMode>();
+		}
+		else if (mode == 1)
+		{
+			selectViewMode<OverlayMode>();
+		}
+		else
+		{
+			selectViewMode<MovieMode>();
+		}
+		framePacket.start = 0;
+		framePacket.end = -1;
+		framePacket.traceFrame = -1;
+		framePacket.measure = false;
+		framePacket.textFacing = false;
+
 		menupose = VRMatrix4::translation(VRVector3(-1, 0.9, 0)) * VRMatrix4::rotationY(M_PI / 2);
-		std::vector<std::string> subdirs = ReadSubDirectories(argv[3]);
-		for (int i = 0; i < subdirs.size() && i < LOAD_LIMIT; i++){
-			if (i % skip_nth_Image == 0){
-				std::cerr << "Load " << subdirs[i] << std::endl;
-				loadDataSet(argv[3], subdirs[i], i);
-			}
+		//a manifest written by an earlier run replaces reading the reports, the quads and
+		//pixels of the frames of the active temporal level are read when it is chosen
+		std::string dataPath = argv[3];
+		ManifestKey manifestKey = getManifestKey(dataPath, min_Z, skip_nth_Image, LOAD_LIMIT);
+		if (manifest.open(dataPath, manifestKey))
+		{
+			manifest.getFrames(data);
+			resident.assign(data.size(), 0);
+			level = -1;
+			std::cerr << "Read " << data.size() << " frames and " << manifest.getLevelCount() << " levels from the manifest" << std::endl;
+		}
+		else
+		{
+			//the levels are only known from a manifest, so it is opened after writing it
+			std::vector<TextureLocation> locations;
+			loadData(dataPath, locations);
+			resident.assign(data.size(), 1);
+			if (Manifest::write(dataPath, manifestKey, data, hologramTextures, locations))
+				manifest.open(dataPath, manifestKey);
 		}
+		openLevels();
 
-		centerHologram(data[0]);
+		if (!data.empty())
+			centerHologram(data[0]);
 		computeHologramSize();
+		computeDataColumns();
+		buildPickFrames();
+		pickingWorker.start(pickFunction);
+		publishPickSnapshot();
 		currentSet = 0;
 		graph_currentValue = 0;
+		graph_scatterValue = 0;
 		createMenu();
+		registerEventHandlers();
     	}
 
     virtual ~MyVRApp()
 	{
 		for (std::vector<VRMenu*>::const_iterator it = menus.begin(); it != menus.end(); ++it)
 			delete (*it);
+		delete renderer;
+	}
+
+	//locations gets where the texture caches of the loader are
+	void loadData(const std::string &dataPath, std::vector<TextureLocation> &locations)
+	{
+		//the data folder or a tar, tar.gz or zip archive of it
+		DataRoot *root = DataRoot::open(dataPath, imageBuffers);
+		if (root == NULL)
+		{
+			std::cerr << "Could not open " << dataPath << std::endl;
+			exit(1);
+		}
+		std::vector<std::string> subdirs = root->getSubDirectories();
+		DataSetLoader loader(min_Z, hologramTextures, imageBuffers, *root);
+		for (int i = 0; i < subdirs.size() && i < LOAD_LIMIT; i++){
+			if (i % skip_nth_Image == 0){
+				std::cerr << "Load " << subdirs[i] << std::endl;
+				DataSet set;
+				loader.loadDataSet(subdirs[i], i, set);
+				data.push_back(set);
+			}
+		}
+		loader.printStatistics();
+		locations = loader.getTextureLocations();
+		delete root;
 	}
 
 	void createMenu()
@@ -449,22 +348,50 @@ public:
 		ctd_data_graph_menu->addElement(ctd_data_graph_ValueName, (mode != 2) ? 2 : 1, (mode != 2) ? 1 : 2, (mode != 2) ? 5 : 7, 1);
 		ctd_data_graph_menu->addElement(ctd_data_graph_currentValue, 1, (mode != 2) ? 2 : 3, 7, 1);
 
-		ctd_data_graph_graph = new VRGraph("ctd_data_graph_graph", getDataFromHologram(graph_currentValue), (mode!=2));
+		const float colors[][3] = { { 0.0f, 0.0f, 0.0f }, { 0.8f, 0.0f, 0.0f }, { 0.0f, 0.6f, 0.0f }, { 0.0f, 0.0f, 0.8f }, { 0.8f, 0.5f, 0.0f }, { 0.6f, 0.0f, 0.6f }, { 0.0f, 0.6f, 0.6f } };
+		ctd_data_graph_graph = new VRGraph("ctd_data_graph_graph", std::vector<double>(), (mode!=2));
+		ctd_data_graph_graph->setSeries(ctd_columns, colors, 7);
+		ctd_data_graph_graph->setActiveSeries(graph_currentValue);
 		ctd_data_graph_graph->setCurrent(currentSet);
 		ctd_data_graph_menu->addElement(ctd_data_graph_graph, 1, (mode != 2) ? 3 : 4, 7, (mode != 2) ? 7 : 6);
+
+		if (mode != 2)
+		{
+			ctd_data_graph_overlay = new VRToggle("ctd_data_graph_overlay", "Overlay");
+			ctd_data_graph_menu->addElement(ctd_data_graph_overlay, 1, 10, 3, 1);
+			ctd_data_graph_scatter = new VRToggle("ctd_data_graph_scatter", "Scatter");
+			ctd_data_graph_menu->addElement(ctd_data_graph_scatter, 4, 10, 3, 1);
+			ctd_data_graph_axis = new VRButton("ctd_data_graph_axis", "X");
+			ctd_data_graph_menu->addElement(ctd_data_graph_axis, 7, 10, 1, 1);
+		}
 		menus.push_back(ctd_data_graph_menu);
 
 		ctd_data_graph_menu->addMenuHandler(this);
+
+		VRMenu * frames_menu = new VRMenu(0.5, 0.5, 1, 10, "Frames");
+		frames_list = new VRListView("frames_list", 12);
+		for (int i = 0; i < data.size(); i++)
+		{
+			//frames read from the manifest have no quads until their level is loaded
+			int quads = (manifest.isOpen()) ? manifest.getQuadCount(i) : data[i].quads.size();
+			frames_list->addItem(data[i].filename, std::to_string(quads));
+		}
+		frames_list->setCurrent(currentSet);
+		frames_menu->addElement(frames_list, 1, 1, 1, 10);
+		menus.push_back(frames_menu);
+
+		frames_menu->addMenuHandler(this);
 	}
 
-	void drawMenus()
+	void drawMenus(RenderList &list)
 	{
 		for (std::vector<VRMenu*>::const_iterator it = menus.begin(); it != menus.end(); ++it)
-			(*it)->draw();
+			(*it)->draw(list);
 	}
 
 	void updateMenus()
 	{
+		menusDirty = false;
 		for (std::vector<VRMenu*>::const_iterator it = menus.begin(); it != menus.end(); ++it)
 			(*it)->setTransformation(menupose);
 
@@ -473,6 +400,8 @@ public:
 
 		double distance;
 		for (std::vector<VRMenu*>::const_iterator it = menus.begin(); it != menus.end(); ++it){
+			if (!(*it)->isVisible())
+				continue;
 			(*it)->intersect(pos, dir, distance);
 		}
 	}
@@ -502,95 +431,124 @@ public:
 		}
 	}
 
+	void buildPickFrames()
+	{
+		pickFrames.resize(data.size());
+		for (int i = 0; i < data.size(); i++)
+			updatePickFrame(i);
+	}
+
+	//the picking thread works on its own copy of the quad bounds, only the frame which
+	//changed is copied again
+	void updatePickFrame(int frame)
+	{
+		std::vector<PickQuad> quads(data[frame].quads.size());
+		for (int i = 0; i < data[frame].quads.size(); i++){
+			const hologram &quad = data[frame].quads[i];
+			PickQuad &q = quads[i];
+			q.z = quad.center[2];
+			//quads without a texture keep their index but can't be hit, min > max
+			if (data[frame].textures[i] < 0){
+				q.xmin = q.ymin = 1.0f;
+				q.xmax = q.ymax = -1.0f;
+				continue;
+			}
+			q.xmin = quad.xmin();
+			q.xmax = quad.xmax();
+			q.ymin = quad.ymin();
+			q.ymax = quad.ymax();
+		}
+		pickFrames[frame] = HologramSnapshot::createFrame(data[frame].id, quads);
+		pickFramesDirty = true;
+	}
+
+	//a new snapshot shares the frames of the previous one, so this only copies pointers
+	void publishPickSnapshot()
+	{
+		if (!pickFramesDirty)
+			return;
+		std::shared_ptr<HologramSnapshot> snapshot(new HologramSnapshot());
+		for (int i = 0; i < pickFrames.size(); i++)
+			snapshot->addFrame(pickFrames[i]);
+		pickSnapshot = snapshot;
+		pickingWorker.setSnapshot(pickSnapshot);
+		pickFramesDirty = false;
+	}
+
+	void getPickRay(float pos[3], float dir[3])
+	{
+		VRPoint3 p = roompose.inverse() * controllerpose * VRPoint3(0, 0, 0);
+		VRVector3 d = roompose.inverse() * controllerpose * VRVector3(0, 0, -5);
+		for (int k = 0; k < 3; k++){
+			pos[k] = p[k];
+			dir[k] = d[k];
+		}
+	}
+
+	template <class Mode> void selectViewMode()
+	{
+		//everything depending on the mode in the per-frame and per-quad loops is resolved here once
+		recordSceneFunction = &MyVRApp::recordScene<Mode>;
+		pickFunction = &pickHologram<Mode>;
+		pickRangeFunction = &Mode::getPickRange;
+		visibleRangeFunction = &Mode::getVisibleRange;
+		zOffsetFunction = &Mode::zOffset;
+	}
+
+	void getPickRange(int maxRange, int &start, int &end)
+	{
+		pickRangeFunction(currentSet, data.size(), getStride(), maxRange, start, end);
+	}
+
 	void setMeasurePoint(bool setStart)
 	{
 		if (setStart)
 		{
 			measureSet = false;
 		}
-		VRPoint3 pos = roompose.inverse() * controllerpose * VRPoint3(0, 0, 0);
-		VRVector3 dir = roompose.inverse() * controllerpose * VRVector3(0, 0, -5);
 
-		int maxRange = 0;
-		
-		int start = currentSet - maxRange;
-		int end = currentSet + maxRange;
-		if (mode != 0)
+		PickHit hit;
+		float pos[3], dir[3];
+		int start, end;
+		getPickRay(pos, dir);
+		getPickRange(0, start, end);
+		if (pickFunction(*pickSnapshot, pos, dir, start, end, hologramSize[2], 5, hit))
 		{
-			start = 0;
-			end = data.size() - 1;
-		}
-		
-		if (start < 0)
-			start = 0;
-		if (end > data.size() - 1)
-			end = data.size() - 1;
-
-		double distance = 5;
-
-		for (int i = start; i <= end; i++){
-			for (std::vector<hologram>::iterator it = data[i].quads.begin(); it != data[i].quads.end(); ++it){
-				double z = (mode == 0) ? it->vertices[0][2] - it->setID * hologramSize[2] : it->vertices[0][2];
-				double d = (z - pos.z) / dir.z;
-
-				if (d > 0 && d < distance){
-					MinVR::VRPoint3 m_interactionPoint = pos + dir * d;
-					if (m_interactionPoint.x >= it->vertices[0][0]
-						&& m_interactionPoint.y >= it->vertices[1][1]
-						&& m_interactionPoint.x <= it->vertices[1][0]
-						&& m_interactionPoint.y <= it->vertices[2][1])
-					{
-						distance = d;
-						if (setStart)startMeasure = m_interactionPoint;
-						endMeasure = m_interactionPoint;
-						measureSet = true;
-					}
-				}
-			}
+			if (setStart)startMeasure = VRPoint3(hit.point[0], hit.point[1], hit.point[2]);
+			endMeasure = VRPoint3(hit.point[0], hit.point[1], hit.point[2]);
+			measureSet = true;
 		}
 	}
 
-	void checkHologramIntersect()
+	void submitPicking()
 	{
-		hoverHologram = NULL;
-		VRPoint3 pos = roompose.inverse() * controllerpose * VRPoint3(0, 0, 0);
-		VRVector3 dir = roompose.inverse() * controllerpose * VRVector3(0, 0, -5);
+		PickRequest request;
+		getPickRay(request.pos, request.dir);
+		getPickRange(10.0f / hologramSize[2], request.hoverStart, request.hoverEnd);
+		getPickRange(0, request.measureStart, request.measureEnd);
+		request.measure = measuring;
+		request.zSpacing = hologramSize[2];
+		pickingWorker.submit(request);
+	}
 
-		int maxRange = 10.0f / hologramSize[2];
-		int start = currentSet - maxRange;
-		int end = currentSet + maxRange;
+	void updatePicking()
+	{
+		PickResult result;
+		if (!pickingWorker.getResult(result))
+			return;
 
-		if (mode != 0)
+		//the result may be for quads which were unloaded with a change of the level
+		hoverHologram = NULL;
+		if (result.hoverHit && result.hover.frame >= 0 && result.hover.frame < data.size()
+			&& result.hover.quad >= 0 && result.hover.quad < data[result.hover.frame].quads.size())
 		{
-			start = 0;
-			end = data.size() - 1;
+			hoverHologram = &data[result.hover.frame].quads[result.hover.quad];
+			hoverSetID = data[result.hover.frame].id;
 		}
-
-
-		if (start < 0) 
-			start = 0;
-		if (end > data.size() - 1)
-			end = data.size() - 1;
-
-		double distance = 5;
-
-		for (int i = start; i <= end; i++){
-			for (std::vector<hologram>::iterator it = data[i].quads.begin(); it != data[i].quads.end(); ++it){
-				double z = (mode == 0) ? it->vertices[0][2] - it->setID * hologramSize[2] : it->vertices[0][2];
-				double d = (z - pos.z) / dir.z;
-
-				if (d > 0 && d < distance){
-					MinVR::VRPoint3 m_interactionPoint = pos + dir * d;
-					if (m_interactionPoint.x >= it->vertices[0][0] 
-						&& m_interactionPoint.y >= it->vertices[1][1]
-						&& m_interactionPoint.x <= it->vertices[1][0]
-						&& m_interactionPoint.y <= it->vertices[2][1] )
-					{
-						distance = d;
-						hoverHologram = &(*it);
-					}
-				}
-			}
+		if (measuring && result.measure && result.measureHit)
+		{
+			endMeasure = VRPoint3(result.measurePoint.point[0], result.measurePoint.point[1], result.measurePoint.point[2]);
+			measureSet = true;
 		}
 	}
 
@@ -613,6 +571,14 @@ public:
 		return data_out;
 	}
 
+	void computeDataColumns()
+	{
+		//graph series are built once, switching the displayed value does not touch the datasets
+		ctd_columns.clear();
+		for (int i = 0; i < data[0].value_names.size(); i++)
+			ctd_columns.push_back(getDataFromHologram(i));
+	}
+
 	bool startsWith(std::string string1, std::string string2)
 	{
 		if (strlen(string1.c_str()) < strlen(string2.c_str())) return false;
@@ -624,101 +590,245 @@ public:
 		return (T(0) < val) - (val < T(0));
 	}
 
+	// Fills the dispatch table with the handler of every event name onVREvent reacts to
+	// and resolves the data paths of the controllers once, instead of per event
+	void registerEventHandlers()
+	{
+		leftPaths = resolveControllerPaths("HTC_Controller_Left");
+		rightPaths = resolveControllerPaths("HTC_Controller_Right");
+
+		eventDispatcher.registerHandler("HTC_Controller_Left", &MyVRApp::onLeftController);
+		eventDispatcher.registerHandler("HTC_Controller_Right", &MyVRApp::onRightController);
+		eventDispatcher.registerHandler("HTC_Controller_Right_Axis1Button_Pressed", &MyVRApp::onRightAxis1ButtonPressed);
+		eventDispatcher.registerHandler("HTC_Controller_Right_Axis1Button_Released", &MyVRApp::onRightAxis1ButtonReleased);
+		eventDispatcher.registerHandler("HTC_Controller_Left_Axis1Button_Pressed", &MyVRApp::onLeftAxis1ButtonPressed);
+		eventDispatcher.registerHandler("HTC_Controller_Left_Axis1Button_Released", &MyVRApp::onLeftAxis1ButtonReleased);
+		eventDispatcher.registerHandler("HTC_Controller_Right_AButton_Pressed", &MyVRApp::onRightAButtonPressed);
+		if (mode == 2)
+			eventDispatcher.registerHandler("HTC_Controller_Right_ApplicationMenuButton_Pressed", &MyVRApp::onRightApplicationMenuButtonPressed);
+		eventDispatcher.registerHandler("KbdEsc_Down", &MyVRApp::onEscape);
+		eventDispatcher.registerHandler("KbdBackspace_Down", &MyVRApp::onBackspace);
+		eventDispatcher.setDefaultHandler(&MyVRApp::onKeyboard);
+	}
+
+	ControllerPaths resolveControllerPaths(const std::string &device)
+	{
+		ControllerPaths paths;
+		paths.pose = "/" + device + "/Pose";
+		paths.axis1ButtonPressed = "/" + device + "/State/Axis1Button_Pressed";
+		paths.axis0XPos = "/" + device + "/State/Axis0/XPos";
+		paths.axis0YPos = "/" + device + "/State/Axis0/YPos";
+		return paths;
+	}
+
 	// Callback for event handling, inherited from VRApp
 	virtual void onVREvent(const VREvent &event) {
-		if (event.getName() == "HTC_Controller_Left")
+		if (eventRecorder.isOpen())
+			recordEvent(event);
+		eventDispatcher.dispatch(this, event.getName(), event);
+	}
+
+	bool startRecording(const std::string &filename)
+	{
+		recordStart = std::chrono::steady_clock::now();
+		return eventRecorder.open(filename);
+	}
+
+	//the data index paths of any event, resolved once per name
+	const ControllerPaths & getEventPaths(const std::string &name)
+	{
+		std::unordered_map<std::string, ControllerPaths>::iterator it = recordPaths.find(name);
+		if (it == recordPaths.end())
+			it = recordPaths.insert(std::make_pair(name, resolveControllerPaths(name))).first;
+		return it->second;
+	}
+
+	//keeps the fields of the data index the handlers read
+	void recordEvent(const VREvent &event)
+	{
+		EventRecord record;
+		record.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - recordStart).count();
+		record.frame = false;
+		record.name = event.getName();
+		record.fields = 0;
+
+		const ControllerPaths &paths = getEventPaths(record.name);
+		VRDataIndex * index = event.getInternal()->getDataIndex();
+		if (index->exists(paths.pose))
 		{
-			if (event.getInternal()->getDataIndex()->exists("/HTC_Controller_Left/Pose")){
-				if (!move_menu){
-					menupose = event.getDataAsFloatArray("Pose");
-					menupose = menupose *  VRMatrix4::translation(VRVector3(0, -0.2, 0));
-				}
-				updateMenus();
-			}
+			const float *pose = event.getDataAsFloatArray("Pose");
+			std::copy(pose, pose + 16, record.pose);
+			record.fields |= EventRecord::POSE;
 		}
-
-		if (event.getName() == "HTC_Controller_Right_Axis1Button_Pressed"){
-			clickMenus(true);
-			setMeasurePoint(true);
-			measuring = true;
+		if (index->exists(paths.axis1ButtonPressed))
+		{
+			record.axis1Button = (int) index->getValue(paths.axis1ButtonPressed);
+			record.fields |= EventRecord::AXIS1_BUTTON;
 		}
-		if (event.getName() == "HTC_Controller_Right_Axis1Button_Released"){
-			clickMenus(false);
-			measuring = false;
+		if (index->exists(paths.axis0XPos))
+		{
+			record.axis0X = (float) index->getValue(paths.axis0XPos);
+			record.fields |= EventRecord::AXIS0_X;
 		}
-		if (event.getName() == "HTC_Controller_Left_Axis1Button_Pressed"){
-			displayMenu(currentMenu);
-			if (move_menu) updateMenus();
+		if (index->exists(paths.axis0YPos))
+		{
+			record.axis0Y = (float) index->getValue(paths.axis0YPos);
+			record.fields |= EventRecord::AXIS0_Y;
 		}
-		if (event.getName() == "HTC_Controller_Left_Axis1Button_Released"){
-			if (!move_menu) displayMenu(-1);
+		eventRecorder.write(record);
+	}
+
+	//rebuilds the event with the recorded fields and handles it like one from MinVR
+	void replayEvent(const EventRecord &record)
+	{
+		const ControllerPaths &paths = getEventPaths(record.name);
+
+		VRDataIndex index;
+		if (record.fields & EventRecord::POSE)
+			index.addData(paths.pose, std::vector<float>(record.pose, record.pose + 16));
+		if (record.fields & EventRecord::AXIS1_BUTTON)
+			index.addData(paths.axis1ButtonPressed, record.axis1Button);
+		if (record.fields & EventRecord::AXIS0_X)
+			index.addData(paths.axis0XPos, record.axis0X);
+		if (record.fields & EventRecord::AXIS0_Y)
+			index.addData(paths.axis0YPos, record.axis0Y);
+		VREventInternal event(record.name, &index);
+		onVREvent(*event.getAPIEvent());
+	}
+
+	void onLeftController(const VREvent &event)
+	{
+		VRDataIndex * index = event.getInternal()->getDataIndex();
+		if (!index->exists(leftPaths.pose))
+			return;
+
+		if (!move_menu){
+			menupose = event.getDataAsFloatArray("Pose");
+			menupose = menupose *  VRMatrix4::translation(VRVector3(0, -0.2, 0));
 		}
-		if (event.getName() == "HTC_Controller_Right_AButton_Pressed"){
-			if (mode != 2 && (show_menu || move_menu)){
-				currentMenu++;
-				currentMenu = currentMenu % menus.size();
-				displayMenu(currentMenu);
-			}
-			else{
-				float tmp = currentSet - 1;
-				if (tmp < 0) tmp = data.size() - 1;
-				setCurrentSet(tmp);			
-			}
+		else if (index->exists(leftPaths.axis1ButtonPressed) && (int) index->getValue(leftPaths.axis1ButtonPressed))
+		{
+			menupose = event.getDataAsFloatArray("Pose");
+			menupose = menupose * VRMatrix4::translation(VRVector3(0, -0.2, 0));
 		}
-		if (event.getName() == "HTC_Controller_Right_ApplicationMenuButton_Pressed" && (mode == 2)){
-			
-			float tmp = currentSet + 1;
-			if (tmp >= data.size()) tmp = 0;
-			setCurrentSet(tmp);	
+		menusDirty = true;
+	}
+
+	void onRightController(const VREvent &event)
+	{
+		VRDataIndex * index = event.getInternal()->getDataIndex();
+		if (index->exists(rightPaths.pose)){
+			//menus and holograms are picked once per frame with the latest pose
+			controllerpose = event.getDataAsFloatArray("Pose");
+			menusDirty = true;
+			pickDirty = true;
 		}
 
-		if (event.getName() == "HTC_Controller_Left" && move_menu)
-		{
-			if (event.getInternal()->getDataIndex()->exists("/HTC_Controller_Left/State/Axis1Button_Pressed") &&
-				(int) event.getInternal()->getDataIndex()->getValue("/HTC_Controller_Left/State/Axis1Button_Pressed"))
-			{
-				if (event.getInternal()->getDataIndex()->exists("/HTC_Controller_Left/Pose")){
-					menupose = event.getDataAsFloatArray("Pose");
-					menupose = menupose * VRMatrix4::translation(VRVector3(0, -0.2, 0));;
-					updateMenus();
-				}
-			}
+		movement_x = (ALLOW_ROTATE) ? 0.2f * (float) index->getValue(rightPaths.axis0XPos) : 0.0;
+		movement_y = (float) index->getValue(rightPaths.axis0YPos) * MOVE_SCALE;
+	}
+
+	void onRightAxis1ButtonPressed(const VREvent &event)
+	{
+		if (menusDirty) updateMenus();
+		clickMenus(true);
+		setMeasurePoint(true);
+		measuring = true;
+	}
+
+	void onRightAxis1ButtonReleased(const VREvent &event)
+	{
+		clickMenus(false);
+		measuring = false;
+	}
+
+	void onLeftAxis1ButtonPressed(const VREvent &event)
+	{
+		displayMenu(currentMenu);
+		if (move_menu) updateMenus();
+	}
+
+	void onLeftAxis1ButtonReleased(const VREvent &event)
+	{
+		if (!move_menu) displayMenu(-1);
+	}
+
+	void onRightAButtonPressed(const VREvent &event)
+	{
+		if (mode != 2 && (show_menu || move_menu)){
+			currentMenu++;
+			currentMenu = currentMenu % menus.size();
+			displayMenu(currentMenu);
+		}
+		else{
+			float tmp = currentSet - 1;
+			if (tmp < 0) tmp = data.size() - 1;
+			if (player.isPlaying())
+				player.seek(tmp);
+			setCurrentSet(tmp);
 		}
+	}
 
-		if (event.getName() == "HTC_Controller_Right")
-		{
-			if(event.getInternal()->getDataIndex()->exists("/HTC_Controller_Right/Pose")){
-				controllerpose = event.getDataAsFloatArray("Pose");
-				updateMenus();
-				checkHologramIntersect();
-				if (measuring) setMeasurePoint(false);
-			}
+	void onRightApplicationMenuButtonPressed(const VREvent &event)
+	{
+		float tmp = currentSet + 1;
+		if (tmp >= data.size()) tmp = 0;
+		if (player.isPlaying())
+			player.seek(tmp);
+		setCurrentSet(tmp);
+	}
 
-			{
-			
-				movement_x = (ALLOW_ROTATE) ? 0.2f * (float) event.getInternal()->getDataIndex()->getValue("/HTC_Controller_Right/State/Axis0/XPos") : 0.0; 
-				movement_y = (float)event.getInternal()->getDataIndex()->getValue("/HTC_Controller_Right/State/Axis0/YPos") * MOVE_SCALE;
-			}
+	void onEscape(const VREvent &event)
+	{
+		shutdown();
+	}
+
+	void onBackspace(const VREvent &event)
+	{
+		std::string filter = frames_list->getFilter();
+		if (!filter.empty())
+			frames_list->setFilter(filter.substr(0, filter.size() - 1));
+	}
+
+	void onKeyboard(const VREvent &event)
+	{
+		//typing on the desktop keyboard filters the frame list
+		std::string name = event.getName();
+		if (name.size() == 9 && startsWith(name, "Kbd") && name.substr(4) == "_Down")
+		{
+			frames_list->setFilter(frames_list->getFilter() + (char) tolower(name[3]));
 		}
+	}
+
+	void jumpToSet(int id)
+	{
+		if (id < 0 || id >= data.size())
+			return;
 
-		if (event.getName() == "KbdEsc_Down") {
-            		shutdown();
-            		return;
-		}  
+		if (mode != 2){
+			centerHologram(data[id]);
+			setCurrentSet();
+		}
+		else
+		{
+			if (player.isPlaying())
+				player.seek(id);
+			setCurrentSet(id);
+		}
+		//what was read ahead for the old position is not needed anymore
+		if (manifest.isOpen() && level >= 0)
+			requestLevelFrames();
 	}
 
 	virtual void handleEvent(VRMenuElement * element)
 	{
 		if (element == ctd_data_graph_graph)
 		{
-			if (mode != 2){
-				centerHologram(data[ctd_data_graph_graph->getSelection()]);
-				setCurrentSet();
-			}
-			else
-			{
-				setCurrentSet(ctd_data_graph_graph->getSelection());
-			}
+			jumpToSet(ctd_data_graph_graph->getSelection());
+		}
+		if (element == frames_list)
+		{
+			jumpToSet(frames_list->getSelection());
 		}
 		if (element == ctd_data_graph_next)
 		{
@@ -738,20 +848,40 @@ public:
 		{
 			play = ctd_data_graph_play->isToggled();
 		}
+		if (element == ctd_data_graph_overlay)
+		{
+			ctd_data_graph_graph->setOverlay(ctd_data_graph_overlay->isToggled());
+		}
+		if (element == ctd_data_graph_scatter)
+		{
+			updateGraph();
+		}
+		if (element == ctd_data_graph_axis)
+		{
+			graph_scatterValue++;
+			if (graph_scatterValue >= data[0].value_names.size())
+				graph_scatterValue = 0;
+			updateGraph();
+		}
 	}
 
 	// Callback for rendering, inherited from VRRenderHandler
 	virtual void onVRRenderGraphicsContext(const VRGraphicsState& state) {
-		if (!texturesloaded)
+		if (eventRecorder.isOpen())
 		{
-			for (int i = 0; i < data.size(); i++)
-				uploadTextures(data[i]);
-
-			texturesloaded = true;
-			updateMenus();
-			displayMenu(currentMenu);
+			//the replay renders a frame where this marker is
+			EventRecord record;
+			record.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - recordStart).count();
+			record.frame = true;
+			eventRecorder.write(record);
 		}
+		if (!texturesloaded)
+			initGraphics();
+		updateFrame();
+	}
 
+	void updateFrame()
+	{
 		if(fabs(movement_x) > 0.1 || fabs(movement_y) > 0.1){
 			VRVector3 offset = 0.1 * controllerpose * VRVector3(0, 0, movement_y);
 			VRMatrix4 trans = VRMatrix4::translation(offset);
@@ -759,238 +889,482 @@ public:
 
 			VRMatrix4 rot = VRMatrix4::rotationY(movement_x / 10 / CV_PI);
 			roompose = rot * roompose;	
+			pickDirty = true;
 		}
 		if (mode == 2)
 		{
 			if (play){
-				float tmp = MOVIE_FPS_MODIFIER + currentSet;
-				if (tmp > data.size()) tmp = 0;
-				setCurrentSet(tmp);
+				playMovie();
 			}
 			else
 			{
+				player.stop();
 				setCurrentSet(currentSet);
 			}
 		}
 		else{
 			setCurrentSet();
 		}
-	}
+		updateLevel();
+		takeFrames();
+		streamTextures();
 
-	// Callback for rendering, inherited from VRRenderHandler
-    virtual void onVRRenderGraphics(const VRGraphicsState &state) {
-		glDisable(GL_DEPTH_TEST);
-		glDepthFunc(GL_LEQUAL);
-		glClearDepth(1.0f);
-		glClearColor(0.0, 0.0, 0.0, 1.f);
-		glDisable(GL_LIGHTING);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		glMatrixMode(GL_PROJECTION);
-		glLoadMatrixf(state.getProjectionMatrix());
-
-		glMatrixMode(GL_MODELVIEW);
-		glLoadMatrixf(state.getViewMatrix());
-
-    		glPushMatrix();
-			glMultMatrixf(roompose.getArray());
-			int maxRange = (mode ==0) ? SHOW_LIMIT : (mode ==1)? 100000 : 0;
-			int start = currentSet - maxRange;
-			int end = currentSet + maxRange;
-			if (start < 0)
-				start = 0;
-			if (end > data.size() - 1)
-				end = data.size() - 1;
-
-			for (int i = start; i <= end; i++)
-				drawQuads(data[i]);
-
-			glEnable(GL_DEPTH_TEST);
-			if (draw_Boundary)
-			{
-				for (int i = start; i <= end; i++)
-					drawBoundaries(data[i]);
-			}
-			if (trace)
-				drawTraces(currentSet);
+		if (menusDirty)
+			updateMenus();
+		updatePicking();
+		if (pickDirty)
+		{
+			submitPicking();
+			pickDirty = false;
+		}
 
-		glPopMatrix();
+		buildFramePacket();
+		(this->*recordSceneFunction)(framePacket.scene);
+		if (renderer != NULL)
+			renderer->upload(framePacket.scene);
+	}
 
+	//everything which needs the context, on the first frame
+	void initGraphics()
+	{
+		renderer = Renderer::create(rendererName);
+		std::cerr << "Using the " << renderer->getName() << " renderer" << std::endl;
+		VRFontHandler::getInstance()->createTexture(renderer);
 
+		uploadTextures();
 
-		if (show_info){
-			if (hoverHologram != NULL)
+		buildBoundaries();
+		texturesloaded = true;
+		updateMenus();
+		displayMenu(currentMenu);
+	}
+
+	//renders the movie or a camera path at fixed time steps without a display and encodes the frames
+	bool exportFrames(const ExportOptions &options)
+	{
+#ifdef HAVE_EGL
+		bool movie = options.source == "movie";
+		std::vector<CameraKey> path;
+		if (!movie && !readCameraPath(options.source, path))
+			return false;
+		double duration = (movie) ? data.size() / MOVIE_FPS : path.back().time;
+		int frameCount = (int)(duration * options.fps) + 1;
+
+		OffscreenContext context;
+		if (!context.create(options.width, options.height))
+			return false;
+		initGraphics();
+		if (!context.createFramebuffer())
+			return false;
+		//the export always shows the finest level that fits, whatever the speed
+		if (manifest.isOpen() && level != minLevel)
+			setLevel(minLevel);
+
+		//the movie is seen from one frame depth in front, a camera path sets the viewer itself
+		float projection[16];
+		getPerspective(60.0 * deg2rad, (double)options.width / options.height, 0.01, 100.0, projection);
+		VRMatrix4 view = (movie) ? VRMatrix4::translation(VRVector3(0, 0, -hologramSize[2])) : VRMatrix4::translation(VRVector3(0, 0, 0));
+
+		FrameExporter exporter;
+		int threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+		if (!exporter.start(options.output, options.width, options.height, options.fps, threads))
+			return false;
+
+		std::vector<unsigned char> pixels;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int i = 0; i < frameCount; i++)
+		{
+			double time = i / options.fps;
+			if (movie)
 			{
-				std::cerr << "Hover" << std::endl;
-				glPushMatrix();
-				glMultMatrixf(roompose.getArray());
-				glBegin(GL_LINE_STRIP);
-				glColor3f(1.0f, 1.0f, 0.5f);
-				double offset = (mode == 0) ? -hoverHologram->setID  * hologramSize[2] : 0;
-				glVertex3f(hoverHologram->vertices[0][0], hoverHologram->vertices[0][1], hoverHologram->vertices[0][2] + offset);
-				glVertex3f(hoverHologram->vertices[1][0], hoverHologram->vertices[1][1], hoverHologram->vertices[1][2] + offset);
-				glVertex3f(hoverHologram->vertices[2][0], hoverHologram->vertices[2][1], hoverHologram->vertices[2][2] + offset);
-				glVertex3f(hoverHologram->vertices[3][0], hoverHologram->vertices[3][1], hoverHologram->vertices[3][2] + offset);
-				glVertex3f(hoverHologram->vertices[0][0], hoverHologram->vertices[0][1], hoverHologram->vertices[0][2] + offset);
-				glEnd();
-
-
-				std::vector<std::string> text;
-				//text.push_back("Type:  " + hoverHologram->type);
-				text.push_back("ESD:  " + std::to_string((long double)hoverHologram->esd));
-				text.push_back("ESV:  " + std::to_string((long double)hoverHologram->esv));
-				VRFontHandler::getInstance()->renderMultiLineTextBox(text,
-					hoverHologram->vertices[1][0], hoverHologram->vertices[1][1] - 0.3, hoverHologram->vertices[0][2] + offset,
-					0.6, 0.3, VRFontHandler::LEFT, (controllerpose * VRVector3(0,0,-1)).z > 0 );
-				glPopMatrix();
+				setCurrentSet(std::min(time * MOVIE_FPS, data.size() - 1.0));
 			}
+			else
+			{
+				roompose = getCameraPose(path, time);
+				setCurrentSet();
+			}
+			waitForVisibleFrames();
+
+			buildFramePacket();
+			(this->*recordSceneFunction)(framePacket.scene);
+			renderer->upload(framePacket.scene);
+			context.clear();
+			renderer->draw(framePacket.scene, projection, view.getArray());
+			context.readPixels(pixels);
+			exporter.add(pixels);
 		}
-		
-		if (show_measure){
-			if (measureSet)
+		exporter.finish();
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cerr << "Exported " << frameCount << " frames of " << options.width << "x" << options.height << " in " << seconds << " s, "
+			<< frameCount / seconds << " fps" << std::endl;
+		return true;
+#else
+		std::cerr << "Exporting needs EGL, which was not found when this was built" << std::endl;
+		return false;
+#endif
+	}
+
+	//feeds a recorded session into the viewer without MinVR or a display, renders a frame
+	//at every frame marker and reports the frame times
+	bool replayEvents(const std::string &filename, int width, int height)
+	{
+#ifdef HAVE_EGL
+		EventLogReader log;
+		if (!log.open(filename))
+			return false;
+
+		OffscreenContext context;
+		if (!context.create(width, height))
+			return false;
+		initGraphics();
+		if (!context.createFramebuffer())
+			return false;
+
+		//there is no head tracking, the views are the ones of the export
+		float projection[16];
+		getPerspective(60.0 * deg2rad, (double)width / height, 0.01, 100.0, projection);
+		VRMatrix4 view = VRMatrix4::translation(VRVector3(0, 0, 0));
+
+		std::vector<double> frameTimes;
+		int events = 0;
+		EventRecord record;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::chrono::steady_clock::time_point frameStart = start;
+		while (log.read(record))
+		{
+			if (!record.frame)
 			{
-				glPushMatrix();
-				glMultMatrixf(roompose.getArray());
-				glBegin(GL_LINE_STRIP);
-				glColor3f(0.9f, 0.0f, 0.0f);
-				glVertex3f(startMeasure.x, startMeasure.y, startMeasure.z);
-				glVertex3f(endMeasure.x, endMeasure.y, endMeasure.z);
-				glEnd();
-
-				double dist = std::sqrt(
-					std::pow((startMeasure.x - endMeasure.x) * SCALE, 2) +
-					std::pow((startMeasure.y - endMeasure.y) * SCALE, 2) +
-					std::pow((startMeasure.z - endMeasure.z) * SCALE * Z_SCALE, 2)
-					);
-
-				VRFontHandler::getInstance()->renderTextBox(std::to_string((long double)dist),
-					endMeasure.x, endMeasure.y - 0.1, endMeasure.z,
-					0.6, 0.1, VRFontHandler::LEFT, (controllerpose * VRVector3(0, 0, -1)).z > 0);
-				glPopMatrix();
+				replayEvent(record);
+				events++;
+				continue;
 			}
+
+			updateFrame();
+			context.clear();
+			renderer->draw(framePacket.scene, projection, view.getArray());
+			context.finish();
+			std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+			frameTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+			frameStart = frameEnd;
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (frameTimes.empty())
+		{
+			std::cerr << "The event log " << filename << " has no frames" << std::endl;
+			return false;
 		}
 
-		glPushMatrix();
-			glMultMatrixf(controllerpose.getArray());
-			glBegin(GL_LINES);                // Begin drawing the color cube with 6 quads
-			// Back face (z = -1.0f)
-			glColor3f(0.5f, 0.5f, 0.0f);     // Yellow
-			glVertex3f(0.0f, 0.0f, -5.0f);
-			glVertex3f(0.0f, 0.0f, 0.0f);
-			glEnd();  // End of drawing color-cube
-		glPopMatrix();
+		double total = 0;
+		for (std::vector<double>::const_iterator it = frameTimes.begin(); it != frameTimes.end(); ++it)
+			total += *it;
+		std::sort(frameTimes.begin(), frameTimes.end());
+		std::cerr << "Replayed " << events << " events and " << frameTimes.size() << " frames in " << seconds << " s" << std::endl;
+		std::cerr << "Frame time ms: mean " << total / frameTimes.size()
+			<< " p50 " << frameTimes[frameTimes.size() / 2]
+			<< " p95 " << frameTimes[frameTimes.size() * 95 / 100]
+			<< " p99 " << frameTimes[frameTimes.size() * 99 / 100]
+			<< " max " << frameTimes.back() << std::endl;
+		return true;
+#else
+		std::cerr << "Replaying needs EGL, which was not found when this was built" << std::endl;
+		return false;
+#endif
+	}
 
-		if (show_menu || move_menu){
-			drawMenus();
+	//the export waits until the frames it shows and their textures are loaded
+	void waitForVisibleFrames()
+	{
+		int start, end;
+		visibleRangeFunction(currentSet, data.size(), getStride(), start, end);
+		for (;;)
+		{
+			takeFrames();
+			streamTextures();
+			bool ready = true;
+			for (int i = start; ready && i <= end; i++)
+				ready = !levelFrames[i] || isFrameReady(i);
+			//nothing more arrives when both loaders are idle, e.g. after a read error
+			if (ready || (frameLoader.isIdle() && textureStreamer.isIdle()))
+				return;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
 		}
 	}
 
-	void drawBoundaries(DataSet &set)
+	//one key per line: seconds x y z yaw, lines starting with # are comments
+	bool readCameraPath(const std::string &filename, std::vector<CameraKey> &path)
 	{
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		std::ifstream file(filename.c_str());
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.empty() || line[0] == '#')
+				continue;
+			std::istringstream values(line);
+			CameraKey key;
+			if (values >> key.time >> key.position[0] >> key.position[1] >> key.position[2] >> key.yaw)
+				path.push_back(key);
+		}
+		if (path.empty())
+		{
+			std::cerr << "Could not read a camera path from " << filename << std::endl;
+			return false;
+		}
+		return true;
+	}
 
-		double offset = (mode == 0) ? -set.id * hologramSize[2] : 0;
-		double alpha = 1.0 / (3 * (std::fabs((float) currentSet - set.id) + 1));
-		glColor4f(alpha* frame_strength, alpha* frame_strength, 0.0f, alpha * frame_strength);
+	//the keys are interpolated linearly, the room is moved the opposite way of the viewer
+	VRMatrix4 getCameraPose(const std::vector<CameraKey> &path, double time)
+	{
+		int k = 0;
+		while (k + 2 < path.size() && path[k + 1].time < time)
+			k++;
+		const CameraKey &a = path[k];
+		const CameraKey &b = path[std::min(k + 1, (int)path.size() - 1)];
+		double t = (b.time > a.time) ? (time - a.time) / (b.time - a.time) : 0;
+		t = std::max(0.0, std::min(1.0, t));
+
+		VRVector3 position;
+		for (int i = 0; i < 3; i++)
+			position[i] = a.position[i] + (b.position[i] - a.position[i]) * t;
+		double yaw = (a.yaw + (b.yaw - a.yaw) * t) * deg2rad;
+		return (VRMatrix4::translation(position) * VRMatrix4::rotationY(yaw)).inverse();
+	}
 
-		for (int i = 0; i < set.quads.size(); i++)
-		{	
-			glBegin(GL_LINE_STRIP);
-			glVertex3f(-RATIO_P_TO_UM * min_Z, RATIO_P_TO_UM * min_Z, offset);
-			glVertex3f(RATIO_P_TO_UM * min_Z, RATIO_P_TO_UM * min_Z, offset);
-			glVertex3f(RATIO_P_TO_UM * min_Z, -RATIO_P_TO_UM * min_Z, offset);
-			glVertex3f(-RATIO_P_TO_UM * min_Z, -RATIO_P_TO_UM * min_Z, offset);
-			glVertex3f(-RATIO_P_TO_UM * min_Z, RATIO_P_TO_UM * min_Z, offset);
-			glEnd();
+	//column major like the matrices MinVR passes to the renderer
+	static void getPerspective(double fovY, double aspect, double zNear, double zFar, float matrix[16])
+	{
+		double f = 1.0 / std::tan(fovY / 2);
+		for (int i = 0; i < 16; i++)
+			matrix[i] = 0;
+		matrix[0] = f / aspect;
+		matrix[5] = f;
+		matrix[10] = (zFar + zNear) / (zNear - zFar);
+		matrix[11] = -1;
+		matrix[14] = 2 * zFar * zNear / (zNear - zFar);
+	}
 
-			glBegin(GL_LINE_STRIP);
-			glVertex3f(-RATIO_P_TO_UM * max_Z, RATIO_P_TO_UM * max_Z, -hologramSize[2] + offset);
-			glVertex3f(RATIO_P_TO_UM * max_Z, RATIO_P_TO_UM * max_Z, -hologramSize[2] + offset);
-			glVertex3f(RATIO_P_TO_UM * max_Z, -RATIO_P_TO_UM * max_Z, -hologramSize[2] + offset);
-			glVertex3f(-RATIO_P_TO_UM * max_Z, -RATIO_P_TO_UM * max_Z, -hologramSize[2] + offset);
-			glVertex3f(-RATIO_P_TO_UM * max_Z, RATIO_P_TO_UM * max_Z, -hologramSize[2] + offset);
-			glEnd();
+	void buildFramePacket()
+	{
+		visibleRangeFunction(currentSet, data.size(), getStride(), framePacket.start, framePacket.end);
+		framePacket.textFacing = (controllerpose * VRVector3(0, 0, -1)).z > 0;
 
-			glBegin(GL_LINES);
-			glVertex3f(-RATIO_P_TO_UM * min_Z, RATIO_P_TO_UM * min_Z, offset);
-			glVertex3f(-RATIO_P_TO_UM * max_Z, RATIO_P_TO_UM * max_Z, -hologramSize[2] + offset);
+		framePacket.boundaries.clear();
+		if (draw_Boundary)
+		{
+			for (int i = framePacket.start; i <= framePacket.end; i++)
+			{
+				//frames without holograms never had a boundary drawn
+				if (data[i].quads.empty())
+					continue;
+				RenderInstance instance;
+				instance.offset = zOffsetFunction(data[i].id, hologramSize[2]);
+				instance.alpha = 1.0 / (3 * (std::fabs(currentSet - data[i].id) + 1));
+				framePacket.boundaries.push_back(instance);
+			}
+		}
 
-			glVertex3f(RATIO_P_TO_UM * min_Z, RATIO_P_TO_UM * min_Z,offset);
-			glVertex3f(RATIO_P_TO_UM * max_Z, RATIO_P_TO_UM * max_Z, -hologramSize[2] + offset);
+		if (trace)
+		{
+			if (framePacket.traceFrame != (int)currentSet)
+				buildTraces(currentSet);
+		}
+		else
+		{
+			framePacket.traceFrame = -1;
+			framePacket.traceVertices.clear();
+		}
 
-			glVertex3f(RATIO_P_TO_UM * min_Z, -RATIO_P_TO_UM * min_Z, offset);
-			glVertex3f(RATIO_P_TO_UM * max_Z, -RATIO_P_TO_UM * max_Z, -hologramSize[2] + offset);
+		framePacket.hoverText.clear();
+		if (show_info && hoverHologram != NULL)
+		{
+			//framePacket.hoverText.push_back("Type:  " + getHologramTypeName(hoverHologram->type));
+			framePacket.hoverText.push_back("ESD:  " + std::to_string((long double)hoverHologram->esd));
+			framePacket.hoverText.push_back("ESV:  " + std::to_string((long double)hoverHologram->esv));
+		}
 
-			glVertex3f(-RATIO_P_TO_UM * min_Z, -RATIO_P_TO_UM * min_Z, offset);
-			glVertex3f(-RATIO_P_TO_UM * max_Z, -RATIO_P_TO_UM * max_Z, -hologramSize[2] + offset);
-			glEnd();
+		framePacket.measure = show_measure && measureSet;
+		if (framePacket.measure)
+		{
+			framePacket.measureVertices[0] = startMeasure.x;
+			framePacket.measureVertices[1] = startMeasure.y;
+			framePacket.measureVertices[2] = startMeasure.z;
+			framePacket.measureVertices[3] = endMeasure.x;
+			framePacket.measureVertices[4] = endMeasure.y;
+			framePacket.measureVertices[5] = endMeasure.z;
+
+			double dist = std::sqrt(
+				std::pow((startMeasure.x - endMeasure.x) * SCALE, 2) +
+				std::pow((startMeasure.y - endMeasure.y) * SCALE, 2) +
+				std::pow((startMeasure.z - endMeasure.z) * SCALE * Z_SCALE, 2)
+				);
+			framePacket.measureText = std::to_string((long double)dist);
 		}
-		glDisable(GL_BLEND);
 	}
 
-	void drawTraces(int frame)
-	{
-		for (int j = 0; j < data[frame].quads.size(); j++)
-		{
-			int id = data[frame].quads[j].ID;
-			int prev_slot = j;
-			for (int i = frame - 1; i > frame - 20 && i >= 0; i--)
+	// Callback for rendering, inherited from VRRenderHandler
+    virtual void onVRRenderGraphics(const VRGraphicsState &state) {
+		if (renderer != NULL)
+			renderer->draw(framePacket.scene, state.getProjectionMatrix(), state.getViewMatrix());
+	}
+
+	template <class Mode> void recordScene(RenderList &list) {
+		list.clear();
+
+		list.pushMatrix();
+			list.multMatrix(roompose.getArray());
+			for (int i = framePacket.start; i <= framePacket.end; i++)
 			{
-				int next_slot = getContourByID(i, id);
-
-				//draw
-				if (prev_slot >= 0 && next_slot >= 0){
-					float pts[2][3] = { { 0, 0, 0 }, { 0, 0, 0 } };
-					for (int y = 0; y < 3; y++)
-					{
-						for (int x = 0; x < 4; x++)
-						{
-							pts[0][y] += data[i + 1].quads[prev_slot].vertices[x][y];
-							pts[1][y] += data[i].quads[next_slot].vertices[x][y];
-						}
-						pts[0][y] /= 4.0;
-						pts[1][y] /= 4.0;
-					}
-					glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-					glBegin(GL_LINES);
-					glVertex3f(pts[0][0], pts[0][1], pts[0][2]);
-					glVertex3f(pts[1][0], pts[1][1], pts[1][2]);
-					glEnd();
-				}
+				//frames outside the active level have no quads
+				if (!data[i].quads.empty())
+					recordQuads<Mode>(list, data[i]);
+			}
+
+			list.setDepthTest(true);
+			if (!framePacket.boundaries.empty())
+				recordBoundaries(list);
+			if (!framePacket.traceVertices.empty())
+				recordTraces(list);
+
+		list.popMatrix();
+
+
 
-				//next
-				prev_slot = next_slot;
+		if (show_info){
+			if (hoverHologram != NULL)
+			{
+				list.pushMatrix();
+				list.multMatrix(roompose.getArray());
+				list.begin(RenderList::LINE_STRIP);
+				list.color(1.0f, 1.0f, 0.5f);
+				double offset = Mode::zOffset(hoverSetID, hologramSize[2]);
+				list.vertex(hoverHologram->xmin(), hoverHologram->ymin(), hoverHologram->center[2] + offset);
+				list.vertex(hoverHologram->xmax(), hoverHologram->ymin(), hoverHologram->center[2] + offset);
+				list.vertex(hoverHologram->xmax(), hoverHologram->ymax(), hoverHologram->center[2] + offset);
+				list.vertex(hoverHologram->xmin(), hoverHologram->ymax(), hoverHologram->center[2] + offset);
+				list.vertex(hoverHologram->xmin(), hoverHologram->ymin(), hoverHologram->center[2] + offset);
+				list.end();
+
+
+				VRFontHandler::getInstance()->renderMultiLineTextBox(list, framePacket.hoverText,
+					hoverHologram->xmax(), hoverHologram->ymin() - 0.3, hoverHologram->center[2] + offset,
+					0.6, 0.3, VRFontHandler::LEFT, framePacket.textFacing);
+				list.popMatrix();
 			}
 		}
+		
+		if (framePacket.measure){
+			const float *pts = framePacket.measureVertices;
+			list.pushMatrix();
+			list.multMatrix(roompose.getArray());
+			list.begin(RenderList::LINE_STRIP);
+			list.color(0.9f, 0.0f, 0.0f);
+			list.vertex(pts[0], pts[1], pts[2]);
+			list.vertex(pts[3], pts[4], pts[5]);
+			list.end();
+
+			VRFontHandler::getInstance()->renderTextBox(list, framePacket.measureText,
+				pts[3], pts[4] - 0.1, pts[5],
+				0.6, 0.1, VRFontHandler::LEFT, framePacket.textFacing);
+			list.popMatrix();
+		}
+
+		list.pushMatrix();
+			list.multMatrix(controllerpose.getArray());
+			list.begin(RenderList::LINES);
+			list.color(0.5f, 0.5f, 0.0f);     // Yellow
+			list.vertex(0.0f, 0.0f, -5.0f);
+			list.vertex(0.0f, 0.0f, 0.0f);
+			list.end();
+		list.popMatrix();
+
+		if (show_menu || move_menu){
+			drawMenus(list);
+		}
+	}
+
+	//trace segments only change with the current frame and the resident frames, so they
+	//are kept until one of them changes
+	void buildTraces(int frame)
+	{
+		framePacket.traceFrame = frame;
+		//at coarser levels the traces start at the level frame shown for frame
+		int stride = getStride();
+		buildTraceVertices(data, frame - frame % stride, TRACE_LENGTH, stride, framePacket.traceVertices);
+	}
+
+	void recordTraces(RenderList &list)
+	{
+		list.color(1.0f, 1.0f, 1.0f, 1.0f);
+		list.begin(RenderList::LINES);
+		for (int i = 0; i + 2 < framePacket.traceVertices.size(); i += 3)
+			list.vertex(framePacket.traceVertices[i], framePacket.traceVertices[i + 1], framePacket.traceVertices[i + 2]);
+		list.end();
 	}
 
-	void drawQuads(DataSet &set)
+	//the sampling volume of a frame: near and far rectangle and the 4 edges connecting them
+	void buildBoundaries()
 	{
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
-		double offset = (mode == 0) ? -set.id * hologramSize[2] : 0;
-		glEnable(GL_TEXTURE_2D);
+		float minHalfSize = RATIO_P_TO_UM * min_Z;
+		float maxHalfSize = RATIO_P_TO_UM * max_Z;
+		float corners[4][2] = { { -1, 1 }, { 1, 1 }, { 1, -1 }, { -1, -1 } };
+		boundaryVertices.clear();
+		for (int c = 0; c < 4; c++)
+		{
+			int n = (c + 1) % 4;
+			float segments[3][6] = {
+				{ corners[c][0] * minHalfSize, corners[c][1] * minHalfSize, 0, corners[n][0] * minHalfSize, corners[n][1] * minHalfSize, 0 },
+				{ corners[c][0] * maxHalfSize, corners[c][1] * maxHalfSize, -hologramSize[2], corners[n][0] * maxHalfSize, corners[n][1] * maxHalfSize, -hologramSize[2] },
+				{ corners[c][0] * minHalfSize, corners[c][1] * minHalfSize, 0, corners[c][0] * maxHalfSize, corners[c][1] * maxHalfSize, -hologramSize[2] } };
+			for (int s = 0; s < 3; s++)
+				boundaryVertices.insert(boundaryVertices.end(), segments[s], segments[s] + 6);
+		}
+	}
+
+	//one instance per visible frame, the core renderer draws all of them with a single call
+	void recordBoundaries(RenderList &list)
+	{
+		list.setBlend(RenderList::BLEND_ALPHA);
+		list.setInstances(&framePacket.boundaries[0], framePacket.boundaries.size());
+		list.color(frame_strength, frame_strength, 0.0f, frame_strength);
+		list.begin(RenderList::LINES);
+		for (int i = 0; i + 2 < boundaryVertices.size(); i += 3)
+			list.vertex(boundaryVertices[i], boundaryVertices[i + 1], boundaryVertices[i + 2]);
+		list.end();
+		list.resetInstances();
+		list.setBlend(RenderList::BLEND_NONE);
+	}
+
+	template <class Mode> void recordQuads(RenderList &list, DataSet &set)
+	{
+		list.setBlend(RenderList::BLEND_DST_ALPHA);
+		list.setInstance(Mode::zOffset(set.id, hologramSize[2]), 1.0f);
+		list.color(1.0f, 1.0f, 1.0f);
 
 		for (int i = 0; i < set.quads.size(); i++)
 		{
-			
-			glBindTexture(GL_TEXTURE_2D, set.quads[i].texture);
-			glBegin(GL_QUADS);                // Begin drawing the color cube with 6 quads
-			glColor3f(1.0f, 1.0f, 1.0f);   
-			glTexCoord2f(0, 1);
-			glVertex3f(set.quads[i].vertices[0][0], set.quads[i].vertices[0][1], set.quads[i].vertices[0][2] + offset);
-			glTexCoord2f(1, 1);
-			glVertex3f(set.quads[i].vertices[1][0], set.quads[i].vertices[1][1], set.quads[i].vertices[1][2] + offset);
-			glTexCoord2f(1, 0);
-			glVertex3f(set.quads[i].vertices[2][0], set.quads[i].vertices[2][1], set.quads[i].vertices[2][2] + offset);
-			glTexCoord2f(0, 0);
-			glVertex3f(set.quads[i].vertices[3][0], set.quads[i].vertices[3][1], set.quads[i].vertices[3][2] + offset);
-			glEnd();		
-		}
-		glDisable(GL_TEXTURE_2D);
-		glBindTexture(GL_TEXTURE_2D, 0);
-		glDisable(GL_BLEND);
+			//nothing is visible of quads without a texture
+			if (set.textures[i] < 0)
+				continue;
+			list.setTexture(textureIDs[set.textures[i]]);
+			list.begin(RenderList::QUADS);
+			float xmin = set.quads[i].xmin(), xmax = set.quads[i].xmax();
+			float ymin = set.quads[i].ymin(), ymax = set.quads[i].ymax();
+			float z = set.quads[i].center[2];
+			list.texCoord(0, 1);
+			list.vertex(xmin, ymin, z);
+			list.texCoord(1, 1);
+			list.vertex(xmax, ymin, z);
+			list.texCoord(1, 0);
+			list.vertex(xmax, ymax, z);
+			list.texCoord(0, 0);
+			list.vertex(xmin, ymax, z);
+			list.end();
+		}
+		list.setTexture(0);
+		list.resetInstances();
+		list.setBlend(RenderList::BLEND_NONE);
 	}
 
 	void setCurrentSet(float id = -1)
@@ -1007,6 +1381,7 @@ public:
 			ctd_data_current_filename->setText(data[currentSet].filename);
 			ctd_data_current_textBox_values->setText(data[currentSet].values);
 			ctd_data_graph_graph->setCurrent(currentSet);
+			frames_list->setCurrent(currentSet);
 			if (data[currentSet].value_names.size() > graph_currentValue){
 				ctd_data_graph_currentValue->setText(data[currentSet].values[graph_currentValue]);
 			}
@@ -1018,7 +1393,11 @@ public:
 	} 
 
 	void updateGraph(){
-		if (data[0].value_names.size() > graph_currentValue){
+		bool scatter = ctd_data_graph_scatter != NULL && ctd_data_graph_scatter->isToggled();
+		if (data[0].value_names.size() > graph_currentValue && scatter){
+			ctd_data_graph_ValueName->setText(data[0].value_names[graph_currentValue] + " / " + data[0].value_names[graph_scatterValue]);
+		}
+		else if (data[0].value_names.size() > graph_currentValue){
 			ctd_data_graph_ValueName->setText(data[0].value_names[graph_currentValue]);
 		}
 		else
@@ -1032,34 +1411,238 @@ public:
 		{
 			ctd_data_graph_currentValue->setText("");
 		}
-		ctd_data_graph_graph->setData(getDataFromHologram(graph_currentValue));
+		ctd_data_graph_graph->setActiveSeries(graph_currentValue);
+		ctd_data_graph_graph->setScatter((scatter) ? graph_scatterValue : -1, graph_currentValue);
 	}
 
-	void unloadQuads()
+	//advances the movie by the wall clock, the frame stays when the due one is not loaded yet
+	void playMovie()
 	{
-
+		if (!player.isPlaying())
+			player.start(currentSet);
+
+		int stride = getStride();
+		float due = player.getDueFrame(data.size());
+		prefetchMovie(stride);
+		bool ready = isFrameReady((int)due - (int)due % stride);
+		player.present(data.size(), stride, ready);
+		if (ready)
+			setCurrentSet(due);
 	}
 
-	void centerHologram(DataSet &set)
+	//the next frames of the movie and their textures go before the rest of the level
+	void prefetchMovie(int stride)
 	{
-		double x = 0;
-		double y = 0;
-		double z = 0;
-
-		for (int i = 0; i < set.quads.size(); i++)
+		if (!manifest.isOpen() || level < 0)
+			return;
+
+		std::vector<int> frames;
+		player.getAheadFrames(data.size(), stride, frames);
+		std::vector<int> urgentFrames;
+		std::vector<int> urgentTextures;
+		for (std::vector<int>::const_iterator it = frames.begin(); it != frames.end(); ++it)
 		{
-			for (int j = 0; j <4; j++)
+			if (!levelFrames[*it])
+				continue;
+			if (!resident[*it])
 			{
-				x += set.quads[i].vertices[j][0];
-				y += set.quads[i].vertices[j][1];
-				z += set.quads[i].vertices[j][2];
+				if (!frameAhead[*it])
+					urgentFrames.push_back(*it);
+				frameAhead[*it] = 1;
+				continue;
 			}
+			for (std::vector<int>::const_iterator it_t = data[*it].textures.begin(); it_t != data[*it].textures.end(); ++it_t)
+			{
+				if (*it_t >= 0 && textureIDs[*it_t] == 0 && textureRequested[*it_t] != TEXTURE_URGENT)
+				{
+					textureRequested[*it_t] = TEXTURE_URGENT;
+					urgentTextures.push_back(*it_t);
+				}
+			}
+		}
+		frameLoader.request(urgentFrames, true);
+		if (!urgentTextures.empty())
+		{
+			textureStreamer.request(urgentTextures, true);
+			texturesStreaming = true;
+		}
+	}
+
+	//the quads of the frame and all of their textures are there
+	bool isFrameReady(int frame)
+	{
+		if (frame < 0 || frame >= data.size() || !resident[frame])
+			return false;
+		for (std::vector<int>::const_iterator it = data[frame].textures.begin(); it != data[frame].textures.end(); ++it)
+		{
+			if (*it >= 0 && textureIDs[*it] == 0)
+				return false;
+		}
+		return true;
+	}
+
+	//frees the quads of a frame and the textures no other resident frame uses
+	void unloadQuads(int frame)
+	{
+		if (!resident[frame])
+			return;
+		const std::vector<ManifestTexture> &entries = manifest.getTextures();
+		for (std::vector<int>::const_iterator it = data[frame].textures.begin(); it != data[frame].textures.end(); ++it)
+		{
+			if (*it < 0)
+				continue;
+			const ManifestTexture &entry = entries[*it];
+			rgbaTextureBytes -= 4 * entry.width * entry.height;
+			if (--textureRefs[*it] > 0 || textureIDs[*it] == 0)
+				continue;
+			renderer->deleteTexture(textureIDs[*it]);
+			textureIDs[*it] = 0;
+			textureBytes -= (entry.compressed && renderer->supportsFormat(Renderer::RGTC2)) ? entry.size : 2 * entry.width * entry.height;
+		}
+		std::vector<hologram>().swap(data[frame].quads);
+		std::vector<int>().swap(data[frame].textures);
+		resident[frame] = 0;
+		updatePickFrame(frame);
+		framePacket.traceFrame = -1;
+	}
+
+	int getStride()
+	{
+		return (level > 0) ? Manifest::getLevelStride(level) : 1;
+	}
+
+	//the finest level whose quads fit into LEVEL_MAX_QUADS is the finest one ever used
+	void openLevels()
+	{
+		size_t textureCount = hologramTextures.size();
+		if (manifest.isOpen())
+		{
+			textureCount = manifest.getTextures().size();
+			while (minLevel + 1 < manifest.getLevelCount() && manifest.getLevelQuads(minLevel) > LEVEL_MAX_QUADS)
+				minLevel++;
+			textureStreamer.start(manifest.getTextureFiles(), manifest.getTextures());
+			frameLoader.start();
 		}
+		textureIDs.assign(textureCount, 0);
+		textureRefs.assign(textureCount, 0);
+		textureRequested.assign(textureCount, TEXTURE_IDLE);
+		//after a full load the frames of level 0 are resident, otherwise no level is active yet
+		levelFrames.assign(data.size(), level == 0);
+		frameAhead.assign(data.size(), 0);
+		levelTime = std::chrono::steady_clock::now();
+		levelSettle = levelTime;
+	}
 
-		x = x / set.quads.size() / 4;
-		y = y / set.quads.size() / 4;
-		z = z / set.quads.size() / 4;
+	//picks the level from the speed at which frames pass, by flying or playing the movie
+	void updateLevel()
+	{
+		if (!manifest.isOpen())
+			return;
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		double seconds = std::chrono::duration<double>(now - levelTime).count();
+		levelTime = now;
+		if (seconds > 0 && std::fabs(currentSet - levelSet) <= LEVEL_JUMP_FRAMES)
+		{
+			double speed = std::fabs(currentSet - levelSet) / seconds;
+			frameSpeed += (speed - frameSpeed) * std::min(1.0, seconds / 0.5);
+		}
+		levelSet = currentSet;
 
+		int wanted = minLevel;
+		while (wanted + 1 < manifest.getLevelCount() && frameSpeed > LEVEL_FRAMES_PER_SECOND * Manifest::getLevelStride(wanted))
+			wanted++;
+
+		//coarser levels are used at once, finer ones once the speed stayed low for a while
+		if (wanted >= level)
+			levelSettle = now;
+		if (wanted > level || (wanted < level && std::chrono::duration<double>(now - levelSettle).count() >= LEVEL_SETTLE_SECONDS))
+			setLevel(wanted);
+	}
+
+	void setLevel(int newLevel)
+	{
+		level = newLevel;
+		hoverHologram = NULL;
+
+		const std::vector<int> &frames = manifest.getLevelFrames(level);
+		levelFrames.assign(data.size(), 0);
+		for (std::vector<int>::const_iterator it = frames.begin(); it != frames.end(); ++it)
+			levelFrames[*it] = 1;
+		for (int i = 0; i < data.size(); i++)
+		{
+			if (!levelFrames[i])
+				unloadQuads(i);
+		}
+
+		int missing = requestLevelFrames();
+		publishPickSnapshot();
+		std::cerr << "Temporal level " << level << " with a stride of " << getStride() << ", " << missing << " frames to load" << std::endl;
+	}
+
+	//drops what was requested before and asks for the missing frames of the level, closest
+	//to the current frame first, and for the textures of the resident frames
+	int requestLevelFrames()
+	{
+		frameLoader.cancel();
+		textureStreamer.cancel();
+
+		std::vector<int> requests;
+		for (int i = 0; i < textureRequested.size(); i++)
+		{
+			textureRequested[i] = (textureRefs[i] > 0 && textureIDs[i] == 0) ? TEXTURE_REQUESTED : TEXTURE_IDLE;
+			if (textureRequested[i] != TEXTURE_IDLE)
+				requests.push_back(i);
+		}
+		textureStreamer.request(requests);
+		if (!requests.empty())
+			texturesStreaming = true;
+
+		std::vector<int> frames;
+		for (int i = 0; i < data.size(); i++)
+		{
+			if (levelFrames[i] && !resident[i])
+				frames.push_back(i);
+		}
+		FrameDistance distance;
+		distance.current = currentSet;
+		std::sort(frames.begin(), frames.end(), distance);
+		frameLoader.request(frames);
+		frameAhead.assign(data.size(), 0);
+		return frames.size();
+	}
+
+	//fills in the active level with the frames read so far, a limited number of quads per frame
+	void takeFrames()
+	{
+		std::vector<int> frames;
+		std::vector<DataSet> sets;
+		frameLoader.take(frames, sets, LEVEL_LOAD_QUADS);
+		for (int i = 0; i < frames.size(); i++)
+		{
+			int frame = frames[i];
+			//the level may have changed while the frame was read
+			if (!levelFrames[frame] || resident[frame])
+				continue;
+			std::swap(data[frame].quads, sets[i].quads);
+			std::swap(data[frame].textures, sets[i].textures);
+			resident[frame] = 1;
+			addTextureRefs(frame, frameAhead[frame] != 0);
+			updatePickFrame(frame);
+			framePacket.traceFrame = -1;
+			framesArrived = true;
+		}
+		if (framesArrived && frameLoader.isIdle())
+		{
+			framesArrived = false;
+			publishPickSnapshot();
+		}
+	}
+
+	//only depends on the position of the frame in the stack, so it also works for
+	//frames whose quads are not resident
+	void centerHologram(const DataSet &set)
+	{
 		double offset = (mode == 0) ? set.id * hologramSize[2] : 0;
 		roompose = VRMatrix4::translation(VRVector3(0, 0, hologramSize[2] *0.5 + offset));
 	}
@@ -1070,18 +1653,12 @@ public:
 		VRVector3 max_vector3 = VRVector3(-10000000, -10000000, -10000000);
 		for (std::vector<DataSet>::const_iterator it = data.begin(); it != data.end(); ++it)
 		{
-			for (std::vector<hologram>::const_iterator it_h = it->quads.begin(); it_h != it->quads.end(); ++it_h)
+			for (int k = 0; k <3; k++)
 			{
-				for (int j = 0; j <4; j++)
-				{
-					for (int k = 0; k <3; k++)
-					{
-						if (min_vector3[k] > it_h->vertices[j][k])
-							min_vector3[k] = it_h->vertices[j][k];
-						if (max_vector3[k] < it_h->vertices[j][k])
-							max_vector3[k] = it_h->vertices[j][k];
-					}
-				}
+				if (min_vector3[k] > it->boundsMin[k])
+					min_vector3[k] = it->boundsMin[k];
+				if (max_vector3[k] < it->boundsMax[k])
+					max_vector3[k] = it->boundsMax[k];
 			}
 		}
 
@@ -1089,52 +1666,147 @@ public:
 		hologramSize[2] = (max_Z - min_Z) / SCALE / Z_SCALE;;
 	}
 
-	void uploadTextures(DataSet &set)
+	//counts the quads of a frame using each texture and requests the textures which are not uploaded yet
+	void addTextureRefs(int frame, bool urgent)
 	{
-		
-			for (int i = 0; i < set.quads.size(); i++)
+		std::vector<int> requests;
+		for (std::vector<int>::const_iterator it = data[frame].textures.begin(); it != data[frame].textures.end(); ++it)
+		{
+			if (*it < 0)
+				continue;
+			const ManifestTexture &entry = manifest.getTextures()[*it];
+			rgbaTextureBytes += 4 * entry.width * entry.height;
+			textureRefs[*it]++;
+			if (textureIDs[*it] == 0 && (textureRequested[*it] == TEXTURE_IDLE || (urgent && textureRequested[*it] != TEXTURE_URGENT)))
 			{
-				//use fast 4-byte alignment (default anyway) if possible
-				//glPixelStorei(GL_UNPACK_ALIGNMENT, (opencvImages[i].step & 3) ? 1 : 4);
+				textureRequested[*it] = (urgent) ? TEXTURE_URGENT : TEXTURE_REQUESTED;
+				requests.push_back(*it);
+			}
+		}
+		if (!requests.empty())
+		{
+			textureStreamer.request(requests, urgent);
+			texturesStreaming = true;
+		}
+	}
 
-				//set length of one complete row in data (doesn't need to equal image.cols)
-				//glPixelStorei(GL_UNPACK_ROW_LENGTH, opencvImages[i].step / opencvImages[i].elemSize());
+	unsigned int createHologramTexture(HologramTexture &texture)
+	{
+		unsigned int id;
+		if (texture.compressed && renderer->supportsFormat(Renderer::RGTC2))
+		{
+			id = renderer->createTexture(texture.width, texture.height, Renderer::RGTC2, &texture.data[0]);
+			textureBytes += texture.data.size();
+		}
+		else
+		{
+			std::vector<unsigned char> decoded;
+			const unsigned char *pixels = &texture.data[0];
+			if (texture.compressed)
+			{
+				imageBuffers.acquire(decoded, 2 * texture.width * texture.height);
+				decodeRGTC2(pixels, texture.width, texture.height, decoded);
+				pixels = &decoded[0];
+			}
+			id = renderer->createTexture(texture.width, texture.height, Renderer::GRAY_ALPHA, pixels);
+			textureBytes += 2 * texture.width * texture.height;
+			imageBuffers.release(decoded);
+		}
+		imageBuffers.release(texture.data);
+		return id;
+	}
 
-				glGenTextures(1, &set.quads[i].texture);
-				glBindTexture(GL_TEXTURE_2D, set.quads[i].texture);
+	//identical ROIs share one entry of hologramTextures and get the same texture
+	void uploadTextures()
+	{
+		if (hologramTextures.empty())
+			return;
 
-				glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+		for (int i = 0; i < hologramTextures.size(); i++)
+			textureIDs[i] = createHologramTexture(hologramTextures[i]);
 
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		//after a full load every frame is resident
+		for (std::vector<DataSet>::const_iterator it = data.begin(); it != data.end(); ++it)
+		{
+			for (std::vector<int>::const_iterator it_t = it->textures.begin(); it_t != it->textures.end(); ++it_t)
+			{
+				if (*it_t < 0)
+					continue;
+				textureRefs[*it_t]++;
+				rgbaTextureBytes += 4 * hologramTextures[*it_t].width * hologramTextures[*it_t].height;
+			}
+		}
+		hologramTextures.clear();
+		finishTextures();
+	}
 
-				// Set texture clamping method
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+	//the textures of the resident frames arrive while the scene is already shown
+	void streamTextures()
+	{
+		if (!texturesStreaming)
+			return;
 
-				glTexImage2D(GL_TEXTURE_2D,     // Type of texture
-					0,                 // Pyramid level (for mip-mapping) - 0 is the top level
-					GL_RGBA,            // Internal colour format to convert to
-					set.opencvImages[i].cols,          // Image width  i.e. 640 for Kinect in standard mode
-					set.opencvImages[i].rows,          // Image height i.e. 480 for Kinect in standard mode
-					0,                 // Border width in pixels (can either be 1 or 0)
-					GL_RGBA, // Input image format (i.e. GL_RGB, GL_RGBA, GL_BGR etc.)
-					GL_UNSIGNED_BYTE,  // Image data type
-					set.opencvImages[i].ptr());        // The actual image data itself
+		std::vector<int> indices;
+		std::vector<HologramTexture> textures;
+		textureStreamer.take(indices, textures, TEXTURE_UPLOAD_BYTES);
+		for (int i = 0; i < textures.size(); i++)
+		{
+			int index = indices[i];
+			textureRequested[index] = TEXTURE_IDLE;
+			//the frames using it may have been unloaded while it was read
+			if (textureRefs[index] > 0 && textureIDs[index] == 0)
+				textureIDs[index] = createHologramTexture(textures[i]);
+			else
+				imageBuffers.release(textures[i].data);
+		}
 
-				glBindTexture(GL_TEXTURE_2D, 0);
-			}
+		if (frameLoader.isIdle() && textureStreamer.isIdle())
+		{
+			texturesStreaming = false;
+			finishTextures();
+		}
+	}
 
-			
-			set.opencvImages.clear();
-		
+	void finishTextures()
+	{
+		std::cerr << "Hologram textures use " << textureBytes / (1024 * 1024) << " MB instead of "
+			<< rgbaTextureBytes / (1024 * 1024) << " MB as one RGBA texture per ROI" << std::endl;
+		imageBuffers.printStatistics();
+		imageBuffers.clear();
 	}
 
 protected:
 	
 	bool texturesloaded;
+	//texture memory of the holograms and what it would take as RGBA
+	size_t textureBytes;
+	size_t rgbaTextureBytes;
+	bool texturesStreaming;
+	//per shared texture its GL texture, the resident quads using it and whether it was requested
+	enum { TEXTURE_IDLE, TEXTURE_REQUESTED, TEXTURE_URGENT };
+	std::vector<unsigned int> textureIDs;
+	std::vector<int> textureRefs;
+	std::vector<char> textureRequested;
+	TextureStreamer textureStreamer;
+
+	Manifest manifest;
+	FrameLoader frameLoader;
+	//the active temporal level, its frames, which frames have quads and which were asked for ahead of the movie
+	int level;
+	int minLevel;
+	std::vector<char> levelFrames;
+	std::vector<char> resident;
+	std::vector<char> frameAhead;
+	//frames passed per second, smoothed
+	double frameSpeed;
+	float levelSet;
+	std::chrono::steady_clock::time_point levelTime;
+	std::chrono::steady_clock::time_point levelSettle;
+	bool framesArrived;
+	MoviePlayer player;
 
 	hologram* hoverHologram;
+	int hoverSetID;
 
 	std::vector<VRMenu*> menus;
 	int currentMenu;
@@ -1151,7 +1823,38 @@ protected:
 	VRTextBox * ctd_data_graph_currentValue;
 	VRTextBox * ctd_data_graph_ValueName;
 	VRToggle * ctd_data_graph_play;
+	VRToggle * ctd_data_graph_overlay;
+	VRToggle * ctd_data_graph_scatter;
+	VRButton * ctd_data_graph_axis;
 	int graph_currentValue;
+	int graph_scatterValue;
+	std::vector<std::vector<double> > ctd_columns;
+
+	VRListView * frames_list;
+
+	ControllerPaths leftPaths;
+	ControllerPaths rightPaths;
+	VREventDispatcher<MyVRApp, VREvent> eventDispatcher;
+
+	bool menusDirty;
+	bool pickDirty;
+	EventLogWriter eventRecorder;
+	std::chrono::steady_clock::time_point recordStart;
+	std::unordered_map<std::string, ControllerPaths> recordPaths;
+	std::shared_ptr<const HologramSnapshot> pickSnapshot;
+	std::vector<std::shared_ptr<const PickFrame> > pickFrames;
+	bool pickFramesDirty;
+	PickingWorker pickingWorker;
+
+	void (MyVRApp::*recordSceneFunction)(RenderList &list);
+	PickFunction pickFunction;
+	void (*pickRangeFunction)(int current, int count, int stride, int maxRange, int &start, int &end);
+	void (*visibleRangeFunction)(int current, int count, int stride, int &start, int &end);
+	double (*zOffsetFunction)(int setID, double zSpacing);
+	FramePacket framePacket;
+	std::vector<float> boundaryVertices;
+	std::string rendererName;
+	Renderer * renderer;
 
 	bool measuring;
 	bool measureSet;
@@ -1168,7 +1871,63 @@ protected:
 
 
 int main(int argc, char **argv) {
-	MyVRApp app(argc, argv, argv[1]);
+	//the options are taken out, the viewer reads the remaining arguments by position.
+	//--export <movie or camera path> <output> [width height fps] renders offscreen,
+	//--record <log> writes the events of the session and --replay <log> plays them back offscreen
+	std::vector<char *> args;
+	ExportOptions exportOptions;
+	bool exporting = false;
+	std::string recordLog;
+	std::string replayLog;
+	for (int i = 0; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--record" && i + 1 < argc)
+		{
+			recordLog = argv[++i];
+		}
+		else if (arg == "--replay" && i + 1 < argc)
+		{
+			replayLog = argv[++i];
+		}
+		else if (arg == "--export" && i + 2 < argc)
+		{
+			exporting = true;
+			exportOptions.source = argv[++i];
+			exportOptions.output = argv[++i];
+			double values[3] = { 1920, 1080, 30 };
+			for (int v = 0; v < 3 && i + 1 < argc; v++)
+			{
+				char *end;
+				double value = strtod(argv[i + 1], &end);
+				if (*end != '\0' || end == argv[i + 1])
+					break;
+				values[v] = value;
+				i++;
+			}
+			exportOptions.width = values[0];
+			exportOptions.height = values[1];
+			exportOptions.fps = values[2];
+			if (exportOptions.width <= 0 || exportOptions.height <= 0 || exportOptions.fps <= 0)
+			{
+				std::cerr << "usage: --export <movie or camera path> <output> [width height fps]" << std::endl;
+				return 1;
+			}
+		}
+		else
+		{
+			args.push_back(argv[i]);
+		}
+	}
+	args.push_back(NULL);
+
+	MyVRApp app(args.size() - 1, &args[0], args[1]);
+	if (exporting)
+		exit(app.exportFrames(exportOptions) ? 0 : 1);
+	if (!replayLog.empty())
+		exit(app.replayEvents(replayLog, 1920, 1080) ? 0 : 1);
+	if (!recordLog.empty() && !app.startRecording(recordLog))
+		exit(1);
   	app.run();
 	exit(0);
 }
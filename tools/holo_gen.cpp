@@ -0,0 +1,544 @@
+#include <png.h>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define makeDirectory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define makeDirectory(path) mkdir(path, 0755)
+#endif
+
+//Writes a synthetic cruise in the layout the viewer reads: one folder per frame with
+//a reportRaw_refined.xml, keyed ROI pngs and the CTD values in data/<name>.txt.
+//Particles keep their CONTOUR id while they drift through several frames, so traces
+//and picking see the same structure as in real data.
+
+#define REPORTNAME "reportRaw_refined.xml"
+
+//the sampling volume widens with the depth like the boundary of the viewer,
+//see RATIO_P_TO_UM in main.cpp. Positions are in the units of X and DEPTH.
+#define SENSOR_PIXELS 1024.0
+#define SCREEN_TO_SOURCE 100000.0
+#define PIXEL_SIZE 7.4
+#define HALF_FIELD (SENSOR_PIXELS / SCREEN_TO_SOURCE * PIXEL_SIZE)
+
+//frames written ahead of the workers
+#define QUEUE_FRAMES 64
+
+struct GenOptions {
+	std::string output;
+	int frames;
+	int rois;
+	int minSize;
+	int maxSize;
+	double minZ;
+	double maxZ;
+	double lifetime;
+	int imagePool;
+	int compression;
+	int threads;
+	unsigned int seed;
+};
+
+struct Particle {
+	int id;
+	double u, v, depth;
+	double du, dv, dz;
+	int width;
+	int height;
+	int age;
+	int life;
+};
+
+struct RoiRecord {
+	int id;
+	double x, y, depth;
+	int width;
+	int height;
+	unsigned int seed;
+};
+
+struct FrameJob {
+	int index;
+	std::vector<RoiRecord> rois;
+};
+
+static const char *ctdNames[] = { "Depth", "Temperature", "Salinity", "Oxygen", "Chlorophyll", "Turbidity" };
+#define CTD_VALUES 6
+
+static void usage()
+{
+	std::cerr << "usage: holo-gen <output folder> [options]" << std::endl
+		<< "  --frames N        frame folders to write (100)" << std::endl
+		<< "  --rois N          ROIs per frame (200)" << std::endl
+		<< "  --size MIN MAX    ROI image size in pixels (16 96)" << std::endl
+		<< "  --z MIN MAX       DEPTH range, min_Z and max_Z of the viewer (500 25000)" << std::endl
+		<< "  --lifetime N      mean number of frames a particle is seen in (20)" << std::endl
+		<< "  --image-pool N    reuse N encoded images instead of encoding every ROI (0)" << std::endl
+		<< "  --compression N   png compression level 0-9 (1)" << std::endl
+		<< "  --threads N       writer threads (hardware concurrency)" << std::endl
+		<< "  --seed N          random seed (1)" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, GenOptions &options)
+{
+	options.frames = 100;
+	options.rois = 200;
+	options.minSize = 16;
+	options.maxSize = 96;
+	options.minZ = 500;
+	options.maxZ = 25000;
+	options.lifetime = 20;
+	options.imagePool = 0;
+	options.compression = 1;
+	options.threads = std::thread::hardware_concurrency();
+	options.seed = 1;
+
+	if (argc < 2 || argv[1][0] == '-')
+		return false;
+	options.output = argv[1];
+
+	for (int i = 2; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		int values = (arg == "--size" || arg == "--z") ? 2 : 1;
+		if (i + values >= argc)
+			return false;
+
+		if (arg == "--frames")
+			options.frames = std::atoi(argv[i + 1]);
+		else if (arg == "--rois")
+			options.rois = std::atoi(argv[i + 1]);
+		else if (arg == "--size")
+		{
+			options.minSize = std::atoi(argv[i + 1]);
+			options.maxSize = std::atoi(argv[i + 2]);
+		}
+		else if (arg == "--z")
+		{
+			options.minZ = std::atof(argv[i + 1]);
+			options.maxZ = std::atof(argv[i + 2]);
+		}
+		else if (arg == "--lifetime")
+			options.lifetime = std::atof(argv[i + 1]);
+		else if (arg == "--image-pool")
+			options.imagePool = std::atoi(argv[i + 1]);
+		else if (arg == "--compression")
+			options.compression = std::atoi(argv[i + 1]);
+		else if (arg == "--threads")
+			options.threads = std::atoi(argv[i + 1]);
+		else if (arg == "--seed")
+			options.seed = std::atoi(argv[i + 1]);
+		else
+			return false;
+		i += values;
+	}
+
+	if (options.threads < 1)
+		options.threads = 1;
+	if (options.lifetime < 1)
+		options.lifetime = 1;
+	return options.frames > 0 && options.rois >= 0 && options.minSize > 0
+		&& options.maxSize >= options.minSize && options.maxZ > options.minZ;
+}
+
+static std::string getFrameName(int index)
+{
+	char name[32];
+	sprintf(name, "frame%07d", index);
+	return name;
+}
+
+//an ellipse of noisy gray values in a keyed background. Background pixels have red
+//and blue differ, the loader makes them transparent and takes blue as the gray value.
+static void drawParticle(int width, int height, unsigned int seed, std::vector<unsigned char> &pixels, double &area)
+{
+	std::minstd_rand random(seed);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+	double rx = width * (0.3 + 0.2 * unit(random));
+	double ry = height * (0.3 + 0.2 * unit(random));
+	double cx = width * 0.5;
+	double cy = height * 0.5;
+	int base = 60 + (int)(120 * unit(random));
+
+	pixels.resize(width * height * 3);
+	area = 0;
+	unsigned char *p = &pixels[0];
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++, p += 3)
+		{
+			double dx = (x + 0.5 - cx) / rx;
+			double dy = (y + 0.5 - cy) / ry;
+			double d = dx * dx + dy * dy;
+			if (d <= 1.0)
+			{
+				int gray = base + (int)(60 * (1.0 - d)) + (int)(random() % 24) - 12;
+				gray = (gray < 0) ? 0 : (gray > 255) ? 255 : gray;
+				p[0] = p[1] = p[2] = gray;
+				area++;
+			}
+			else
+			{
+				p[0] = 255;
+				p[1] = 255;
+				p[2] = 0;
+			}
+		}
+	}
+}
+
+static void writeToVector(png_structp png, png_bytep data, png_size_t length)
+{
+	std::vector<unsigned char> *bytes = (std::vector<unsigned char> *) png_get_io_ptr(png);
+	bytes->insert(bytes->end(), data, data + length);
+}
+
+static bool encodePNG(int width, int height, const std::vector<unsigned char> &pixels, int compression, std::vector<unsigned char> &bytes)
+{
+	png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	if (png == NULL)
+		return false;
+	png_infop info = png_create_info_struct(png);
+	if (info == NULL || setjmp(png_jmpbuf(png)))
+	{
+		png_destroy_write_struct(&png, &info);
+		return false;
+	}
+
+	bytes.clear();
+	png_set_write_fn(png, &bytes, writeToVector, NULL);
+	png_set_compression_level(png, compression);
+	png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+		PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	png_write_info(png, info);
+	for (int y = 0; y < height; y++)
+		png_write_row(png, (png_bytep)&pixels[y * width * 3]);
+	png_write_end(png, NULL);
+	png_destroy_write_struct(&png, &info);
+	return true;
+}
+
+static bool writeFile(const std::string &filename, const void *data, size_t size)
+{
+	FILE *file = fopen(filename.c_str(), "wb");
+	if (file == NULL)
+		return false;
+	bool ok = size == 0 || fwrite(data, 1, size, file) == size;
+	return fclose(file) == 0 && ok;
+}
+
+//a pre-encoded image with the diameter of its particle in pixels
+struct PoolImage {
+	int width;
+	int height;
+	double diameter;
+	std::vector<unsigned char> bytes;
+};
+
+class CruiseWriter {
+public:
+	CruiseWriter(const GenOptions &options) : m_options(options), m_done(false), m_failed(false), m_written(0)
+	{
+		std::minstd_rand random(options.seed);
+		std::uniform_int_distribution<int> size(options.minSize, options.maxSize);
+		std::vector<unsigned char> pixels;
+		for (int i = 0; i < options.imagePool; i++)
+		{
+			PoolImage image;
+			image.width = size(random);
+			image.height = size(random);
+			double area;
+			drawParticle(image.width, image.height, random(), pixels, area);
+			image.diameter = 2.0 * std::sqrt(area / M_PI);
+			encodePNG(image.width, image.height, pixels, options.compression, image.bytes);
+			m_pool.push_back(image);
+		}
+	}
+
+	const PoolImage * getPoolImage(int id)
+	{
+		return (m_pool.empty()) ? NULL : &m_pool[id % m_pool.size()];
+	}
+
+	void start()
+	{
+		for (int i = 0; i < m_options.threads; i++)
+			m_threads.push_back(std::thread(&CruiseWriter::run, this));
+	}
+
+	//false once a worker could not write
+	bool push(FrameJob &job)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (m_jobs.size() >= QUEUE_FRAMES && !m_failed)
+			m_space.wait(lock);
+		if (m_failed)
+			return false;
+		m_jobs.push_back(FrameJob());
+		std::swap(m_jobs.back(), job);
+		m_work.notify_one();
+		return true;
+	}
+
+	bool finish()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_done = true;
+		}
+		m_work.notify_all();
+		for (std::vector<std::thread>::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+			it->join();
+		m_threads.clear();
+		return !m_failed;
+	}
+
+private:
+	void run()
+	{
+		std::vector<unsigned char> pixels;
+		std::vector<unsigned char> bytes;
+		for (;;)
+		{
+			FrameJob job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				while (m_jobs.empty() && !m_done)
+					m_work.wait(lock);
+				if (m_jobs.empty())
+					break;
+				std::swap(job, m_jobs.front());
+				m_jobs.pop_front();
+				m_space.notify_one();
+			}
+
+			if (!writeFrame(job, pixels, bytes))
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_failed = true;
+				m_space.notify_all();
+				break;
+			}
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_written++;
+			if (m_written % 100 == 0 || m_written == m_options.frames)
+				std::cerr << "\rWritten " << m_written << " / " << m_options.frames << " frames" << std::flush;
+			if (m_written == m_options.frames)
+				std::cerr << std::endl;
+		}
+	}
+
+	bool writeFrame(const FrameJob &job, std::vector<unsigned char> &pixels, std::vector<unsigned char> &bytes)
+	{
+		std::string name = getFrameName(job.index);
+		std::string folder = m_options.output + "/" + name + ".holo";
+		makeDirectory(folder.c_str());
+		makeDirectory((folder + "/data").c_str());
+
+		std::string report;
+		report.reserve(256 + job.rois.size() * 256);
+		report += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<doc>\n<DATA>\n";
+		report += "<NBCONTOURS>" + std::to_string(job.rois.size()) + "</NBCONTOURS>\n";
+
+		char line[512];
+		for (int i = 0; i < job.rois.size(); i++)
+		{
+			const RoiRecord &roi = job.rois[i];
+			char image[32];
+			sprintf(image, "roi%06d.png", i);
+
+			double diameter;
+			const PoolImage *pooled = getPoolImage(roi.id);
+			if (pooled != NULL)
+			{
+				diameter = pooled->diameter;
+				if (!writeFile(folder + "/" + image, &pooled->bytes[0], pooled->bytes.size()))
+					return false;
+			}
+			else
+			{
+				double area;
+				drawParticle(roi.width, roi.height, roi.seed, pixels, area);
+				diameter = 2.0 * std::sqrt(area / M_PI);
+				if (!encodePNG(roi.width, roi.height, pixels, m_options.compression, bytes)
+					|| !writeFile(folder + "/" + image, &bytes[0], bytes.size()))
+					return false;
+			}
+
+			//ESD and ESV are in um, the pixels of the ROIs are PIXEL_SIZE um
+			int width = (pooled != NULL) ? pooled->width : roi.width;
+			int height = (pooled != NULL) ? pooled->height : roi.height;
+			double esd = diameter * PIXEL_SIZE;
+			double esv = M_PI / 6.0 * esd * esd * esd;
+			sprintf(line, "<ROI><X>%.3f</X><Y>%.3f</Y><DEPTH>%.3f</DEPTH><WIDTH>%d</WIDTH><HEIGHT>%d</HEIGHT>"
+				"<IMAGE>%s</IMAGE><ESD>%.3f</ESD><ESV>%.3f</ESV><CONTOUR>%d</CONTOUR></ROI>\n",
+				roi.x, roi.y, roi.depth, width, height, image, esd, esv, roi.id);
+			report += line;
+		}
+		report += "</DATA>\n</doc>\n";
+		if (!writeFile(folder + "/" + REPORTNAME, report.data(), report.size()))
+			return false;
+
+		//slow changes along the cruise with some sensor noise
+		std::minstd_rand random(m_options.seed * 7919u + job.index);
+		std::uniform_real_distribution<double> noise(-1.0, 1.0);
+		double t = job.index;
+		double values[CTD_VALUES] = {
+			50.0 + 40.0 * std::sin(t / 700.0) + 0.5 * noise(random),
+			12.0 + 4.0 * std::cos(t / 900.0) + 0.05 * noise(random),
+			34.5 + 0.4 * std::sin(t / 1300.0) + 0.01 * noise(random),
+			6.0 + 1.5 * std::cos(t / 500.0) + 0.05 * noise(random),
+			0.8 + 0.6 * std::sin(t / 300.0) + 0.02 * noise(random),
+			1.2 + 0.3 * std::cos(t / 200.0) + 0.02 * noise(random)
+		};
+		std::string ctd;
+		for (int i = 0; i < CTD_VALUES; i++)
+		{
+			sprintf(line, "%s %.4f\n", ctdNames[i], values[i]);
+			ctd += line;
+		}
+		return writeFile(folder + "/data/" + name + ".txt", ctd.data(), ctd.size());
+	}
+
+	const GenOptions &m_options;
+	std::vector<PoolImage> m_pool;
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_work;
+	std::condition_variable m_space;
+	std::deque<FrameJob> m_jobs;
+	bool m_done;
+	bool m_failed;
+	int m_written;
+};
+
+//The particles are moved on this thread so the ids and positions only depend on the
+//seed, the frames are written by the workers in any order.
+class ParticleSystem {
+public:
+	ParticleSystem(const GenOptions &options) : m_options(options), m_random(options.seed), m_nextID(1)
+	{
+		m_particles.resize(options.rois);
+		for (std::vector<Particle>::iterator it = m_particles.begin(); it != m_particles.end(); ++it)
+		{
+			spawn(*it);
+			//start at a random point of their life so they do not all leave together
+			it->age = std::uniform_int_distribution<int>(0, it->life - 1)(m_random);
+		}
+	}
+
+	void step(FrameJob &job)
+	{
+		job.rois.resize(m_particles.size());
+		for (int i = 0; i < m_particles.size(); i++)
+		{
+			Particle &p = m_particles[i];
+			if (p.age >= p.life)
+				spawn(p);
+
+			RoiRecord &roi = job.rois[i];
+			roi.id = p.id;
+			roi.depth = p.depth;
+			roi.x = p.u * HALF_FIELD * p.depth;
+			roi.y = p.v * HALF_FIELD * p.depth;
+			roi.width = p.width;
+			roi.height = p.height;
+			roi.seed = (unsigned int)p.id * 2654435761u + job.index;
+
+			p.age++;
+			p.u = reflect(p.u + p.du, -1.0, 1.0, p.du);
+			p.v = reflect(p.v + p.dv, -1.0, 1.0, p.dv);
+			p.depth = reflect(p.depth + p.dz, m_options.minZ, m_options.maxZ, p.dz);
+		}
+	}
+
+private:
+	void spawn(Particle &p)
+	{
+		std::uniform_real_distribution<double> unit(0.0, 1.0);
+		std::uniform_int_distribution<int> size(m_options.minSize, m_options.maxSize);
+		std::exponential_distribution<double> life(1.0 / m_options.lifetime);
+		double range = m_options.maxZ - m_options.minZ;
+
+		p.id = m_nextID++;
+		p.u = 2.0 * unit(m_random) - 1.0;
+		p.v = 2.0 * unit(m_random) - 1.0;
+		p.depth = m_options.minZ + range * unit(m_random);
+		p.du = 0.01 * (2.0 * unit(m_random) - 1.0);
+		p.dv = 0.01 * (2.0 * unit(m_random) - 1.0);
+		p.dz = 0.002 * range * (2.0 * unit(m_random) - 1.0);
+		p.width = size(m_random);
+		p.height = size(m_random);
+		p.age = 0;
+		p.life = 1 + (int)life(m_random);
+	}
+
+	//keeps a moving value inside [low, high] by bouncing it off the walls
+	static double reflect(double value, double low, double high, double &velocity)
+	{
+		if (value < low)
+		{
+			velocity = -velocity;
+			return 2 * low - value;
+		}
+		if (value > high)
+		{
+			velocity = -velocity;
+			return 2 * high - value;
+		}
+		return value;
+	}
+
+	const GenOptions &m_options;
+	std::mt19937 m_random;
+	std::vector<Particle> m_particles;
+	int m_nextID;
+};
+
+int main(int argc, char **argv)
+{
+	GenOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		usage();
+		return 1;
+	}
+
+	makeDirectory(options.output.c_str());
+	std::cerr << "Writing " << options.frames << " frames with " << options.rois << " ROIs each ("
+		<< (long long)options.frames * options.rois << " particles) to " << options.output << std::endl;
+
+	CruiseWriter writer(options);
+	ParticleSystem particles(options);
+	writer.start();
+	for (int i = 0; i < options.frames; i++)
+	{
+		FrameJob job;
+		job.index = i;
+		particles.step(job);
+		if (!writer.push(job))
+			break;
+	}
+
+	if (!writer.finish())
+	{
+		std::cerr << "Could not write to " << options.output << std::endl;
+		return 1;
+	}
+	return 0;
+}